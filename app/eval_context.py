@@ -0,0 +1,30 @@
+"""
+Word indices into the context array given to v2 evals (EvalContext in include/EvalContext.hpp).
+
+A bot opts in by giving evaluation_function a fourth argument; the launcher then passes a
+read-only int64 array of CONTEXT_WORDS bitboards built once per leaf in C++:
+
+    from eval_context import ATTACKS, PASSED, PINNED
+
+    @njit(int32(int64[:], int64[:], uint32, int64[:]))
+    def evaluation_function(board_pieces, board_occupancy, side_to_move, ctx):
+        white_attacks = ctx[ATTACKS + 0]
+        black_passers = ctx[PASSED + 1]
+        ...
+
+Per-side entries are [white, black]; ATTACKS_BY holds one bitboard per piece bitboard, in
+board_pieces order. The pawn-structure words come from a pawn hash, so they cost almost
+nothing when the pawns haven't changed.
+"""
+
+ATTACKS = 0         # 2 words: every square attacked by white / black
+ATTACKS_BY = 2      # 12 words: squares attacked by each piece type (same order as board_pieces)
+CHECKERS = 14       # 1 word: enemy pieces giving check to the side to move
+PINNED = 15         # 2 words: each side's pieces pinned to its own king
+PAWN_ATTACKS = 17   # 2 words
+PASSED = 19         # 2 words: no enemy pawn ahead on the same or an adjacent file
+ISOLATED = 21       # 2 words: no own pawn on an adjacent file
+DOUBLED = 23        # 2 words: shares its file with another own pawn
+PAWN_KEY = 25       # 1 word: Zobrist key of the pawns alone
+
+CONTEXT_WORDS = 26
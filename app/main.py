@@ -1,12 +1,14 @@
 import sys
 import os
+import atexit
 import glob
 import ctypes
 import importlib.util
 import tkinter as tk
 from tkinter import ttk, filedialog
 import numpy as np
-import multiprocessing
+import threading
+import queue
 import time
 
 # -----------------------------------------------------------
@@ -14,6 +16,35 @@ import time
 # -----------------------------------------------------------
 COMPETITION_DEPTH = 7
 MAX_MOVES_PER_GAME = 600
+# Headless clock per side (base, increment) in ms; (0, 0) = fixed depth only
+TOURNAMENT_TIME_CONTROL = (0, 0)
+# Adjudication (centipawns / moves per engine); 0 disables a rule
+ADJUDICATION = {
+    "resign_score": 1000, "resign_moves": 5,
+    "draw_score": 10, "draw_moves": 10, "draw_move_number": 40,
+}
+# Syzygy directories (os.pathsep-separated); empty = no tablebases
+SYZYGY_PATH = ""
+SYZYGY_PROBE_DEPTH = 1
+SYZYGY_PROBE_LIMIT = 7
+# Polyglot-layout book built with `python main.py --build-book`; used when present
+OPENING_BOOK_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), "books", "openings.bin")
+BOOK_PLIES = 16
+# Self-play training data (`python main.py --datagen`); records are read by training_data.py
+DATAGEN_NODES = 5000
+DATAGEN_RANDOM_PLIES = 8
+# Lazy eval margins in centipawns per bot name (`python main.py --calibrate-lazy`); quiescence
+# skips a listed bot's eval where the built-in PeSTO score +/- margin can't change the result
+LAZY_EVAL_MARGINS = {}
+# Best-first MCTS instead of alpha-beta per bot name, for value-network bots that prefer
+# fewer, better-chosen evals, e.g. {"ZiadFakhoury": {"threads": 4, "playouts": 4000}}.
+# Keys are MctsOptions fields; unset ones keep the engine defaults.
+MCTS_BOTS = {}
+# Memory placement: huge pages for the hash and attack tables, pinning tournament threads to
+# CPUs spread over NUMA nodes, and one copy of each native network per node
+LARGE_PAGES = True
+PIN_THREADS = False
+NUMA_REPLICATE = False
 LOADED_BOTS_CACHE = {}
 
 import platform
@@ -58,6 +89,15 @@ EVAL_FUNC_TYPE = ctypes.CFUNCTYPE(
     ctypes.c_uint32,
 )
 
+# v2 evals: evaluation_function(board_pieces, board_occupancy, side_to_move, ctx)
+EVAL_CONTEXT_FUNC_TYPE = ctypes.CFUNCTYPE(
+    ctypes.c_int32,
+    ctypes.POINTER(ctypes.c_uint64),
+    ctypes.POINTER(ctypes.c_uint64),
+    ctypes.c_uint32,
+    ctypes.POINTER(ctypes.c_uint64),
+)
+
 class CallbackWrapper:
     """Holds a native callback and its address. Works with both @cfunc and ctypes."""
     def __init__(self, cb):
@@ -71,6 +111,7 @@ class CallbackWrapper:
 # DUMMY EVAL (native via @cfunc)
 # -----------------------------------------------------------
 from numba import cfunc, types, carray
+from eval_context import CONTEXT_WORDS
 
 _c_sig = types.int32(types.CPointer(types.uint64), types.CPointer(types.uint64), types.uint32)
 
@@ -98,6 +139,85 @@ def _native_eval_wrapper(pieces_ptr, occupancy_ptr, side):
     return evaluation_function(pieces, occupancy, side)
 """
 
+# Same for v2 evals; ctx is the EvalContext as CONTEXT_WORDS bitboards (see eval_context.py)
+_CFUNC_CONTEXT_WRAPPER_SOURCE = """
+from numba import cfunc, types, carray
+import numpy as np
+
+_c_ctx_sig = types.int32(types.CPointer(types.uint64), types.CPointer(types.uint64), types.uint32,
+                         types.CPointer(types.uint64))
+
+@cfunc(_c_ctx_sig)
+def _native_eval_wrapper(pieces_ptr, occupancy_ptr, side, ctx_ptr):
+    pieces = carray(pieces_ptr, (12,), dtype=np.uint64).astype(np.int64)
+    occupancy = carray(occupancy_ptr, (3,), dtype=np.uint64).astype(np.int64)
+    ctx = carray(ctx_ptr, (%d,), dtype=np.uint64).astype(np.int64)
+    return evaluation_function(pieces, occupancy, side, ctx)
+""" % CONTEXT_WORDS
+
+def _takes_context(fn):
+    """True for v2 evals, whose evaluation_function takes a fourth (context) argument."""
+    py_func = getattr(fn, "py_func", fn)
+    code = getattr(py_func, "__code__", None)
+    return code is not None and code.co_argcount >= 4
+
+def _register_context_eval(cb):
+    """Registers a v2 callback with the engine; its address becomes the handle the C API takes."""
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.registerContextEval.argtypes = [ctypes.c_void_p]
+    chess_lib.registerContextEval.restype = ctypes.c_void_p
+    handle = chess_lib.registerContextEval(cb.address)
+    if not handle:
+        raise RuntimeError("context eval registry is full")
+    cb.address = handle
+    return cb
+
+# (pieces[count * 12], occupancy[count * 3], sides[count], scores_out[count], count)
+BATCH_EVAL_FUNC_TYPE = ctypes.CFUNCTYPE(
+    None,
+    ctypes.POINTER(ctypes.c_uint64),
+    ctypes.POINTER(ctypes.c_uint64),
+    ctypes.POINTER(ctypes.c_uint32),
+    ctypes.POINTER(ctypes.c_int32),
+    ctypes.c_uint32
+)
+
+def _register_batch_eval(cb, batch_fn):
+    """
+    Pairs a bot's callback with its evaluation_batch(board_pieces (N, 12), board_occupancy
+    (N, 3), side_to_move (N,)) -> N scores, used by run_batched_match.
+    """
+    def batch(pieces_ptr, occupancy_ptr, sides_ptr, scores_ptr, count):
+        pieces = np.ctypeslib.as_array(pieces_ptr, shape=(count, 12)).view(np.int64)
+        occupancy = np.ctypeslib.as_array(occupancy_ptr, shape=(count, 3)).view(np.int64)
+        sides = np.ctypeslib.as_array(sides_ptr, shape=(count,))
+        scores = np.ctypeslib.as_array(scores_ptr, shape=(count,))
+        scores[:] = batch_fn(pieces, occupancy, sides)
+
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.registerBatchEval.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+    chess_lib.registerBatchEval.restype = None
+    cb._batch = BATCH_EVAL_FUNC_TYPE(batch)    # Kept alive with the bot
+    chess_lib.registerBatchEval(cb.address, ctypes.cast(cb._batch, ctypes.c_void_p).value)
+    return cb
+
+def load_native_network(weights_path):
+    """Loads an app/nnue.py export into the engine; returns its callback (incremental in search)."""
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.loadNnue.argtypes = [ctypes.c_char_p]
+    chess_lib.loadNnue.restype = ctypes.c_void_p
+    handle = chess_lib.loadNnue(weights_path.encode('utf-8'))
+    if not handle:
+        raise IOError(f"Failed to load network {weights_path}")
+    return CallbackWrapper(ctypes.c_void_p(handle))
+
+def _apply_bot_options(bot_name, cb):
+    if LAZY_EVAL_MARGINS.get(bot_name, 0) > 0:
+        set_lazy_margin(cb, LAZY_EVAL_MARGINS[bot_name])
+    if bot_name in MCTS_BOTS:
+        set_mcts_backend(cb, MCTS_BOTS[bot_name])
+    return cb
+
 # -----------------------------------------------------------
 # BOT LOADING
 # -----------------------------------------------------------
@@ -140,14 +260,24 @@ def load_bot_safely(bot_name, bot_path):
 
         if "evaluation" in local_modules:
             eval_mod = local_modules["evaluation"]
-            if hasattr(eval_mod, "evaluation_function"):
+            if hasattr(eval_mod, "NNUE_WEIGHTS"):
+                # --- NATIVE NETWORK: weights exported with nnue.py, evaluated in C++ ---
+                cb = load_native_network(os.path.join(bot_path, eval_mod.NNUE_WEIGHTS))
+                LOADED_BOTS_CACHE[bot_path] = _apply_bot_options(bot_name, cb)
+                print(f"  -> Success (native network {eval_mod.NNUE_WEIGHTS}). Address: {hex(cb.address)}")
+                return cb
+            elif hasattr(eval_mod, "evaluation_function"):
+                uses_context = _takes_context(eval_mod.evaluation_function)
 
                 # --- FAST PATH: compile @cfunc in the bot's own namespace ---
                 try:
-                    exec(_CFUNC_WRAPPER_SOURCE, eval_mod.__dict__)
+                    exec(_CFUNC_CONTEXT_WRAPPER_SOURCE if uses_context else _CFUNC_WRAPPER_SOURCE,
+                         eval_mod.__dict__)
                     native_cb = eval_mod.__dict__['_native_eval_wrapper']
                     cb = CallbackWrapper(native_cb)
-                    LOADED_BOTS_CACHE[bot_path] = cb
+                    if uses_context: cb = _register_context_eval(cb)
+                    elif hasattr(eval_mod, "evaluation_batch"): _register_batch_eval(cb, eval_mod.evaluation_batch)
+                    LOADED_BOTS_CACHE[bot_path] = _apply_bot_options(bot_name, cb)
                     print(f"  -> Success (native @cfunc). Address: {hex(cb.address)}")
                     return cb
                 except Exception as e:
@@ -162,8 +292,18 @@ def load_bot_safely(bot_name, bot_path):
                         return int(fn(pieces, occupancy, np.int32(side)))
                     return CallbackWrapper(EVAL_FUNC_TYPE(wrapper))
 
-                cb = make_wrapper(real_eval_func)
-                LOADED_BOTS_CACHE[bot_path] = cb
+                def make_context_wrapper(fn):
+                    def wrapper(pieces_ptr, occupancy_ptr, side, ctx_ptr):
+                        pieces = np.ctypeslib.as_array(pieces_ptr, shape=(12,)).astype(np.int64)
+                        occupancy = np.ctypeslib.as_array(occupancy_ptr, shape=(3,)).astype(np.int64)
+                        ctx = np.ctypeslib.as_array(ctx_ptr, shape=(CONTEXT_WORDS,)).astype(np.int64)
+                        return int(fn(pieces, occupancy, np.int32(side), ctx))
+                    return _register_context_eval(CallbackWrapper(EVAL_CONTEXT_FUNC_TYPE(wrapper)))
+
+                cb = (make_context_wrapper if uses_context else make_wrapper)(real_eval_func)
+                if not uses_context and hasattr(eval_mod, "evaluation_batch"):
+                    _register_batch_eval(cb, eval_mod.evaluation_batch)
+                LOADED_BOTS_CACHE[bot_path] = _apply_bot_options(bot_name, cb)
                 print(f"  -> Success (ctypes fallback). Address: {hex(cb.address)}")
                 return cb
             else:
@@ -183,59 +323,662 @@ def load_bot_safely(bot_name, bot_path):
 
 
 # -----------------------------------------------------------
-# HEADLESS GAME WORKER (runs in child process)
+# HEADLESS TOURNAMENT (in-process, C++ thread pool)
+# -----------------------------------------------------------
+class Adjudication(ctypes.Structure):
+    _fields_ = [
+        ("resign_score", ctypes.c_int32),
+        ("resign_moves", ctypes.c_int32),
+        ("draw_score", ctypes.c_int32),
+        ("draw_moves", ctypes.c_int32),
+        ("draw_move_number", ctypes.c_int32),
+        ("tablebase", ctypes.c_int32),
+    ]
+
+def init_tablebases(chess_lib, path=SYZYGY_PATH):
+    """Loads Syzygy tables for every search in this process. Returns the max piece count."""
+    chess_lib.initTablebases.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_int]
+    chess_lib.initTablebases.restype = ctypes.c_int
+    return chess_lib.initTablebases(path.encode('utf-8'), SYZYGY_PROBE_DEPTH, SYZYGY_PROBE_LIMIT)
+
 # -----------------------------------------------------------
-def _run_game_worker(result_queue, game_id, white_name, white_path,
-                     black_name, black_path, fen, opening_name, depth, max_moves):
+# OPENING BOOK
+# -----------------------------------------------------------
+def _bind_book_api(chess_lib):
+    chess_lib.buildOpeningBook.argtypes = [
+        ctypes.POINTER(ctypes.c_char_p), ctypes.c_int, ctypes.c_char_p, ctypes.c_int, ctypes.c_int
+    ]
+    chess_lib.buildOpeningBook.restype = ctypes.c_int64
+    chess_lib.openOpeningBook.argtypes = [ctypes.c_char_p]
+    chess_lib.openOpeningBook.restype = ctypes.c_void_p
+    chess_lib.closeOpeningBook.argtypes = [ctypes.c_void_p]
+    chess_lib.closeOpeningBook.restype = None
+    chess_lib.probeOpeningBook.argtypes = [
+        ctypes.c_void_p, ctypes.c_char_p, ctypes.c_uint64, ctypes.c_char_p, ctypes.c_int
+    ]
+    chess_lib.probeOpeningBook.restype = ctypes.c_int
+    return chess_lib
+
+def build_opening_book(pgn_paths, out_path=OPENING_BOOK_PATH, max_ply=24, min_weight=1):
+    """Streams PGN files into a book file. Returns the number of entries written."""
+    chess_lib = _bind_book_api(ctypes.CDLL(get_chess_lib_path()))
+    os.makedirs(os.path.dirname(os.path.abspath(out_path)), exist_ok=True)
+    paths = (ctypes.c_char_p * len(pgn_paths))(*[p.encode('utf-8') for p in pgn_paths])
+    written = chess_lib.buildOpeningBook(paths, len(pgn_paths), out_path.encode('utf-8'),
+                                         max_ply, min_weight)
+    if written < 0:
+        raise IOError(f"Failed to build opening book {out_path}")
+    return written
+
+def _open_book(chess_lib, book_path):
+    """Maps a book for the duration of a run; returns None when there isn't one."""
+    if not book_path or not os.path.exists(book_path):
+        return None
+    _bind_book_api(chess_lib)
+    return chess_lib.openOpeningBook(book_path.encode('utf-8'))
+
+# (game_id, white_idx, black_idx, opening_idx, result_code, elapsed_seconds)
+RESULT_CALLBACK_TYPE = ctypes.CFUNCTYPE(
+    None,
+    ctypes.c_int, ctypes.c_int, ctypes.c_int,
+    ctypes.c_int, ctypes.c_int, ctypes.c_double,
+)
+
+def _run_tournament_thread(result_queue, bots, openings, games_per_pairing,
+                           depth, max_moves, time_control=(0, 0), adjudication=None,
+                           book_path=None, book_plies=BOOK_PLIES):
     """
-    Each child process independently loads both bots and the C++ library,
-    runs a single headless game, and sends the result back via the queue.
+    Plays every game in this process via runTournament. The C++ side runs
+    games concurrently on its own threads and reports each finished game
+    through the callback, which just forwards it to the GUI's queue.
+    `bots` is a list of (name, CallbackWrapper); `openings` of (name, fen).
+    With a book, each opening continues from it for up to `book_plies` plies.
     """
+    book = None
     try:
-        # Load bots fresh in this process
-        white_cb = load_bot_safely(f"{white_name}_w", white_path)
-        black_cb = load_bot_safely(f"{black_name}_b", black_path)
-
-        if white_cb is None or black_cb is None:
-            result_queue.put((game_id, opening_name, white_name, black_name,
-                              "ERROR", "Bot failed to load"))
-            return
-
-        # Load C++ library
         lib_path = get_chess_lib_path()
         chess_lib = ctypes.CDLL(lib_path)
-        chess_lib.runHeadlessGame.argtypes = [
-            ctypes.c_void_p, ctypes.c_void_p,
-            ctypes.c_int, ctypes.c_char_p, ctypes.c_int
+        chess_lib.runTournament.argtypes = [
+            ctypes.POINTER(ctypes.c_void_p), ctypes.c_int,
+            ctypes.POINTER(ctypes.c_char_p), ctypes.c_int,
+            ctypes.c_int, ctypes.c_int, ctypes.c_int,
+            ctypes.c_int, ctypes.c_int, ctypes.c_int,
+            ctypes.POINTER(Adjudication), ctypes.c_void_p, ctypes.c_int,
+            RESULT_CALLBACK_TYPE
         ]
-        chess_lib.runHeadlessGame.restype = ctypes.c_int
+        chess_lib.runTournament.restype = ctypes.c_int
+
+        bot_addrs = (ctypes.c_void_p * len(bots))(*[cb.address for _, cb in bots])
+        fen_bytes = (ctypes.c_char_p * len(openings))(*[fen.encode('utf-8') for _, fen in openings])
+
+        def on_result(game_id, white_idx, black_idx, opening_idx, result_code, elapsed):
+            white_name = bots[white_idx][0]
+            black_name = bots[black_idx][0]
+            result_map = {
+                0:  "Draw",
+                1:  f"{white_name} wins",
+                2:  f"{black_name} wins",
+                -1: "Draw (max moves)",
+            }
+            result_str = result_map.get(result_code, f"Unknown ({result_code})")
+
+            # Determine points: winner gets 1, draw gives 0.5 each
+            w_pts = 0.5 if result_code in (0, -1) else (1.0 if result_code == 1 else 0.0)
+            b_pts = 0.5 if result_code in (0, -1) else (1.0 if result_code == 2 else 0.0)
+
+            result_queue.put((game_id, openings[opening_idx][0], white_name, black_name,
+                              result_str, f"{elapsed:.1f}s", w_pts, b_pts))
+
+        callback = RESULT_CALLBACK_TYPE(on_result)  # kept alive for the whole call
+        adj = ctypes.byref(Adjudication(**adjudication)) if adjudication else None
+        init_tablebases(chess_lib)
+        book = _open_book(chess_lib, book_path)
+        chess_lib.runTournament(bot_addrs, len(bots), fen_bytes, len(openings),
+                                games_per_pairing, depth, max_moves,
+                                time_control[0], time_control[1], 0, adj,
+                                book, book_plies, callback)
 
-        fen_bytes = fen.encode('utf-8')
-        t0 = time.time()
-        result_code = chess_lib.runHeadlessGame(
-            white_cb.address, black_cb.address,
-            depth, fen_bytes, max_moves
-        )
-        elapsed = time.time() - t0
+    except Exception as e:
+        result_queue.put((-1, "", "", "", "CRASH", str(e)))
+
+    finally:
+        if book:
+            chess_lib.closeOpeningBook(book)
+
+
+# -----------------------------------------------------------
+# BATCHED MATCH API (runHeadlessMatch)
+# -----------------------------------------------------------
+TERMINATION_NAMES = {
+    0: "None", 1: "Checkmate", 2: "Stalemate", 3: "Repetition",
+    4: "Fifty-move rule", 5: "Move limit", 6: "No move", 7: "Time forfeit",
+    8: "Adjudicated win", 9: "Adjudicated draw", 10: "Insufficient material",
+    11: "Tablebase",
+}
+
+class MatchJob(ctypes.Structure):
+    _fields_ = [
+        ("white", ctypes.c_void_p),
+        ("black", ctypes.c_void_p),
+        ("fen", ctypes.c_char_p),
+        ("white_base_ms", ctypes.c_int64),
+        ("white_increment_ms", ctypes.c_int64),
+        ("black_base_ms", ctypes.c_int64),
+        ("black_increment_ms", ctypes.c_int64),
+    ]
+
+class MatchResult(ctypes.Structure):
+    _fields_ = [
+        ("result", ctypes.c_int32),
+        ("termination", ctypes.c_int32),
+        ("plies", ctypes.c_int32),
+        ("uci_moves_length", ctypes.c_int32),
+        ("white_nodes", ctypes.c_uint64),
+        ("black_nodes", ctypes.c_uint64),
+        ("uci_moves", ctypes.c_char_p),
+        ("uci_moves_capacity", ctypes.c_int32),
+        ("move_times_length", ctypes.c_int32),
+        ("move_times_ms", ctypes.POINTER(ctypes.c_int32)),
+        ("move_times_capacity", ctypes.c_int32),
+        ("book_plies", ctypes.c_int32),
+        ("white_time_ms", ctypes.c_int64),
+        ("black_time_ms", ctypes.c_int64),
+        ("white_max_move_ms", ctypes.c_int64),
+        ("black_max_move_ms", ctypes.c_int64),
+        ("white_clock_left_ms", ctypes.c_int64),
+        ("black_clock_left_ms", ctypes.c_int64),
+    ]
+
+def _pack_match_jobs(jobs, max_moves, moves_buffer_size):
+    n = len(jobs)
+    job_arr = (MatchJob * n)()
+    res_arr = (MatchResult * n)()
+    buffers = [ctypes.create_string_buffer(moves_buffer_size) for _ in range(n)]
+    time_buffers = [(ctypes.c_int32 * max_moves)() for _ in range(n)]
+    for i, job in enumerate(jobs):
+        white_cb, black_cb, fen = job[:3]
+        clocks = job[3:7] if len(job) >= 7 else (0, 0, 0, 0)
+        job_arr[i].white = white_cb.address
+        job_arr[i].black = black_cb.address
+        job_arr[i].fen = fen.encode('utf-8')
+        (job_arr[i].white_base_ms, job_arr[i].white_increment_ms,
+         job_arr[i].black_base_ms, job_arr[i].black_increment_ms) = clocks
+        res_arr[i].uci_moves = ctypes.cast(buffers[i], ctypes.c_char_p)
+        res_arr[i].uci_moves_capacity = moves_buffer_size
+        res_arr[i].move_times_ms = time_buffers[i]
+        res_arr[i].move_times_capacity = max_moves
+    return job_arr, res_arr, buffers, time_buffers
+
+def _unpack_match_results(res_arr, buffers, time_buffers):
+    return [{
+        "result": r.result,
+        "termination": TERMINATION_NAMES.get(r.termination, str(r.termination)),
+        "plies": r.plies,
+        "book_plies": r.book_plies,
+        "white_nodes": r.white_nodes,
+        "black_nodes": r.black_nodes,
+        "white_time_ms": r.white_time_ms,
+        "black_time_ms": r.black_time_ms,
+        "white_max_move_ms": r.white_max_move_ms,
+        "black_max_move_ms": r.black_max_move_ms,
+        "white_clock_left_ms": r.white_clock_left_ms,
+        "black_clock_left_ms": r.black_clock_left_ms,
+        "move_times_ms": list(time_buffers[i][:r.move_times_length]),
+        "uci_moves": buffers[i].value.decode('utf-8'),
+    } for i, r in enumerate(res_arr)]
+
+def run_headless_match(jobs, depth=COMPETITION_DEPTH, max_moves=MAX_MOVES_PER_GAME,
+                       num_threads=0, moves_buffer_size=8192, adjudication=None,
+                       book_path=None, book_plies=BOOK_PLIES):
+    """
+    Plays many games in a single library call.
+    `jobs` is a list of (white CallbackWrapper, black CallbackWrapper, fen), optionally
+    followed by (white_base_ms, white_inc_ms, black_base_ms, black_inc_ms) clocks.
+    Returns a list of dicts with result, termination, plies, nodes, clock usage and UCI moves.
+    With `book_path`, job i takes up to `book_plies` book moves chosen with seed i.
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.runHeadlessMatch.argtypes = [
+        ctypes.POINTER(MatchJob), ctypes.POINTER(MatchResult), ctypes.c_int,
+        ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(Adjudication),
+        ctypes.c_void_p, ctypes.c_int
+    ]
+    chess_lib.runHeadlessMatch.restype = ctypes.c_int
+
+    job_arr, res_arr, buffers, time_buffers = _pack_match_jobs(jobs, max_moves, moves_buffer_size)
+    adj = ctypes.byref(Adjudication(**adjudication)) if adjudication else None
+    init_tablebases(chess_lib)
+    book = _open_book(chess_lib, book_path)
+    try:
+        chess_lib.runHeadlessMatch(job_arr, res_arr, len(jobs), depth, max_moves, num_threads, adj,
+                                   book, book_plies)
+    finally:
+        if book:
+            chess_lib.closeOpeningBook(book)
+
+    return _unpack_match_results(res_arr, buffers, time_buffers)
+
+class BatchStats(ctypes.Structure):
+    _fields_ = [
+        ("rounds", ctypes.c_int64),
+        ("positions", ctypes.c_int64),
+        ("batch_calls", ctypes.c_int64),
+        ("max_batch", ctypes.c_int64),
+    ]
+
+def run_batched_match(jobs, depth=COMPETITION_DEPTH, max_moves=MAX_MOVES_PER_GAME,
+                      max_active=64, moves_buffer_size=8192, adjudication=None,
+                      book_path=None, book_plies=BOOK_PLIES):
+    """
+    run_headless_match on one thread, with the searches of up to `max_active` games
+    interleaved so bots with an `evaluation_batch` score every waiting leaf in one call.
+    Clocks in the jobs are ignored (games are depth-limited); results otherwise match
+    run_headless_match. Returns (results, stats) where stats counts rounds and batch sizes.
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.runBatchedMatch.argtypes = [
+        ctypes.POINTER(MatchJob), ctypes.POINTER(MatchResult), ctypes.c_int,
+        ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(Adjudication),
+        ctypes.c_void_p, ctypes.c_int, ctypes.POINTER(BatchStats)
+    ]
+    chess_lib.runBatchedMatch.restype = ctypes.c_int
+
+    job_arr, res_arr, buffers, time_buffers = _pack_match_jobs(jobs, max_moves, moves_buffer_size)
+    adj = ctypes.byref(Adjudication(**adjudication)) if adjudication else None
+    stats = BatchStats()
+    init_tablebases(chess_lib)
+    book = _open_book(chess_lib, book_path)
+    try:
+        chess_lib.runBatchedMatch(job_arr, res_arr, len(jobs), depth, max_moves, max_active, adj,
+                                  book, book_plies, ctypes.byref(stats))
+    finally:
+        if book:
+            chess_lib.closeOpeningBook(book)
+
+    stats = {field: getattr(stats, field) for field, _ in BatchStats._fields_}
+    return _unpack_match_results(res_arr, buffers, time_buffers), stats
 
-        result_map = {
-            0:  "Draw",
-            1:  f"{white_name} wins",
-            2:  f"{black_name} wins",
-            -1: "Draw (max moves)",
-        }
-        result_str = result_map.get(result_code, f"Unknown ({result_code})")
 
-        # Determine points: winner gets 1, draw gives 0.5 each
-        w_pts = 0.5 if result_code in (0, -1) else (1.0 if result_code == 1 else 0.0)
-        b_pts = 0.5 if result_code in (0, -1) else (1.0 if result_code == 2 else 0.0)
+# -----------------------------------------------------------
+# TRAINING DATA (generateTrainingData)
+# -----------------------------------------------------------
+class DataGenOptions(ctypes.Structure):
+    _fields_ = [
+        ("games", ctypes.c_int64),
+        ("nodes", ctypes.c_uint64),
+        ("depth", ctypes.c_int32),
+        ("random_plies", ctypes.c_int32),
+        ("max_plies", ctypes.c_int32),
+        ("hash_mb", ctypes.c_int32),
+        ("num_threads", ctypes.c_int32),
+        ("score_limit", ctypes.c_int32),
+        ("seed", ctypes.c_uint64),
+    ]
+
+# (games_done, positions_written)
+PROGRESS_CALLBACK_TYPE = ctypes.CFUNCTYPE(None, ctypes.c_int64, ctypes.c_int64)
+
+def generate_training_data(out_path, games, bot=None, nodes=DATAGEN_NODES,
+                           random_plies=DATAGEN_RANDOM_PLIES, depth=0,
+                           max_plies=MAX_MOVES_PER_GAME, hash_mb=16, num_threads=0,
+                           score_limit=3000, seed=0, adjudication=ADJUDICATION,
+                           on_progress=None):
+    """
+    Self-play at a fixed node budget, appending 32-byte records to `out_path`
+    (read them back with training_data.py). `bot` is a CallbackWrapper, or None for
+    the built-in eval. on_progress(games_done, positions) is called from worker threads.
+    Returns the number of positions written.
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.generateTrainingData.argtypes = [
+        ctypes.c_void_p, ctypes.POINTER(DataGenOptions), ctypes.c_char_p,
+        ctypes.POINTER(Adjudication), PROGRESS_CALLBACK_TYPE
+    ]
+    chess_lib.generateTrainingData.restype = ctypes.c_int64
+
+    options = DataGenOptions(games, nodes, depth, random_plies, max_plies,
+                             hash_mb, num_threads, score_limit, seed)
+    adj = ctypes.byref(Adjudication(**adjudication)) if adjudication else None
+    callback = PROGRESS_CALLBACK_TYPE(on_progress if on_progress else (lambda g, p: None))
+    init_tablebases(chess_lib)
+    written = chess_lib.generateTrainingData(bot.address if bot else None, ctypes.byref(options),
+                                             out_path.encode('utf-8'), adj, callback)
+    if written < 0:
+        raise IOError(f"Failed to write training data to {out_path}")
+    return written
+
+
+def convert_positions(in_path, out_path, num_threads=0, errors_path=None):
+    """
+    Converts a FEN/EPD file (one position per line, optional ce / c9 / [result] labels)
+    into packed records readable with training_data.py. Returns (positions, bad_lines).
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.convertPositionFile.argtypes = [
+        ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int, ctypes.c_char_p,
+        ctypes.POINTER(ctypes.c_int64)
+    ]
+    chess_lib.convertPositionFile.restype = ctypes.c_int64
+
+    bad = ctypes.c_int64(0)
+    written = chess_lib.convertPositionFile(in_path.encode('utf-8'), out_path.encode('utf-8'),
+                                            num_threads,
+                                            errors_path.encode('utf-8') if errors_path else None,
+                                            ctypes.byref(bad))
+    if written < 0:
+        raise IOError(f"Failed to convert {in_path} to {out_path}")
+    return written, bad.value
 
-        result_queue.put((game_id, opening_name, white_name, black_name,
-                          result_str, f"{elapsed:.1f}s", w_pts, b_pts))
 
-    except Exception as e:
-        result_queue.put((game_id, opening_name, white_name, black_name,
-                          "CRASH", str(e), 0.0, 0.0))
+# -----------------------------------------------------------
+# EVAL PROFILING (profileEvals)
+# -----------------------------------------------------------
+class EvalProfile(ctypes.Structure):
+    _fields_ = [
+        ("calls", ctypes.c_int64),
+        ("ns_mean", ctypes.c_double),
+        ("ns_p50", ctypes.c_double),
+        ("ns_p90", ctypes.c_double),
+        ("ns_p99", ctypes.c_double),
+        ("ns_p999", ctypes.c_double),
+        ("ns_max", ctypes.c_double),
+        ("calls_per_sec", ctypes.c_double),
+        ("score_mean", ctypes.c_double),
+        ("score_std", ctypes.c_double),
+        ("score_min", ctypes.c_int32),
+        ("score_p1", ctypes.c_int32),
+        ("score_p50", ctypes.c_int32),
+        ("score_p99", ctypes.c_int32),
+        ("score_max", ctypes.c_int32),
+        ("reserved", ctypes.c_int32),
+    ]
+
+def profile_evals(corpus_path, bots, max_positions=0, warmup_calls=100000, num_threads=0):
+    """
+    Times each bot's eval on every position of a corpus (.bin records or FEN/EPD text).
+    `bots` is a list of (name, CallbackWrapper or None for the built-in eval).
+    Returns (leaderboard, correlation): profile dicts sorted by median ns/call, and
+    {(name_a, name_b): pearson} for every pair of bots.
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.profileEvals.argtypes = [
+        ctypes.POINTER(ctypes.c_void_p), ctypes.c_int, ctypes.c_char_p, ctypes.c_int64,
+        ctypes.c_int64, ctypes.c_int, ctypes.POINTER(EvalProfile), ctypes.POINTER(ctypes.c_double)
+    ]
+    chess_lib.profileEvals.restype = ctypes.c_int64
+
+    n = len(bots)
+    addrs = (ctypes.c_void_p * n)(*[cb.address if cb else None for _, cb in bots])
+    profiles = (EvalProfile * n)()
+    matrix = (ctypes.c_double * (n * n))()
+    used = chess_lib.profileEvals(addrs, n, corpus_path.encode('utf-8'), max_positions,
+                                  warmup_calls, num_threads, profiles, matrix)
+    if used < 0:
+        raise IOError(f"Failed to read corpus {corpus_path}")
+
+    leaderboard = []
+    for (name, _), p in zip(bots, profiles):
+        row = {field: getattr(p, field) for field, _ in EvalProfile._fields_ if field != "reserved"}
+        row["name"] = name
+        leaderboard.append(row)
+    leaderboard.sort(key=lambda r: r["ns_p50"])
+    correlation = {(bots[a][0], bots[b][0]): matrix[a * n + b]
+                   for a in range(n) for b in range(n) if a != b}
+    return leaderboard, correlation
+
+def print_eval_leaderboard(leaderboard, correlation=None):
+    print(f"{'#':>3} {'Bot':<24} {'p50 ns':>9} {'p99 ns':>9} {'max ns':>11} "
+          f"{'calls/s':>12} {'score mean':>11} {'score std':>10}")
+    for rank, r in enumerate(leaderboard, 1):
+        print(f"{rank:>3} {r['name']:<24} {r['ns_p50']:>9.0f} {r['ns_p99']:>9.0f} {r['ns_max']:>11.0f} "
+              f"{r['calls_per_sec']:>12,.0f} {r['score_mean']:>11.1f} {r['score_std']:>10.1f}")
+    for (a, b), c in sorted((correlation or {}).items()):
+        if a < b:
+            print(f"    corr({a}, {b}) = {c:.3f}")
+
+
+# -----------------------------------------------------------
+# LAZY EVAL (PeSTO gate in front of bot callbacks)
+# -----------------------------------------------------------
+def set_lazy_margin(cb, margin):
+    """Sets the lazy-eval margin (centipawns, 0 = off) for every search using this callback."""
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.setLazyMargin.argtypes = [ctypes.c_void_p, ctypes.c_int32]
+    chess_lib.setLazyMargin.restype = None
+    chess_lib.setLazyMargin(cb.address, int(margin))
+
+def calibrate_lazy_margin(corpus_path, cb, coverage=0.99, max_positions=0):
+    """
+    Margin that covers |bot eval - PeSTO| on `coverage` of a corpus's positions.
+    Higher coverage is safer but gates fewer callbacks; the gate is exact whenever
+    the true gap stays within the margin.
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.calibrateLazyMargin.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int64, ctypes.c_double]
+    chess_lib.calibrateLazyMargin.restype = ctypes.c_int32
+    margin = chess_lib.calibrateLazyMargin(cb.address, corpus_path.encode('utf-8'), max_positions, coverage)
+    if margin < 0:
+        raise IOError(f"Failed to read corpus {corpus_path}")
+    return margin
+
+def lazy_eval_counters(reset=False):
+    """(eval callbacks made, callbacks avoided by the gate) over all searches so far."""
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.lazyEvalCounters.argtypes = [
+        ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(ctypes.c_uint64), ctypes.c_bool
+    ]
+    chess_lib.lazyEvalCounters.restype = None
+    calls, skipped = ctypes.c_uint64(0), ctypes.c_uint64(0)
+    chess_lib.lazyEvalCounters(ctypes.byref(calls), ctypes.byref(skipped), reset)
+    return calls.value, skipped.value
+
+
+# -----------------------------------------------------------
+# MATE SOLVER (solveMate)
+# -----------------------------------------------------------
+def solve_mate(fen, max_moves=5, node_budget=0):
+    """
+    Searches for a forced mate by the side to move in at most max_moves moves with the
+    native proof-number solver (no bot eval involved). Returns a dict with "status"
+    ("mate", "no mate" or "unknown" if node_budget ran out), "mate_in", "pv" (UCI moves)
+    and "nodes".
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.solveMate.argtypes = [
+        ctypes.c_char_p, ctypes.c_int, ctypes.c_uint64, ctypes.POINTER(ctypes.c_int),
+        ctypes.POINTER(ctypes.c_uint64), ctypes.c_char_p, ctypes.c_int
+    ]
+    chess_lib.solveMate.restype = ctypes.c_int
+    mate_in, nodes = ctypes.c_int(0), ctypes.c_uint64(0)
+    pv_buffer = ctypes.create_string_buffer(8 * 2 * max(max_moves, 1) + 16)
+    status = chess_lib.solveMate(fen.encode('utf-8'), max_moves, node_budget, ctypes.byref(mate_in),
+                                 ctypes.byref(nodes), pv_buffer, len(pv_buffer))
+    return {
+        "status": {1: "mate", 2: "no mate"}.get(status, "unknown"),
+        "mate_in": mate_in.value,
+        "pv": pv_buffer.value.decode('utf-8').split(),
+        "nodes": nodes.value,
+    }
+
+
+# -----------------------------------------------------------
+# MCTS BACKEND (setMctsBackend)
+# -----------------------------------------------------------
+class MctsOptions(ctypes.Structure):
+    """Mirrors Search::MctsOptions (include/Search.hpp)."""
+    _fields_ = [
+        ("threads", ctypes.c_int32),        # 0 = all hardware threads
+        ("batch_size", ctypes.c_int32),     # Leaves per evaluation_batch call
+        ("cpuct", ctypes.c_float),
+        ("value_scale", ctypes.c_int32),
+        ("playouts", ctypes.c_uint64),      # Per move for fixed-depth games
+        ("max_tree_nodes", ctypes.c_uint64),
+    ]
+    DEFAULTS = {"threads": 1, "batch_size": 16, "cpuct": 1.5, "value_scale": 400,
+                "playouts": 20000, "max_tree_nodes": 1 << 22}
+
+def set_mcts_backend(cb, options):
+    """
+    Runs every search with this callback as PUCT MCTS (options: dict of MctsOptions
+    fields), or back on alpha-beta if options is None. Leaves go through the bot's
+    evaluation_batch in groups of batch_size when it has one.
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.setMctsBackend.argtypes = [ctypes.c_void_p, ctypes.POINTER(MctsOptions)]
+    chess_lib.setMctsBackend.restype = None
+    if options is None:
+        chess_lib.setMctsBackend(cb.address, None)
+        return
+    unknown = set(options) - set(MctsOptions.DEFAULTS)
+    if unknown:
+        raise ValueError(f"Unknown MCTS options: {', '.join(sorted(unknown))}")
+    chess_lib.setMctsBackend(cb.address, ctypes.byref(MctsOptions(**{**MctsOptions.DEFAULTS, **options})))
+
+
+# -----------------------------------------------------------
+# TRACING (startTrace / stopTrace)
+# -----------------------------------------------------------
+def start_trace(events_per_thread=0, sample_every=0):
+    """
+    Starts recording a timeline of every native search: game moves, iterative deepening
+    iterations, root moves, batched evals, and 1 in `sample_every` eval calls and move
+    generations per thread (0 = engine defaults). Save it with stop_trace().
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.startTrace.argtypes = [ctypes.c_int64, ctypes.c_int]
+    chess_lib.startTrace.restype = None
+    chess_lib.startTrace(events_per_thread, sample_every)
+
+def stop_trace(path):
+    """
+    Stops recording and writes Chrome trace JSON (open it in ui.perfetto.dev).
+    Returns (events written, events dropped because a thread's buffer filled up).
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.stopTrace.argtypes = [ctypes.c_char_p, ctypes.POINTER(ctypes.c_uint64)]
+    chess_lib.stopTrace.restype = ctypes.c_int64
+    dropped = ctypes.c_uint64(0)
+    written = chess_lib.stopTrace(path.encode('utf-8'), ctypes.byref(dropped))
+    if written < 0:
+        raise IOError(f"Failed to write trace to {path}")
+    return written, dropped.value
+
+
+# -----------------------------------------------------------
+# BENCH (runBench / perfCounterStatus)
+# -----------------------------------------------------------
+PERF_EVENTS = ["cycles", "instructions", "l1d-misses", "llc-misses", "branch-misses"]
+BENCH_PHASES = [("attacks", "lookup"), ("perft", "move"), ("perft-copy", "move"), ("eval", "call"),
+                ("search", "node")]
+
+class BenchPhase(ctypes.Structure):
+    _fields_ = [
+        ("ops", ctypes.c_int64),
+        ("time_ns", ctypes.c_int64),
+        ("counters", ctypes.c_int64 * len(PERF_EVENTS)),    # -1 = unavailable
+    ]
+
+def run_bench(depth=0, bot=None, copy_make=False):
+    """
+    Runs the native bench (attack lookups, make/undo and copy-make perft, eval calls,
+    fixed-depth searches) with `bot` (a CallbackWrapper, or None for the built-in eval)
+    searching to `depth` (0 = engine default), with a copy-make search if `copy_make`.
+    Returns (search nodes, phase dicts, counter status), where each phase has its time
+    and whichever hardware counters the kernel allowed, and the status says why any are
+    missing ("" = none).
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.runBench.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_bool, ctypes.POINTER(BenchPhase)]
+    chess_lib.runBench.restype = ctypes.c_int64
+    chess_lib.perfCounterStatus.argtypes = [ctypes.c_char_p, ctypes.c_int]
+    chess_lib.perfCounterStatus.restype = ctypes.c_int
+
+    results = (BenchPhase * len(BENCH_PHASES))()
+    nodes = chess_lib.runBench(bot.address if bot else None, depth, copy_make, results)
+    status = ctypes.create_string_buffer(256)
+    chess_lib.perfCounterStatus(status, len(status))
+
+    phases = []
+    for (name, unit), r in zip(BENCH_PHASES, results):
+        counters = {event: r.counters[i] for i, event in enumerate(PERF_EVENTS) if r.counters[i] >= 0}
+        phases.append({"name": name, "unit": unit, "ops": r.ops, "time_ns": r.time_ns,
+                       "counters": counters})
+    return nodes, phases, status.value.decode('utf-8')
+
+def print_bench(nodes, phases, status=""):
+    for p in phases:
+        ops = max(p["ops"], 1)
+        line = (f"{p['name']:<10} {p['ops']:>11,} {p['unit']}s {p['time_ns'] / 1e6:>9.1f} ms "
+                f"{p['time_ns'] / ops:>8.1f} ns/{p['unit']}")
+        c = p["counters"]
+        if c.get("cycles"):
+            line += f"  ipc {c.get('instructions', 0) / c['cycles']:.2f}"
+        for event, value in c.items():
+            line += f"  {event}/{p['unit']} {value / ops:.3g}"
+        print(line)
+    search_ns = phases[-1]["time_ns"]
+    print(f"Nodes searched: {nodes}  ({nodes * 1e9 / max(search_ns, 1):,.0f} nodes/s)")
+    if status:
+        print(f"Hardware counters: {status}")
+
+
+# -----------------------------------------------------------
+# MEMORY PLACEMENT (configureMemory / memoryStatus)
+# -----------------------------------------------------------
+def configure_memory(large_pages=LARGE_PAGES, pin_threads=PIN_THREADS, replicate=NUMA_REPLICATE):
+    """
+    Sets how the engine places its big tables and threads. Only tables built and threads
+    started afterwards follow it, so call it before running anything.
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.configureMemory.argtypes = [ctypes.c_bool, ctypes.c_bool, ctypes.c_bool]
+    chess_lib.configureMemory.restype = None
+    chess_lib.configureMemory(large_pages, pin_threads, replicate)
+
+def memory_status():
+    """
+    Returns (NUMA nodes, one-line summary of huge page support, the configured options and
+    the page size and node placement of the attack tables).
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.memoryStatus.argtypes = [ctypes.c_char_p, ctypes.c_int]
+    chess_lib.memoryStatus.restype = ctypes.c_int
+    status = ctypes.create_string_buffer(512)
+    nodes = chess_lib.memoryStatus(status, len(status))
+    return nodes, status.value.decode('utf-8')
+
+
+# -----------------------------------------------------------
+# EPD TEST SUITES (runEpdSuite)
+# -----------------------------------------------------------
+# (position_index, solved)
+EPD_PROGRESS_CALLBACK_TYPE = ctypes.CFUNCTYPE(None, ctypes.c_int, ctypes.c_int)
+
+def run_epd_suite(epd_path, report_path, bot=None, time_ms=1000, nodes=0, depth=0,
+                  num_threads=0, on_progress=None):
+    """
+    Searches every bm/am position in an EPD file and writes a per-position report
+    (solved, time/nodes/depth to solution) as JSON if report_path ends in .json, else CSV.
+    `bot` is a CallbackWrapper, or None for the built-in eval. Returns (solved, total).
+    """
+    chess_lib = ctypes.CDLL(get_chess_lib_path())
+    chess_lib.runEpdSuite.argtypes = [
+        ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int64, ctypes.c_uint64,
+        ctypes.c_int, ctypes.c_int, ctypes.POINTER(ctypes.c_int), EPD_PROGRESS_CALLBACK_TYPE
+    ]
+    chess_lib.runEpdSuite.restype = ctypes.c_int
+
+    total = ctypes.c_int(0)
+    callback = EPD_PROGRESS_CALLBACK_TYPE(on_progress if on_progress else (lambda i, s: None))
+    init_tablebases(chess_lib)
+    solved = chess_lib.runEpdSuite(bot.address if bot else None, epd_path.encode('utf-8'),
+                                   report_path.encode('utf-8'), time_ms, nodes, depth,
+                                   num_threads, ctypes.byref(total), callback)
+    if solved == -1:
+        raise IOError(f"Failed to read EPD file {epd_path}")
+    if solved == -2:
+        raise IOError(f"Failed to write report {report_path}")
+    return solved, total.value
 
 
 # -----------------------------------------------------------
@@ -613,52 +1356,39 @@ class LauncherApp:
             self.set_status("✗  Select two different bots", FG_RED)
             return
 
-        # Resolve bot paths
         bot_a_name = w_name
         bot_b_name = b_name
-        base_dir = os.path.dirname(os.path.abspath(__file__))
-        bots_dir = os.path.join(base_dir, "bots")
-        bot_a_path = os.path.join(bots_dir, bot_a_name)
-        bot_b_path = os.path.join(bots_dir, bot_b_name)
+        bot_a_cb = self.bots_dict.get(bot_a_name)
+        bot_b_cb = self.bots_dict.get(bot_b_name)
 
-        if not os.path.isdir(bot_a_path) or not os.path.isdir(bot_b_path):
-            self.set_status("✗  Bot directory not found", FG_RED)
+        if bot_a_cb is None or bot_b_cb is None:
+            self.set_status("✗  Bot failed to load", FG_RED)
             return
 
-        # Build game list: 4 openings × 2 sides = 8 games
-        games = []
-        game_id = 0
-        for opening_name, fen in TOURNAMENT_OPENINGS:
-            games.append((game_id, bot_a_name, bot_a_path,
-                          bot_b_name, bot_b_path, fen, opening_name))
-            game_id += 1
-            games.append((game_id, bot_b_name, bot_b_path,
-                          bot_a_name, bot_a_path, fen, opening_name))
-            game_id += 1
-
-        num_games = len(games)
+        # 4 openings × 2 sides = 8 games
+        bots = [(bot_a_name, bot_a_cb), (bot_b_name, bot_b_cb)]
+        num_games = len(TOURNAMENT_OPENINGS) * 2
         self.set_status(f"Running {num_games} headless games…", FG_ACCENT)
 
         # Open results window
         results_win = ResultsWindow(self.root, bot_a_name, bot_b_name, num_games)
 
-        # Launch all games as separate processes
-        result_queue = multiprocessing.Queue()
-        processes = []
-        for (gid, w_n, w_p, b_n, b_p, fen, op_name) in games:
-            p = multiprocessing.Process(
-                target=_run_game_worker,
-                args=(result_queue, gid, w_n, w_p, b_n, b_p, fen, op_name,
-                      COMPETITION_DEPTH, MAX_MOVES_PER_GAME)
-            )
-            processes.append(p)
-            p.start()
+        # Run the whole match in-process on a background thread so the GUI stays live
+        result_queue = queue.Queue()
+        worker = threading.Thread(
+            target=_run_tournament_thread,
+            args=(result_queue, bots, TOURNAMENT_OPENINGS, 2,
+                  COMPETITION_DEPTH, MAX_MOVES_PER_GAME, TOURNAMENT_TIME_CONTROL,
+                  ADJUDICATION, OPENING_BOOK_PATH, BOOK_PLIES),
+            daemon=True
+        )
+        worker.start()
 
         # Poll for results without blocking the GUI
-        self._poll_results(results_win, result_queue, processes,
+        self._poll_results(results_win, result_queue, worker,
                            num_games, bot_a_name, bot_b_name)
 
-    def _poll_results(self, results_win, result_queue, processes,
+    def _poll_results(self, results_win, result_queue, worker,
                       total, bot_a, bot_b):
         """Non-blocking poll: checks the queue, updates the GUI, reschedules itself."""
         finished = 0
@@ -676,6 +1406,13 @@ class LauncherApp:
                     scores[black] = scores.get(black, 0) + b_pts
                 elif len(msg) == 6:
                     gid, opening, white, black, result_str, detail = msg
+                    if gid < 0:
+                        # Whole tournament failed; nothing else is coming
+                        print(f"[ERROR] Tournament crashed: {detail}")
+                        finished = total
+                        results_win.set_summary(result_str, detail)
+                        self.set_status(f"{len(self.bots_dict)} bot(s) loaded  ·  Ready")
+                        return
                     results_win.update_row(gid, opening, white, black, result_str, detail)
 
                 finished += 1
@@ -687,9 +1424,8 @@ class LauncherApp:
             if finished < total:
                 self.root.after(200, poll)
             else:
-                # All done — clean up processes
-                for p in processes:
-                    p.join(timeout=2)
+                # All done — the worker returns right after the last callback
+                worker.join(timeout=2)
 
                 a_score = scores.get(bot_a, 0)
                 b_score = scores.get(bot_b, 0)
@@ -710,10 +1446,123 @@ class LauncherApp:
 
 
 if __name__ == "__main__":
-    multiprocessing.set_start_method("spawn", force=True)
+    # Placement applies to tables built afterwards, so it goes first (the defaults need no call)
+    if not LARGE_PAGES or PIN_THREADS or NUMA_REPLICATE:
+        configure_memory()
+
+    # python main.py --trace out.json <any other command>  (also works for the launcher)
+    if len(sys.argv) > 2 and sys.argv[1] == "--trace":
+        trace_path = sys.argv[2]
+        del sys.argv[1:3]
+        start_trace()
+
+        def save_trace():
+            written, dropped = stop_trace(trace_path)
+            print(f"Wrote {written} trace events to {trace_path}"
+                  + (f" ({dropped} dropped)" if dropped else ""))
+        atexit.register(save_trace)
+
+    # python main.py --build-book games1.pgn [games2.pgn ...]
+    if len(sys.argv) > 2 and sys.argv[1] == "--build-book":
+        written = build_opening_book(sys.argv[2:])
+        print(f"Wrote {written} book entries to {OPENING_BOOK_PATH}")
+        sys.exit(0)
 
     base_dir = os.path.dirname(os.path.abspath(__file__))
     bots_dir = os.path.join(base_dir, "bots")
+
+    # python main.py --convert-positions positions.epd out.bin [errors.txt]
+    if len(sys.argv) > 3 and sys.argv[1] == "--convert-positions":
+        errors_path = sys.argv[4] if len(sys.argv) > 4 else None
+        written, bad = convert_positions(sys.argv[2], sys.argv[3], errors_path=errors_path)
+        print(f"Wrote {written} positions to {sys.argv[3]} ({bad} bad lines skipped)")
+        sys.exit(0)
+
+    # python main.py --profile-evals corpus.bin|corpus.epd [BotName ...]  (default: every bot)
+    if len(sys.argv) > 2 and sys.argv[1] == "--profile-evals":
+        names = sys.argv[3:] or sorted(
+            d for d in os.listdir(bots_dir)
+            if os.path.exists(os.path.join(bots_dir, d, "evaluation.py")))
+        profiled = [("built-in", None)]
+        for name in names:
+            cb = load_bot_safely(name, os.path.join(bots_dir, name))
+            if cb: profiled.append((name, cb))
+        leaderboard, correlation = profile_evals(sys.argv[2], profiled)
+        print_eval_leaderboard(leaderboard, correlation)
+        sys.exit(0)
+
+    # python main.py --calibrate-lazy corpus.bin|corpus.epd [BotName ...]  (default: every bot)
+    if len(sys.argv) > 2 and sys.argv[1] == "--calibrate-lazy":
+        names = sys.argv[3:] or sorted(
+            d for d in os.listdir(bots_dir)
+            if os.path.exists(os.path.join(bots_dir, d, "evaluation.py")))
+        margins = {}
+        for name in names:
+            cb = load_bot_safely(name, os.path.join(bots_dir, name))
+            if cb: margins[name] = calibrate_lazy_margin(sys.argv[2], cb)
+        print("LAZY_EVAL_MARGINS = {")
+        for name, margin in margins.items():
+            print(f"    {name!r}: {margin},")
+        print("}")
+        sys.exit(0)
+
+    # python main.py --bench [depth] [BotName]
+    if len(sys.argv) > 1 and sys.argv[1] == "--bench":
+        depth = int(sys.argv[2]) if len(sys.argv) > 2 else 0
+        bot = None
+        if len(sys.argv) > 3:
+            bot = load_bot_safely(sys.argv[3], os.path.join(bots_dir, sys.argv[3]))
+            if bot is None:
+                sys.exit(1)
+        print_bench(*run_bench(depth, bot))
+        print(f"Memory: {memory_status()[1]}")
+        sys.exit(0)
+
+    # python main.py --solve-mate "FEN" [max_moves] [node_budget]
+    if len(sys.argv) > 2 and sys.argv[1] == "--solve-mate":
+        max_moves = int(sys.argv[3]) if len(sys.argv) > 3 else 5
+        budget = int(sys.argv[4]) if len(sys.argv) > 4 else 0
+        started = time.time()
+        result = solve_mate(sys.argv[2], max_moves, budget)
+        elapsed = time.time() - started
+        if result["status"] == "mate":
+            print(f"Mate in {result['mate_in']}: {' '.join(result['pv'])}")
+        elif result["status"] == "no mate":
+            print(f"No mate in {max_moves}")
+        else:
+            print("Unknown: node budget reached")
+        print(f"{result['nodes']} nodes in {elapsed:.2f}s")
+        sys.exit(0)
+
+    # python main.py --epd suite.epd report.csv|report.json [BotName]
+    if len(sys.argv) > 3 and sys.argv[1] == "--epd":
+        bot = None
+        if len(sys.argv) > 4:
+            bot = load_bot_safely(sys.argv[4], os.path.join(bots_dir, sys.argv[4]))
+            if bot is None:
+                sys.exit(1)
+        solved, total = run_epd_suite(sys.argv[2], sys.argv[3], bot)
+        print(f"Solved {solved}/{total}; report written to {sys.argv[3]}")
+        sys.exit(0)
+
+    # python main.py --datagen out.bin num_games [BotName]
+    if len(sys.argv) > 3 and sys.argv[1] == "--datagen":
+        out_path, games = sys.argv[2], int(sys.argv[3])
+        bot = None
+        if len(sys.argv) > 4:
+            bot = load_bot_safely(sys.argv[4], os.path.join(bots_dir, sys.argv[4]))
+            if bot is None:
+                sys.exit(1)
+        started = time.time()
+
+        def report(done, positions):
+            if done % 100 == 0 or done == games:
+                rate = positions / max(time.time() - started, 1e-9) * 3600
+                print(f"{done}/{games} games, {positions} positions ({rate:,.0f}/hour)")
+
+        written = generate_training_data(out_path, games, bot, on_progress=report)
+        print(f"Wrote {written} positions to {out_path}")
+        sys.exit(0)
     bots = {}
     if os.path.exists(bots_dir):
         for bot_name in os.listdir(bots_dir):
@@ -0,0 +1,78 @@
+"""
+Engine attack lookups for bot evals, callable from @njit code.
+
+Evals only receive raw bitboards, so mobility or king-safety terms otherwise need
+attack generation written in Python loops. These bind the library's magic-bitboard
+lookups as ctypes functions, which Numba compiles to direct native calls:
+
+    import native_attacks as na
+
+    @njit(int32(int64[:], int64[:], uint32))
+    def evaluation_function(board_pieces, board_occupancy, side_to_move):
+        rooks = board_pieces[3]
+        mobility = 0
+        while rooks:
+            sq = na.lsb(rooks)
+            mobility += na.pop_count(na.rook_attacks(sq, board_occupancy[2]) & ~board_occupancy[0])
+            rooks &= rooks - 1
+        ...
+
+Bitboards are int64 (like board_pieces) so results mix with them without float
+promotion. Squares are 0-63 with A1 = 0; side is 0 = white, 1 = black.
+"""
+import os
+import ctypes
+import platform
+from numba import njit
+
+
+def _chess_lib_path():
+    """Same lookup as main.get_chess_lib_path, without importing the launcher."""
+    bindings_dir = os.path.abspath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "bindings"))
+    system = platform.system()
+    if system == "Windows":
+        lib_name = "ChessLib.dll"
+    elif system == "Linux":
+        lib_name = "libChessLib.so"
+    elif system == "Darwin":
+        lib_name = "libChessLib_arm64.dylib" if platform.machine() == "arm64" else "libChessLib_intel.dylib"
+    else:
+        raise RuntimeError(f"Unsupported platform: {system}")
+    return os.path.join(bindings_dir, lib_name)
+
+
+_lib = ctypes.CDLL(_chess_lib_path())
+_lib.initAttackTables()
+
+
+def _bind(name, argtypes, restype=ctypes.c_int64):
+    fn = getattr(_lib, name)
+    fn.argtypes = argtypes
+    fn.restype = restype
+    return fn
+
+
+_SQ, _BB, _SIDE = ctypes.c_int32, ctypes.c_int64, ctypes.c_int32
+
+# Sliders: attacks from sq given the occupied squares (blockers included). Every lookup
+# returns 0 for sq outside 0-63, so lsb() of an empty bitboard can be passed straight in.
+rook_attacks = _bind("rookAttacks", [_SQ, _BB])
+bishop_attacks = _bind("bishopAttacks", [_SQ, _BB])
+queen_attacks = _bind("queenAttacks", [_SQ, _BB])
+
+# Leapers
+knight_attacks = _bind("knightAttacks", [_SQ])
+king_attacks = _bind("kingAttacks", [_SQ])
+pawn_attacks = _bind("pawnAttacks", [_SQ, _SIDE])           # One pawn of side on sq
+pawn_attack_span = _bind("pawnAttackSpan", [_BB, _SIDE])    # Every pawn in a bitboard at once
+
+pop_count = _bind("popCount", [_BB], ctypes.c_int32)
+lsb = _bind("lsbIndex", [_BB], ctypes.c_int32)              # 64 for an empty bitboard
+
+_attack_map = _bind("attackMap", [ctypes.c_void_p, _BB, _SIDE])
+
+
+@njit
+def attack_map(board_pieces, board_occupancy, side):
+    """Every square attacked by side, own pieces included."""
+    return _attack_map(board_pieces.ctypes.data, board_occupancy[2], side)
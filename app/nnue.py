@@ -0,0 +1,96 @@
+"""
+Export numpy-trained networks for the engine's native evaluator (include/Nnue.hpp).
+
+Architecture: 768 inputs -> `hidden` clipped-ReLU units per side -> 1 output.
+Inputs are (piece, square) pairs seen from one side: own pieces first, and squares
+flipped vertically for black, so one set of feature weights serves both sides:
+
+    us   = clip(feature_bias + feature_weights[features(pieces, side_to_move)].sum(0), 0, 1)
+    them = clip(feature_bias + feature_weights[features(pieces, other side)].sum(0), 0, 1)
+    eval = (us @ output_weights[:hidden] + them @ output_weights[hidden:] + output_bias) * scale
+
+with eval in centipawns for the side to move. Train that in float with any framework,
+then write it with export_network(); bots use it by setting NNUE_WEIGHTS in evaluation.py.
+The engine keeps the first layer in int16 accumulators updated move by move, so a leaf
+only costs the output layer.
+
+Only needs numpy. Feature encoding matches training_data.to_bitboards output.
+"""
+import struct
+import numpy as np
+
+INPUTS = 768
+MAGIC = b"CENN"
+VERSION = 1
+QA = 255        # Hidden activations: 1.0 -> QA
+QB = 64         # Output weights: 1.0 -> QB
+
+
+def feature_indices(board_pieces, perspective):
+    """Active input indices of one position (12 piece bitboards) from perspective 0/1."""
+    out = []
+    for piece in range(12):
+        bb = int(board_pieces[piece]) & 0xFFFFFFFFFFFFFFFF
+        colour, kind = divmod(piece, 6)
+        if perspective == 1:
+            colour ^= 1
+        while bb:
+            sq = (bb & -bb).bit_length() - 1
+            bb &= bb - 1
+            if perspective == 1:
+                sq ^= 56
+            out.append((colour * 6 + kind) * 64 + sq)
+    return out
+
+
+def encode(boards, side_to_move):
+    """(N, 12) uint64 bitboards + (N,) side to move -> (us, them) float32 (N, 768) inputs."""
+    boards = np.asarray(boards, dtype=np.uint64)
+    stm = np.asarray(side_to_move).astype(bool)
+    squares = np.arange(64, dtype=np.uint64)
+    # (N, 12, 64) occupancy bits; black's view flips ranks and swaps colours
+    bits = ((boards[:, :, None] >> squares) & np.uint64(1)).astype(np.float32)
+    white_view = bits.reshape(-1, INPUTS)
+    flipped = bits.reshape(-1, 12, 8, 8)[:, :, ::-1, :].reshape(-1, 12, 64)
+    black_view = np.concatenate([flipped[:, 6:], flipped[:, :6]], axis=1).reshape(-1, INPUTS)
+    us = np.where(stm[:, None], black_view, white_view)
+    them = np.where(stm[:, None], white_view, black_view)
+    return us, them
+
+
+def evaluate(net, board_pieces, side_to_move):
+    """Float reference of the engine's eval; net = (feature_weights, feature_bias, output_weights, output_bias, scale)."""
+    fw, fb, ow, ob, scale = net
+    hidden = fb.shape[0]
+    us = np.clip(fb + fw[feature_indices(board_pieces, side_to_move)].sum(0), 0.0, 1.0)
+    them = np.clip(fb + fw[feature_indices(board_pieces, side_to_move ^ 1)].sum(0), 0.0, 1.0)
+    return float((us @ ow[:hidden] + them @ ow[hidden:] + ob) * scale)
+
+
+def export_network(path, feature_weights, feature_bias, output_weights, output_bias, scale=400):
+    """
+    Quantizes a float network and writes it in the engine's format.
+    feature_weights (768, hidden), feature_bias (hidden,), output_weights (2 * hidden,),
+    output_bias scalar; hidden must be a multiple of 16 (at most 1024).
+    Weights are rounded and clipped to int16, so keep |feature weights| < 128 and
+    |output weights| < 512 for an exact export.
+    """
+    fw = np.asarray(feature_weights, dtype=np.float64)
+    fb = np.asarray(feature_bias, dtype=np.float64).reshape(-1)
+    ow = np.asarray(output_weights, dtype=np.float64).reshape(-1)
+    hidden = fb.shape[0]
+    if fw.shape != (INPUTS, hidden) or ow.shape != (2 * hidden,):
+        raise ValueError(f"expected (768, H), (H,), (2H,) weights, got {fw.shape}, {fb.shape}, {ow.shape}")
+    if hidden % 16 != 0 or hidden > 1024:
+        raise ValueError("hidden size must be a multiple of 16 and at most 1024")
+
+    def q16(x, factor):
+        return np.clip(np.round(x * factor), -32768, 32767).astype("<i2")
+
+    with open(path, "wb") as f:
+        f.write(MAGIC)
+        f.write(struct.pack("<IIiii", VERSION, hidden, int(scale), QA, QB))
+        f.write(q16(fw, QA).tobytes())
+        f.write(q16(fb, QA).tobytes())
+        f.write(q16(ow, QB).tobytes())
+        f.write(struct.pack("<i", int(round(float(output_bias) * QA * QB))))
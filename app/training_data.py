@@ -0,0 +1,87 @@
+"""
+Reader for the self-play records written by `python main.py --datagen`.
+
+FEN/EPD files converted with `python main.py --convert-positions` use the same
+layout. Each record is 32 bytes (DataGen::PackedPosition in include/DataGen.hpp):
+    occupancy         uint64   occupied squares, A1 = bit 0
+    pieces            16 bytes piece index 0-11 per occupied square in ascending
+                               square order, two per byte, low nibble first
+    score             int16    search score from the side to move's point of view
+    result            uint8    0 = black won, 1 = draw, 2 = white won, 255 = unknown
+    stm_castle        uint8    bit 0: black to move; bits 4-7: castle rights
+    en_passant        uint8    square index, 64 = none
+    half_move_clock   uint8
+    full_move_number  uint16
+
+Only needs numpy, so training scripts can import it without the launcher.
+"""
+import os
+import numpy as np
+
+POSITION_DTYPE = np.dtype([
+    ("occupancy", "<u8"),
+    ("pieces", "u1", (16,)),
+    ("score", "<i2"),
+    ("result", "u1"),
+    ("stm_castle", "u1"),
+    ("en_passant", "u1"),
+    ("half_move_clock", "u1"),
+    ("full_move_number", "<u2"),
+])
+assert POSITION_DTYPE.itemsize == 32
+
+
+def count_positions(path):
+    return os.path.getsize(path) // POSITION_DTYPE.itemsize
+
+
+def load_positions(path):
+    """Memory-maps the whole file as a structured array (nothing is read up front)."""
+    return np.memmap(path, dtype=POSITION_DTYPE, mode="r", shape=(count_positions(path),))
+
+
+def iter_positions(path, chunk_size=1 << 20):
+    """Yields structured arrays of up to chunk_size records, reading the file sequentially."""
+    with open(path, "rb") as f:
+        while True:
+            chunk = np.fromfile(f, dtype=POSITION_DTYPE, count=chunk_size)
+            if chunk.size == 0:
+                return
+            yield chunk
+
+
+def to_bitboards(records):
+    """(N,) records -> (N, 12) uint64 piece bitboards in the evaluation_function order."""
+    n = records.shape[0]
+    occupancy = records["occupancy"]
+    pieces = records["pieces"]
+    rows = np.arange(n)
+
+    boards = np.zeros((n, 12), dtype=np.uint64)
+    count = np.zeros(n, dtype=np.int64)     # Occupied squares seen so far per record
+    for sq in range(64):
+        present = ((occupancy >> np.uint64(sq)) & np.uint64(1)).astype(bool)
+        if not present.any():
+            continue
+        idx = rows[present]
+        k = count[present]
+        piece = (pieces[idx, k // 2] >> ((k & 1) * 4).astype(np.uint8)) & 0xF
+        boards[idx, piece] |= np.uint64(1) << np.uint64(sq)
+        count += present
+    return boards
+
+
+def side_to_move(records):
+    """0 = white, 1 = black, matching evaluation_function's side_to_move."""
+    return (records["stm_castle"] & 1).astype(np.uint32)
+
+
+RESULT_UNKNOWN = 255
+
+
+def result_for_side_to_move(records):
+    """Game result as 1.0 / 0.5 / 0.0 from the side to move's point of view (NaN if unknown)."""
+    raw = records["result"]
+    white = raw.astype(np.float32) / 2.0
+    stm = np.where(side_to_move(records) == 0, white, 1.0 - white)
+    return np.where(raw == RESULT_UNKNOWN, np.nan, stm).astype(np.float32)
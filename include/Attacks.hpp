@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Types.hpp"
+#include "Memory.hpp"
 #include <array>
 #include <cstdint>
 
@@ -21,6 +22,9 @@ namespace Attacks {
 
     void init();
 
+    // Where init() put the magic lookup tables (for placement reports)
+    const Memory::Block& table_memory();
+
     // Magic Lookups
     uint64_t get_rook_attacks(int sq, uint64_t occ);
     uint64_t get_bishop_attacks(int sq, uint64_t occ);
@@ -29,4 +33,10 @@ namespace Attacks {
     }
 
     bool is_square_attacked(Square sq, Colour attacker, const uint64_t pieces[], uint64_t all_occ);
+
+    // Set-wise: squares attacked by all of side's pawns at once
+    uint64_t get_pawn_attacks(Colour side, uint64_t pawns);
+
+    // Every square attacked by side (pieces in the 12-bitboard order, own pieces included)
+    uint64_t attacked_squares(Colour side, const uint64_t pieces[], uint64_t all_occ);
 }
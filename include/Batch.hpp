@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Game.hpp"
+#include <cstdint>
+#include <vector>
+
+// Many headless games on the calling thread, every search running as a coroutine
+// (SearchCoroutine). A search suspends at each eval of a bot with a registered batch eval;
+// once every game in flight is waiting, each bot scores all of its queued positions in one
+// call and the searches resume. Per-call costs (ctypes, interpreter, matrix setup) are then
+// paid once per round rather than once per leaf.
+namespace Batch {
+
+    // Plain C layout for ctypes
+    struct Stats {
+        int64_t rounds;         // Gather / score / resume cycles
+        int64_t positions;      // Positions scored through batch evals
+        int64_t batch_calls;    // One per distinct batch eval per round
+        int64_t max_batch;      // Largest single call
+    };
+
+    // Plays every config; results come back in config order. At most max_active games
+    // (<= 0 = all) are in flight at once, each holding its two sides' hash tables.
+    // Clocks are ignored, since a search's wall time would include every other game's:
+    // games are bounded by depth / max_nodes. Apart from timings, results match Game::play.
+    std::vector<Game::GameResult> play(const std::vector<Game::GameConfig>& configs,
+                                       int max_active, Stats* stats = nullptr);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Search.hpp"
+#include "PerfCounters.hpp"
+#include <cstdint>
+#include <string>
+
+// Fixed workload over a built-in set of positions, split into phases so a change can be
+// traced to the layer it slowed down: slider attack lookups, move generation with
+// make/undo and with copy-make (perft), eval calls, then full fixed-depth searches. Each
+// phase is timed and, where the kernel allows, measured with hardware counters on the
+// calling thread.
+namespace Bench {
+
+    enum Phase : int {
+        AttackLookups = 0,      // Magic rook/bishop lookups
+        Perft         = 1,      // Generate, make, legality check, undo
+        PerftCopy     = 2,      // The same walk copy-make: each child is a copy of its parent
+        EvalCalls     = 3,      // The eval callback on positions from the perft walk
+        Searches      = 4,      // Fixed-depth searches, fresh tables per position
+        NUM_PHASES    = 5
+    };
+
+    const char* phase_name(int phase);
+
+    // Plain C layout for ctypes
+    struct PhaseResult {
+        int64_t ops;                    // Lookups / moves made / eval calls / nodes
+        int64_t time_ns;
+        PerfCounters::Values counters;  // Whole phase, -1 where unavailable
+    };
+
+    struct Options {
+        int depth = 6;                  // Search depth
+        int perft_depth = 3;
+        Search::EvalCallback eval = nullptr;    // nullptr = the built-in eval
+        size_t hash_mb = 16;
+        bool copy_make = false;         // SearchParams::copy_make for the search phase
+    };
+
+    // Runs every phase on the calling thread; results gets NUM_PHASES entries. Returns
+    // the total search nodes, which only changes when the search does.
+    uint64_t run(const Options& options, PhaseResult* results);
+
+    // Why results are missing counters on this thread ("" = none missing)
+    const std::string& counters_status();
+}
@@ -27,4 +27,12 @@ namespace BitUtil {
     constexpr int count_bits(Bitboard bb) {
         return std::popcount(bb);
     }
+
+    // Small, fast PRNG step for reproducible choices (book picks, random openings)
+    constexpr uint64_t splitmix64(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
 }
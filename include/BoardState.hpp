@@ -3,12 +3,17 @@
 #include "Types.hpp"
 #include "BitUtil.hpp"
 #include "Zobrist.hpp"
-#include <vector>
+#include "Nnue.hpp"
 #include <array>
 #include <algorithm>
-#include <sstream>
-
-struct BoardState {
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+
+// Everything that defines a position and nothing that depends on how it was reached.
+// Trivially copyable, so a copy is a ~150-byte memcpy: copy-make searches, per-thread
+// roots and GUI snapshots copy this rather than a whole BoardState.
+struct Position {
     std::array<uint64_t, 12> pieces;
     std::array<uint64_t, 3> occupancy;
     
@@ -18,18 +23,20 @@ struct BoardState {
     uint16_t half_move_clock; 
     uint16_t full_move_number;
     uint64_t key;
+    uint64_t pawn_key;      // Pawns only (for pawn-structure caches)
 
-    struct History {
-        Move move;
-        uint8_t castle_rights;
+    // What make_move overwrites that undo_move can't work out from the move
+    struct Undo {
+        uint64_t key; // Store hash history
+        uint64_t pawn_key;
         Square en_passant_sq;
+        Move move;
         uint16_t half_move_clock;
-        uint64_t captured_piece; 
-        uint64_t key; // Store hash history
+        uint8_t castle_rights;
+        int8_t captured_piece;      // Piece index, -1 = none
     };
-    std::vector<History> history;
 
-    BoardState() {
+    Position() {
         pieces.fill(0);
         occupancy.fill(0);
         to_move = Colour::White;
@@ -38,17 +45,19 @@ struct BoardState {
         half_move_clock = 0;
         full_move_number = 1;
         key = 0;
-        history.reserve(256);
+        pawn_key = 0;
     }
 
     void refresh_hash() {
         key = 0;
+        pawn_key = 0;
         for (int p = 0; p < 12; ++p) {
             uint64_t bb = pieces[p];
             while (bb) {
                 int sq = BitUtil::lsb(bb);
                 BitUtil::clear_bit(bb, static_cast<Square>(sq));
                 key ^= Zobrist::piece_keys[p][sq];
+                if (p == 0 || p == 6) pawn_key ^= Zobrist::piece_keys[p][sq];
             }
         }
         key ^= Zobrist::castle_keys[castle_rights];
@@ -60,24 +69,43 @@ struct BoardState {
         }
     }
 
-    void load_fen(std::string fen) {
+    // Parses a FEN without allocating; EPD-style input without the two clock fields gets
+    // "0 1". Returns false on malformed input (the board is then unspecified).
+    bool load_fen(std::string_view fen) {
         pieces.fill(0);
         occupancy.fill(0);
-        history.clear();
-        
-        std::stringstream ss(fen);
-        std::string placement, turn, castling, ep, half, full;
-        ss >> placement >> turn >> castling >> ep >> half >> full;
+        to_move = Colour::White;
+        en_passant_sq = Square::None;
+        castle_rights = 0;
+        half_move_clock = 0;
+        full_move_number = 1;
+        key = 0;
+        pawn_key = 0;
+
+        size_t pos = 0;
+        auto next_field = [&]() -> std::string_view {
+            while (pos < fen.size() && (fen[pos] == ' ' || fen[pos] == '\t' || fen[pos] == '\r')) ++pos;
+            size_t begin = pos;
+            while (pos < fen.size() && fen[pos] != ' ' && fen[pos] != '\t' && fen[pos] != '\r') ++pos;
+            return fen.substr(begin, pos - begin);
+        };
+        std::string_view placement = next_field();
+        std::string_view turn = next_field();
+        std::string_view castling = next_field();
+        std::string_view ep = next_field();
+        std::string_view half = next_field();
+        std::string_view full = next_field();
 
         int rank = 7;
         int file = 0;
-        
         for (char c : placement) {
             if (c == '/') {
+                if (file != 8 || rank == 0) return false;
                 rank--;
                 file = 0;
-            } else if (isdigit(c)) {
+            } else if (c >= '1' && c <= '8') {
                 file += (c - '0');
+                if (file > 8) return false;
             } else {
                 int piece = -1;
                 switch(c) {
@@ -94,190 +122,207 @@ struct BoardState {
                     case 'q': piece = 10; break;
                     case 'k': piece = 11; break;
                 }
-                if (piece != -1) {
-                    Square sq = static_cast<Square>(rank * 8 + file);
-                    BitUtil::set_bit(pieces[piece], sq);
-                    file++;
-                }
+                if (piece == -1 || file >= 8) return false;
+                Square sq = static_cast<Square>(rank * 8 + file);
+                BitUtil::set_bit(pieces[piece], sq);
+                file++;
             }
         }
+        if (rank != 0 || file != 8) return false;
 
         for (int i = 0; i < 6; ++i) occupancy[0] |= pieces[i];
         for (int i = 6; i < 12; ++i) occupancy[1] |= pieces[i];
         occupancy[2] = occupancy[0] | occupancy[1];
 
-        to_move = (turn == "w") ? Colour::White : Colour::Black;
+        if (turn == "w") to_move = Colour::White;
+        else if (turn == "b") to_move = Colour::Black;
+        else return false;
 
-        castle_rights = 0;
         if (castling != "-") {
-            if (castling.find('K') != std::string::npos) castle_rights |= 1;
-            if (castling.find('Q') != std::string::npos) castle_rights |= 2;
-            if (castling.find('k') != std::string::npos) castle_rights |= 4;
-            if (castling.find('q') != std::string::npos) castle_rights |= 8;
+            for (char c : castling) {
+                switch (c) {
+                    case 'K': castle_rights |= 1; break;
+                    case 'Q': castle_rights |= 2; break;
+                    case 'k': castle_rights |= 4; break;
+                    case 'q': castle_rights |= 8; break;
+                    default: return false;
+                }
+            }
         }
 
-        en_passant_sq = Square::None;
         if (ep != "-") {
-            int f = ep[0] - 'a';
-            int r = ep[1] - '1';
-            en_passant_sq = static_cast<Square>(r * 8 + f);
+            if (ep.size() != 2 || ep[0] < 'a' || ep[0] > 'h' || ep[1] < '1' || ep[1] > '8') return false;
+            en_passant_sq = static_cast<Square>((ep[1] - '1') * 8 + (ep[0] - 'a'));
         }
 
-        try {
-            half_move_clock = std::stoi(half);
-            full_move_number = std::stoi(full);
-        } catch (...) {
-            half_move_clock = 0;
-            full_move_number = 1;
+        // Clocks are optional; anything else after them (EPD operations) is ignored
+        uint16_t value = 0;
+        if (!half.empty() && std::from_chars(half.data(), half.data() + half.size(), value).ec == std::errc()) {
+            half_move_clock = value;
+            if (!full.empty() && std::from_chars(full.data(), full.data() + full.size(), value).ec == std::errc())
+                full_move_number = value;
         }
 
         refresh_hash();
+        return true;
     }
 
-    bool is_draw() const {
-        if (half_move_clock >= 100) return true;
+    // K v K, K+minor v K, and K+B v K+B with same-coloured bishops
+    bool insufficient_material() const {
+        if (pieces[0] | pieces[6] | pieces[3] | pieces[9] | pieces[4] | pieces[10]) return false;
 
-        int rep_count = 0;
-        int limit = std::min((int)history.size(), (int)half_move_clock);
-        
-        for (int i = history.size() - 2; i >= (int)history.size() - limit; i -= 2) {
-            if (history[i].key == key) {
-                rep_count++;
-                if (rep_count >= 2) return true;  // Threefold: current + 2 previous
-            }
+        uint64_t knights = pieces[1] | pieces[7];
+        uint64_t bishops = pieces[2] | pieces[8];
+        int minors = BitUtil::count_bits(knights | bishops);
+        if (minors <= 1) return true;
+
+        if (knights == 0 && BitUtil::count_bits(pieces[2]) == 1 && BitUtil::count_bits(pieces[8]) == 1) {
+            constexpr uint64_t dark_squares = 0xAA55AA55AA55AA55ULL;
+            return ((bishops & dark_squares) == 0) || ((bishops & ~dark_squares) == 0);
         }
         return false;
     }
 
-    void make_move(Move move) {
+    // dirty (may be nullptr) collects the piece changes for a native network
+    void make_move(Move move, Undo& h, Nnue::DirtyPieces* dirty = nullptr) {
+        if (to_move == Colour::White) make_move_as<Colour::White>(move, h, dirty);
+        else make_move_as<Colour::Black>(move, h, dirty);
+    }
+
+    // h must be what make_move(move, h) filled in
+    void undo_move(Move move, const Undo& h) {
+        if (to_move == Colour::Black) undo_move_as<Colour::White>(move, h);
+        else undo_move_as<Colour::Black>(move, h);
+    }
+
+private:
+    // Castling rights that survive a move from or to each square
+    static constexpr std::array<uint8_t, 64> CASTLE_KEEP = [] {
+        std::array<uint8_t, 64> keep{};
+        keep.fill(15);
+        keep[static_cast<int>(Square::E1)] = 15 & ~3;
+        keep[static_cast<int>(Square::H1)] = 15 & ~1;
+        keep[static_cast<int>(Square::A1)] = 15 & ~2;
+        keep[static_cast<int>(Square::E8)] = 15 & ~12;
+        keep[static_cast<int>(Square::H8)] = 15 & ~4;
+        keep[static_cast<int>(Square::A8)] = 15 & ~8;
+        return keep;
+    }();
+
+    void move_piece(int piece, Square from, Square to, int side) {
+        Bitboard change = BitUtil::from_square(from) | BitUtil::from_square(to);
+        pieces[piece] ^= change;
+        occupancy[side] ^= change;
+        occupancy[2] ^= change;
+    }
+
+    // Us is the side making the move; everything that depends on it is a constant
+    template <Colour Us>
+    void make_move_as(Move move, Undo& h, Nnue::DirtyPieces* dirty) {
+        constexpr int us = static_cast<int>(Us);
+        constexpr int them = us ^ 1;
+        constexpr int up = (Us == Colour::White) ? 8 : -8;
+        constexpr Square rook_h = (Us == Colour::White) ? Square::H1 : Square::H8;
+        constexpr Square rook_f = (Us == Colour::White) ? Square::F1 : Square::F8;
+        constexpr Square rook_a = (Us == Colour::White) ? Square::A1 : Square::A8;
+        constexpr Square rook_d = (Us == Colour::White) ? Square::D1 : Square::D8;
+
         Square from = move.from();
         Square to = move.to();
         MoveFlag flag = move.flag();
-        
-        int us = static_cast<int>(to_move);
-        int them = us ^ 1;
 
-        History h;
         h.move = move;
         h.castle_rights = castle_rights;
         h.en_passant_sq = en_passant_sq;
         h.half_move_clock = half_move_clock;
-        h.captured_piece = 0; 
+        h.captured_piece = -1; 
         h.key = key; // Save current hash
+        h.pawn_key = pawn_key;
 
         // --- HASH UPDATE (REMOVE OLD STATE) ---
         if (en_passant_sq != Square::None) key ^= Zobrist::en_passant_keys[static_cast<int>(en_passant_sq)];
         key ^= Zobrist::castle_keys[castle_rights];
         
-        // Update Logic
         half_move_clock++; // Increment clock by default
 
         // Identify moving piece
-        int piece_idx = -1;
-        for (int i = us * 6; i < us * 6 + 6; ++i) {
-            if (BitUtil::get_bit(pieces[i], from)) {
-                piece_idx = i;
-                break;
-            }
-        }
-
-        // Remove From (Hash & Bitboard)
-        BitUtil::clear_bit(pieces[piece_idx], from);
-        BitUtil::clear_bit(occupancy[us], from);
-        BitUtil::clear_bit(occupancy[2], from);
-        key ^= Zobrist::piece_keys[piece_idx][static_cast<int>(from)];
-
-        // Pawn Move Reset
-        if (piece_idx == 0 || piece_idx == 6) half_move_clock = 0;
+        int piece_idx = us * 6;
+        while (!BitUtil::get_bit(pieces[piece_idx], from)) ++piece_idx;
 
         // Captures
         if (BitUtil::get_bit(occupancy[them], to)) {
             half_move_clock = 0; // Reset 50mr
-            for (int i = them * 6; i < them * 6 + 6; ++i) {
-                if (BitUtil::get_bit(pieces[i], to)) {
-                    BitUtil::clear_bit(pieces[i], to);
-                    h.captured_piece = (1ULL << i); 
-                    key ^= Zobrist::piece_keys[i][static_cast<int>(to)]; // Hash out capture
-                    break;
-                }
-            }
+            int i = them * 6;
+            while (!BitUtil::get_bit(pieces[i], to)) ++i;
+            BitUtil::clear_bit(pieces[i], to);
             BitUtil::clear_bit(occupancy[them], to);
             BitUtil::clear_bit(occupancy[2], to);
+            h.captured_piece = static_cast<int8_t>(i); 
+            key ^= Zobrist::piece_keys[i][static_cast<int>(to)]; // Hash out capture
+            if (i == them * 6) pawn_key ^= Zobrist::piece_keys[i][static_cast<int>(to)];
+            if (dirty) dirty->remove(i, static_cast<int>(to));
+        }
+
+        // Pawn Move Reset
+        if (piece_idx == us * 6) {
+            half_move_clock = 0;
+            pawn_key ^= Zobrist::piece_keys[piece_idx][static_cast<int>(from)];
         }
 
         // En Passant Capture
         if (flag == MoveFlag::EnPassant) {
-            Square cap_sq = static_cast<Square>(static_cast<int>(to) + (us == 0 ? -8 : 8));
+            Square cap_sq = static_cast<Square>(static_cast<int>(to) - up);
             BitUtil::clear_bit(pieces[them * 6], cap_sq);
             BitUtil::clear_bit(occupancy[them], cap_sq);
             BitUtil::clear_bit(occupancy[2], cap_sq);
             key ^= Zobrist::piece_keys[them * 6][static_cast<int>(cap_sq)]; // Hash out EP capture
-            half_move_clock = 0;
+            pawn_key ^= Zobrist::piece_keys[them * 6][static_cast<int>(cap_sq)];
+            if (dirty) dirty->remove(them * 6, static_cast<int>(cap_sq));
         }
 
-        // Place Piece (Hash & Bitboard)
+        // Move the piece; a promotion swaps the pawn for the piece in the flag's low bits
+        // (0 = knight .. 3 = queen)
         int final_piece_idx = piece_idx;
-        
-        // Promotions
+        key ^= Zobrist::piece_keys[piece_idx][static_cast<int>(from)];
+        if (dirty) dirty->remove(piece_idx, static_cast<int>(from));
         if (flag >= MoveFlag::KnightPromotion) {
-             // 0=P, 1=N, 2=B, 3=R, 4=Q
-             int offset = 0;
-             if (flag == MoveFlag::KnightPromotion || flag == MoveFlag::KnightPromoCapture) offset = 1;
-             else if (flag == MoveFlag::BishopPromotion || flag == MoveFlag::BishopPromoCapture) offset = 2;
-             else if (flag == MoveFlag::RookPromotion || flag == MoveFlag::RookPromoCapture) offset = 3;
-             else offset = 4; // Queen
-             final_piece_idx = us * 6 + offset;
+            final_piece_idx = us * 6 + 1 + (static_cast<int>(flag) & 3);
+            BitUtil::clear_bit(pieces[piece_idx], from);
+            BitUtil::set_bit(pieces[final_piece_idx], to);
+            occupancy[us] ^= BitUtil::from_square(from) | BitUtil::from_square(to);
+            occupancy[2] ^= BitUtil::from_square(from);
+            occupancy[2] |= BitUtil::from_square(to);
+        } else {
+            pieces[piece_idx] ^= BitUtil::from_square(from) | BitUtil::from_square(to);
+            occupancy[us] ^= BitUtil::from_square(from) | BitUtil::from_square(to);
+            occupancy[2] ^= BitUtil::from_square(from);
+            occupancy[2] |= BitUtil::from_square(to);
         }
-
-        BitUtil::set_bit(pieces[final_piece_idx], to);
-        BitUtil::set_bit(occupancy[us], to);
-        BitUtil::set_bit(occupancy[2], to);
         key ^= Zobrist::piece_keys[final_piece_idx][static_cast<int>(to)]; // Hash in new piece
-
-        // Castling Physical Move
-        if (flag == MoveFlag::KingCastle) {
-            Square r_from = (us == 0) ? Square::H1 : Square::H8;
-            Square r_to = (us == 0) ? Square::F1 : Square::F8;
-            int r_idx = us * 6 + 3;
-            // Move Rook
-            BitUtil::clear_bit(pieces[r_idx], r_from);
-            BitUtil::clear_bit(occupancy[us], r_from);
-            BitUtil::clear_bit(occupancy[2], r_from);
+        if (final_piece_idx == us * 6) pawn_key ^= Zobrist::piece_keys[final_piece_idx][static_cast<int>(to)];
+        if (dirty) dirty->add(final_piece_idx, static_cast<int>(to));
+
+        // Castling: the rook jumps over the king
+        if (flag == MoveFlag::KingCastle || flag == MoveFlag::QueenCastle) {
+            Square r_from = (flag == MoveFlag::KingCastle) ? rook_h : rook_a;
+            Square r_to = (flag == MoveFlag::KingCastle) ? rook_f : rook_d;
+            constexpr int r_idx = us * 6 + 3;
+            move_piece(r_idx, r_from, r_to, us);
             key ^= Zobrist::piece_keys[r_idx][static_cast<int>(r_from)];
-
-            BitUtil::set_bit(pieces[r_idx], r_to);
-            BitUtil::set_bit(occupancy[us], r_to);
-            BitUtil::set_bit(occupancy[2], r_to);
-            key ^= Zobrist::piece_keys[r_idx][static_cast<int>(r_to)];
-        } 
-        else if (flag == MoveFlag::QueenCastle) {
-            Square r_from = (us == 0) ? Square::A1 : Square::A8;
-            Square r_to = (us == 0) ? Square::D1 : Square::D8;
-            int r_idx = us * 6 + 3;
-            // Move Rook
-            BitUtil::clear_bit(pieces[r_idx], r_from);
-            BitUtil::clear_bit(occupancy[us], r_from);
-            BitUtil::clear_bit(occupancy[2], r_from);
-            key ^= Zobrist::piece_keys[r_idx][static_cast<int>(r_from)];
-
-            BitUtil::set_bit(pieces[r_idx], r_to);
-            BitUtil::set_bit(occupancy[us], r_to);
-            BitUtil::set_bit(occupancy[2], r_to);
             key ^= Zobrist::piece_keys[r_idx][static_cast<int>(r_to)];
+            if (dirty) {
+                dirty->remove(r_idx, static_cast<int>(r_from));
+                dirty->add(r_idx, static_cast<int>(r_to));
+            }
         }
 
         // Update Rights
-        if (from == Square::E1 || to == Square::E1) castle_rights &= ~3;
-        if (from == Square::E8 || to == Square::E8) castle_rights &= ~12;
-        if (from == Square::H1 || to == Square::H1) castle_rights &= ~1;
-        if (from == Square::A1 || to == Square::A1) castle_rights &= ~2;
-        if (from == Square::H8 || to == Square::H8) castle_rights &= ~4;
-        if (from == Square::A8 || to == Square::A8) castle_rights &= ~8;
+        castle_rights &= CASTLE_KEEP[static_cast<int>(from)] & CASTLE_KEEP[static_cast<int>(to)];
 
         // Update En Passant
         en_passant_sq = Square::None;
         if (flag == MoveFlag::DoublePawnPush) {
-            en_passant_sq = static_cast<Square>(static_cast<int>(from) + (us == 0 ? 8 : -8));
+            en_passant_sq = static_cast<Square>(static_cast<int>(from) + up);
         }
 
         // --- HASH UPDATE (ADD NEW STATE) ---
@@ -285,78 +330,179 @@ struct BoardState {
         key ^= Zobrist::castle_keys[castle_rights];
         key ^= Zobrist::side_key; // Flip side
 
-        to_move = (to_move == Colour::White) ? Colour::Black : Colour::White;
-        if (to_move == Colour::White) full_move_number++;
-
-        history.push_back(h);
+        to_move = static_cast<Colour>(them);
+        if constexpr (Us == Colour::Black) full_move_number++;
     }
 
-    void undo_move(Move move) {
-        if (history.empty()) return;
-        History h = history.back();
-        history.pop_back();
+    // Us is the side that made the move
+    template <Colour Us>
+    void undo_move_as(Move move, const Undo& h) {
+        constexpr int us = static_cast<int>(Us);
+        constexpr int them = us ^ 1;
+        constexpr int up = (Us == Colour::White) ? 8 : -8;
 
-        if (to_move == Colour::White) full_move_number--;
-        to_move = (to_move == Colour::White) ? Colour::Black : Colour::White;
+        if constexpr (Us == Colour::Black) full_move_number--;
+        to_move = Us;
         
         castle_rights = h.castle_rights;
         en_passant_sq = h.en_passant_sq;
         half_move_clock = h.half_move_clock;
         key = h.key; // Restore Hash directly!
+        pawn_key = h.pawn_key;
 
         Square from = move.from();
         Square to = move.to();
         MoveFlag flag = move.flag();
-        int us = static_cast<int>(to_move);
-        int them = us ^ 1;
-
-        // Move the piece back
-        int piece_idx = -1;
-        for (int i = us * 6; i < us * 6 + 6; ++i) {
-            if (BitUtil::get_bit(pieces[i], to)) {
-                piece_idx = i;
-                BitUtil::clear_bit(pieces[i], to);
-                break;
-            }
-        }
-        
-        if (flag >= MoveFlag::KnightPromotion) {
-            BitUtil::set_bit(pieces[us * 6], from);
-        } else {
-            BitUtil::set_bit(pieces[piece_idx], from);
-        }
-        
-        BitUtil::clear_bit(occupancy[us], to);
-        BitUtil::set_bit(occupancy[us], from);
 
-        if (h.captured_piece) {
-            int cap_idx = BitUtil::lsb(h.captured_piece);
-            BitUtil::set_bit(pieces[cap_idx], to);
+        // Move the piece back (a promoted piece goes back as a pawn)
+        int piece_idx = us * 6;
+        while (!BitUtil::get_bit(pieces[piece_idx], to)) ++piece_idx;
+        BitUtil::clear_bit(pieces[piece_idx], to);
+        BitUtil::set_bit(pieces[(flag >= MoveFlag::KnightPromotion) ? us * 6 : piece_idx], from);
+        occupancy[us] ^= BitUtil::from_square(from) | BitUtil::from_square(to);
+
+        if (h.captured_piece >= 0) {
+            BitUtil::set_bit(pieces[h.captured_piece], to);
             BitUtil::set_bit(occupancy[them], to);
         }
 
         if (flag == MoveFlag::EnPassant) {
-            Square cap_sq = static_cast<Square>(static_cast<int>(to) + (us == 0 ? -8 : 8));
+            Square cap_sq = static_cast<Square>(static_cast<int>(to) - up);
             BitUtil::set_bit(pieces[them * 6], cap_sq);
             BitUtil::set_bit(occupancy[them], cap_sq);
         }
 
-        if (flag == MoveFlag::KingCastle) {
-            Square r_from = (us == 0) ? Square::H1 : Square::H8;
-            Square r_to = (us == 0) ? Square::F1 : Square::F8;
-            BitUtil::clear_bit(pieces[us * 6 + 3], r_to);
-            BitUtil::clear_bit(occupancy[us], r_to);
-            BitUtil::set_bit(pieces[us * 6 + 3], r_from);
-            BitUtil::set_bit(occupancy[us], r_from);
-        } else if (flag == MoveFlag::QueenCastle) {
-            Square r_from = (us == 0) ? Square::A1 : Square::A8;
-            Square r_to = (us == 0) ? Square::D1 : Square::D8;
-            BitUtil::clear_bit(pieces[us * 6 + 3], r_to);
-            BitUtil::clear_bit(occupancy[us], r_to);
-            BitUtil::set_bit(pieces[us * 6 + 3], r_from);
-            BitUtil::set_bit(occupancy[us], r_from);
+        if (flag == MoveFlag::KingCastle || flag == MoveFlag::QueenCastle) {
+            constexpr Square rook_h = (Us == Colour::White) ? Square::H1 : Square::H8;
+            constexpr Square rook_f = (Us == Colour::White) ? Square::F1 : Square::F8;
+            constexpr Square rook_a = (Us == Colour::White) ? Square::A1 : Square::A8;
+            constexpr Square rook_d = (Us == Colour::White) ? Square::D1 : Square::D8;
+            Square r_from = (flag == MoveFlag::KingCastle) ? rook_h : rook_a;
+            Square r_to = (flag == MoveFlag::KingCastle) ? rook_f : rook_d;
+            Bitboard change = BitUtil::from_square(r_from) | BitUtil::from_square(r_to);
+            pieces[us * 6 + 3] ^= change;
+            occupancy[us] ^= change;
         }
 
         occupancy[2] = occupancy[0] | occupancy[1];
     }
 };
+
+static_assert(std::is_trivially_copyable_v<Position>);
+
+// Undo records of the moves that led to a position, oldest first. A fixed ring rather than a
+// growing array, so boards never allocate and copy as plain memory. Once more than CAPACITY
+// moves have been made the oldest records are overwritten: repetition checks look back at
+// most 100 plies plus the search depth, and undo_move can take back the last CAPACITY moves.
+struct UndoStack {
+    static constexpr uint32_t CAPACITY = 256;     // Power of two
+
+    // Moves made, including those whose records were overwritten
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    // Records still held: indices [size() - held(), size()) are valid. Counted apart from
+    // size(), since popping back past the overwritten records doesn't bring them back.
+    size_t held() const { return valid; }
+
+    Position::Undo& operator[](size_t i) { return entries[i & (CAPACITY - 1)]; }
+    const Position::Undo& operator[](size_t i) const { return entries[i & (CAPACITY - 1)]; }
+    const Position::Undo& back() const { return (*this)[count - 1]; }
+
+    Position::Undo& push() {
+        if (valid < CAPACITY) ++valid;
+        return entries[count++ & (CAPACITY - 1)];
+    }
+    void pop() { --count; --valid; }
+    void clear() { count = valid = 0; }
+
+private:
+    std::array<Position::Undo, CAPACITY> entries;
+    uint32_t count = 0;
+    uint32_t valid = 0;     // Records in entries that belong to the current line
+};
+
+// A position plus the moves that reached it, for code that needs repetition detection or
+// undo. Still trivially copyable; copy the Position alone when history isn't needed.
+struct BoardState : Position {
+    UndoStack history;
+    Nnue::AccumulatorStack* nnue = nullptr;    // Attached by searches with a native network
+
+    bool load_fen(std::string_view fen) {
+        history.clear();
+        return Position::load_fen(fen);
+    }
+
+    // ply = plies since the search root. A position that already occurred after the root
+    // is a draw at the first repetition: whichever side could avoid it would have done so
+    // on the way. Anything older needs a threefold, as in the rules.
+    bool is_draw(int ply = 0) const {
+        if (half_move_clock >= 100) return true;
+        if (insufficient_material()) return true;
+
+        // Only positions since the last irreversible move can repeat, and the same side is
+        // to move only every other ply. Nothing can repeat sooner than 4 plies back.
+        int rep_count = 0;
+        int limit = std::min((int)history.held(), (int)half_move_clock);
+        size_t n = history.size();
+
+        for (int back = 4; back <= limit; back += 2) {
+            if (history[n - back].key == key) {
+                if (back < ply) return true;
+                rep_count++;
+                if (rep_count >= 2) return true;  // Threefold: current + 2 previous
+            }
+        }
+        return false;
+    }
+
+    // Whether the side to move has a quiet move back into a position that occurred after
+    // the search root, ply plies ago. If so it can force a draw by repetition, so a node
+    // can't score below a draw for it. The hash difference to each earlier position with
+    // the same side to move is looked up in the cuckoo tables, which takes a few xors per
+    // candidate instead of generating moves.
+    bool upcoming_repetition(int ply) const {
+        int limit = std::min((int)history.held(), (int)half_move_clock);
+        if (limit < 3) return false;
+        size_t n = history.size();
+
+        // other = xor of the opponent's moves since then; it must cancel out, so the
+        // opponent has only shuffled back and forth and the difference is our move alone
+        uint64_t other = key ^ history[n - 1].key ^ Zobrist::side_key;
+        for (int back = 3; back <= limit && back < ply; back += 2) {
+            other ^= history[n - back + 1].key ^ history[n - back].key ^ Zobrist::side_key;
+            if (other != 0) continue;
+
+            int slot = Zobrist::cuckoo_find(key ^ history[n - back].key);
+            if (slot >= 0 && (Zobrist::cuckoo_paths[slot] & occupancy[2]) == 0) return true;
+        }
+        return false;
+    }
+
+    void make_move(Move move) {
+        if (!nnue) {
+            Position::make_move(move, history.push());
+            return;
+        }
+        Nnue::DirtyPieces dirty;
+        Position::make_move(move, history.push(), &dirty);
+        Nnue::push(*nnue, dirty);
+    }
+
+    // No-op when no record is held for the move: more than CAPACITY moves back, or
+    // nothing was made (see UndoStack)
+    void undo_move(Move move) {
+        if (history.held() == 0) return;
+        Position::undo_move(move, history.back());
+        history.pop();
+        if (nnue) Nnue::pop(*nnue);
+    }
+
+    // Copy-make counterpart of undo_move: back to saved, the Position before the move
+    void restore(const Position& saved) {
+        static_cast<Position&>(*this) = saved;
+        history.pop();
+        if (nnue) Nnue::pop(*nnue);
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<BoardState>);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "BoardState.hpp"
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Opening book in the Polyglot file layout: sorted 16-byte big-endian entries
+// (key, move, weight, learn). Keys come from Book::hash, which is Polyglot's own
+// hash, so books from other Polyglot tools load and this engine's books work elsewhere.
+namespace Book {
+
+    struct BookMove {
+        Move move;
+        uint16_t weight;
+    };
+
+    struct BuildOptions {
+        int max_ply = 24;       // Only the first max_ply plies of each game are recorded
+        int min_weight = 1;     // Moves scoring less than this over all games are dropped
+    };
+
+    // Position key used by book files; independent of the search's Zobrist keys so files
+    // built on one platform probe identically on another
+    uint64_t hash(const BoardState& board);
+
+    // Polyglot move encoding (castling as king-takes-rook) and its inverse against the
+    // legal moves of the position. decode_move returns Move() if nothing matches.
+    uint16_t encode_move(const Move& m);
+    Move decode_move(BoardState& board, uint16_t book_move);
+
+    // Streams the PGN files into a book at out_path. Each move scores 2 for a win,
+    // 1 for a draw or unknown result and 0 for a loss, from the mover's point of view.
+    // Returns the number of entries written, or -1 if a file can't be read or written.
+    int64_t build(const std::vector<std::string>& pgn_paths, const std::string& out_path,
+                  const BuildOptions& options = BuildOptions());
+
+    // Read-only view of a book file. Lookups don't modify the object, so one instance
+    // can be shared by every game thread.
+    class OpeningBook {
+    public:
+        bool open(const std::string& path);     // false if missing or malformed
+        void close() { file.close(); }
+        bool is_open() const { return file.is_open(); }
+        size_t size() const { return file.size() / ENTRY_SIZE; }
+
+        // Legal book moves for the position, highest weight first
+        std::vector<BookMove> lookup(BoardState& board) const;
+
+        // Weighted random choice driven by rng (advanced in place); Move() if out of book
+        Move pick(BoardState& board, uint64_t& rng) const;
+
+        static constexpr size_t ENTRY_SIZE = 16;
+
+    private:
+        MappedFile file;
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "BoardState.hpp"
+#include "Search.hpp"
+#include "Game.hpp"
+#include <cstdint>
+#include <string>
+
+// Self-play training data: games at a fixed node budget, written as packed 32-byte
+// records of (position, search score, game result). Plain C layouts for ctypes/numpy.
+namespace DataGen {
+
+    // One labelled position. Little-endian, no padding; mirrored by app/training_data.py.
+    struct PackedPosition {
+        uint64_t occupancy;         // Occupied squares (A1 = bit 0)
+        uint8_t pieces[16];         // Piece index 0-11 per occupied square in ascending order, low nibble first
+        int16_t score;              // Search score from the side to move's point of view
+        uint8_t result;             // 0 = black won, 1 = draw, 2 = white won, RESULT_UNKNOWN
+        uint8_t stm_castle;         // Bit 0: black to move; bits 4-7: castle rights
+        uint8_t en_passant;         // Square index, 64 = none
+        uint8_t half_move_clock;
+        uint16_t full_move_number;
+    };
+    static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+
+    static constexpr uint8_t RESULT_UNKNOWN = 255;     // Unlabelled positions (FenLoader)
+
+    PackedPosition pack(const BoardState& board, int32_t score, int result);
+    void unpack(const PackedPosition& packed, BoardState& board);
+
+    struct Options {
+        int64_t games;              // Games to play
+        uint64_t nodes;             // Node budget per move
+        int32_t depth;              // Depth cap per move (<= 0 = nodes only)
+        int32_t random_plies;       // Random legal moves opening each game
+        int32_t max_plies;          // Longer games are recorded as draws
+        int32_t hash_mb;            // Per-side TT per game
+        int32_t num_threads;        // 0 = all hardware threads
+        int32_t score_limit;        // Drop positions scored beyond +-score_limit (0 = keep, clamped to int16)
+        uint64_t seed;              // Game i plays its random opening from seed + i
+    };
+
+    // Invoked after each finished game. Calls are serialised, but come from worker threads.
+    using ProgressCallback = void(*)(int64_t games_done, int64_t positions_written);
+
+    // Plays options.games self-play games with eval (nullptr = the built-in eval) on both
+    // sides and appends the quiet positions (side to move not in check, best move neither
+    // a capture nor a promotion) from every searched ply to out_path.
+    // adjudication may be nullptr. Returns positions written, or -1 if out_path can't be opened.
+    int64_t generate(Search::EvalCallback eval, const Options& options, const std::string& out_path,
+                     const Game::Adjudication* adjudication, ProgressCallback on_progress);
+}
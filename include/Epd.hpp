@@ -0,0 +1,58 @@
+#pragma once
+
+#include "BoardState.hpp"
+#include "Search.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// EPD test suites: positions with "bm" (best move) / "am" (avoid move) operations,
+// searched in parallel to measure how quickly a bot finds the answers.
+namespace Epd {
+
+    struct EpdEntry {
+        std::string fen;                // Full FEN (hmvc/fmvn ops, or "0 1")
+        std::string id;                 // "id" operation, or the 1-based line number
+        std::vector<Move> best_moves;
+        std::vector<Move> avoid_moves;
+    };
+
+    // Parses every line with at least one bm/am move (SAN or UCI). Lines whose moves
+    // don't parse are skipped and counted in skipped (may be nullptr).
+    // Returns the number of entries, or -1 if the file can't be read.
+    int64_t load(const std::string& path, std::vector<EpdEntry>& out, int64_t* skipped = nullptr);
+
+    struct RunOptions {
+        int64_t time_ms = 1000;     // Per position (0 = untimed)
+        uint64_t nodes = 0;         // Per position (0 = unlimited)
+        int depth = 0;              // Cap (<= 0 = none; set time_ms or nodes then)
+        int hash_mb = 16;
+        int num_threads = 0;        // 0 = all hardware threads
+    };
+
+    struct PositionResult {
+        bool solved = false;
+        int64_t solve_time_ms = -1; // Iteration from which the answer never changed (-1 = unsolved)
+        uint64_t solve_nodes = 0;
+        int solve_depth = 0;
+        Move best_move;
+        int32_t score = 0;
+        int depth = 0;
+        uint64_t nodes = 0;
+        int64_t time_ms = 0;
+    };
+
+    // Invoked per finished position. Calls are serialised, but come from worker threads.
+    using ProgressCallback = void(*)(int index, int solved);
+
+    // Searches every entry with eval (nullptr = the built-in eval) and fills results
+    // (same order). Returns the solved count.
+    int run(const std::vector<EpdEntry>& entries, Search::EvalCallback eval, const RunOptions& options,
+            std::vector<PositionResult>& results, ProgressCallback on_progress = nullptr);
+
+    // One row / object per position. Returns false if the file can't be written.
+    bool write_csv(const std::string& path, const std::vector<EpdEntry>& entries,
+                   const std::vector<PositionResult>& results);
+    bool write_json(const std::string& path, const std::vector<EpdEntry>& entries,
+                    const std::vector<PositionResult>& results);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "BoardState.hpp"
+#include <cstdint>
+
+// Derived data handed to context evals (Search::ContextEvalCallback), built once per leaf
+// in C++ so bots don't each recompute it. Plain C layout of uint64 words; the indices are
+// mirrored by app/eval_context.py.
+struct EvalContext {
+    uint64_t attacks[2];            // Every square attacked by white / black
+    uint64_t attacks_by[12];        // Squares attacked by each piece bitboard (pieces order)
+    uint64_t checkers;              // Enemy pieces giving check to the side to move
+    uint64_t pinned[2];             // Each side's pieces pinned to its own king
+
+    // Pawn structure (served from the pawn hash)
+    uint64_t pawn_attacks[2];
+    uint64_t passed[2];             // No enemy pawn ahead on the same or an adjacent file
+    uint64_t isolated[2];           // No own pawn on an adjacent file
+    uint64_t doubled[2];            // Shares its file with another own pawn
+    uint64_t pawn_key;              // BoardState::pawn_key
+};
+static_assert(sizeof(EvalContext) == 26 * sizeof(uint64_t), "EvalContext layout is mirrored by app/eval_context.py");
+
+namespace Context {
+
+    // Fills ctx for the position. The pawn structure comes from a per-thread pawn hash
+    // keyed by pawn_key, so only positions with a new pawn layout pay for it.
+    void build(const uint64_t* pieces, const uint64_t* occupancy, uint32_t side,
+               uint64_t pawn_key, EvalContext& ctx);
+
+    inline void build(const BoardState& board, EvalContext& ctx) {
+        build(board.pieces.data(), board.occupancy.data(), board.to_move == Colour::White ? 0 : 1,
+              board.pawn_key, ctx);
+    }
+}
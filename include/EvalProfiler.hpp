@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Search.hpp"
+#include "DataGen.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Eval throughput over a position corpus: every bot is called once per position after a
+// warmup pass, each call timed on its own so slow outliers show up in the tail percentiles.
+namespace EvalProfiler {
+
+    // Plain C layout for ctypes
+    struct Profile {
+        int64_t calls;
+        double ns_mean;             // Per call, clock overhead subtracted
+        double ns_p50;
+        double ns_p90;
+        double ns_p99;
+        double ns_p999;
+        double ns_max;
+        double calls_per_sec;       // 1e9 / ns_mean
+        double score_mean;
+        double score_std;
+        int32_t score_min;
+        int32_t score_p1;
+        int32_t score_p50;
+        int32_t score_p99;
+        int32_t score_max;
+        int32_t reserved;
+    };
+
+    // Packed records (.bin from DataGen / convertPositionFile) or a FEN/EPD text file.
+    // Returns false if the file can't be read.
+    bool load_corpus(const std::string& path, std::vector<DataGen::PackedPosition>& out);
+
+    // Profiles each bot (nullptr = the built-in eval) over positions, bots running
+    // concurrently on up to num_threads threads (0 = one per bot, capped at the core count).
+    // warmup_calls are made before timing starts. profiles gets one entry per bot;
+    // correlation (if not nullptr) gets the num_bots x num_bots Pearson matrix of scores.
+    void run(const std::vector<Search::EvalCallback>& bots,
+             const std::vector<DataGen::PackedPosition>& positions,
+             int64_t warmup_calls, int num_threads,
+             std::vector<Profile>& profiles, std::vector<double>* correlation);
+
+    // Smallest margin covering |eval - built-in PeSTO| on a `coverage` fraction of positions
+    // (e.g. 0.99), for Search::set_lazy_margin. Returns -1 for a null eval or empty corpus.
+    int32_t calibrate_lazy_margin(Search::EvalCallback eval,
+                                  const std::vector<DataGen::PackedPosition>& positions, double coverage);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "BoardState.hpp"
+#include "DataGen.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Bulk FEN/EPD loading: the file is memory-mapped, split at line boundaries and parsed
+// in parallel straight into packed 32-byte positions (the DataGen record format).
+// Optional labels per line: EPD "ce <cp>" (side to move's point of view) and
+// c9 "1-0" / "0-1" / "1/2-1/2", or a trailing [1.0] / [0.5] / [0.0] for white's result.
+namespace FenLoader {
+
+    struct LineError {
+        int64_t line;               // 1-based
+        const char* reason;         // Static string
+    };
+
+    struct LoadResult {
+        std::vector<DataGen::PackedPosition> positions;     // In file order
+        std::vector<LineError> errors;                      // In file order
+        int64_t lines = 0;          // Lines seen, blank and '#' comment lines included
+    };
+
+    // Parses one line. scratch is reused between calls to avoid allocations.
+    // On failure returns false with reason set.
+    bool parse_line(std::string_view line, BoardState& scratch, DataGen::PackedPosition& out,
+                    const char*& reason);
+
+    // num_threads: 0 = all hardware threads. Returns false if the file can't be mapped.
+    bool load(const std::string& path, LoadResult& out, int num_threads = 0);
+}
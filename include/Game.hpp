@@ -0,0 +1,133 @@
+#pragma once
+
+#include "BoardState.hpp"
+#include "Search.hpp"
+#include "Book.hpp"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace Game {
+
+    // Result codes shared with the ctypes API
+    enum Result : int {
+        MaxMoves = -1,
+        Draw     = 0,
+        WhiteWin = 1,
+        BlackWin = 2
+    };
+
+    // Why the game ended
+    enum Termination : int {
+        None       = 0,
+        Checkmate  = 1,
+        Stalemate  = 2,
+        Repetition = 3,
+        FiftyMove  = 4,
+        MoveLimit  = 5,
+        NoMove     = 6,     // Search returned no move
+        TimeForfeit = 7,
+        AdjudicatedWin  = 8,    // Both engines agreed one side is winning
+        AdjudicatedDraw = 9,    // Both engines agreed the position is dead level
+        InsufficientMaterial = 10,
+        TablebaseAdjudicated = 11   // Result read from the endgame tablebases
+    };
+
+    // Ends decided games early. Scores are the engines' own search scores (centipawns).
+    // Plain int32 fields so the struct can be passed through ctypes; 0 disables a rule.
+    struct Adjudication {
+        int32_t resign_score = 0;       // |score| at or beyond this, same side ahead...
+        int32_t resign_moves = 0;       // ...for this many consecutive moves by each engine
+        int32_t draw_score = 0;         // |score| at or below this...
+        int32_t draw_moves = 0;         // ...for this many consecutive moves by each engine
+        int32_t draw_move_number = 0;   // ...counted only from this full move onwards
+        int32_t tablebase = 0;          // 1 = end the game once the tablebases know the result
+    };
+
+    // Base time + increment for one side. base_ms == 0 means untimed (fixed depth).
+    struct TimeControl {
+        int64_t base_ms = 0;
+        int64_t increment_ms = 0;
+    };
+
+    struct GameConfig {
+        Search::EvalCallback white_eval = nullptr;
+        Search::EvalCallback black_eval = nullptr;
+        int depth = 5;
+        int max_moves = 600;        // Plies before the game is abandoned
+        std::string fen = "startpos";
+        TimeControl time_control[2];    // [0]=White, [1]=Black; may differ for time odds
+        Adjudication adjudication;
+        int hash_mb = 16;               // Per-side persistent TT; 0 = fresh tables every move
+        const Book::OpeningBook* book = nullptr;    // Shared, read-only; nullptr = search from move one
+        int book_plies = 0;             // Stop using the book after this many plies (0 = no limit)
+        uint64_t seed = 0;              // Drives weighted book choices and random plies
+        uint64_t max_nodes = 0;         // Per-move node budget (0 = none); combines with depth/clock
+        int random_plies = 0;           // Uniformly random legal moves before book or search
+    };
+
+    struct GameResult {
+        int result = Draw;
+        int termination = None;
+        int plies = 0;
+        uint64_t nodes[2] = {0, 0};     // [0]=White, [1]=Black search nodes
+        int64_t time_used_ms[2] = {0, 0};
+        int64_t max_move_ms[2] = {0, 0};
+        int64_t clock_left_ms[2] = {0, 0};  // Remaining clock at game end (timed sides only)
+        std::vector<Move> moves;
+        std::vector<int32_t> move_times_ms; // Parallel to moves
+        std::vector<int32_t> scores;    // Parallel to moves: mover's search score (0 if not searched)
+        int random_plies = 0;           // Leading random moves
+        int book_plies = 0;             // Book moves that followed them
+    };
+
+    // Loads a FEN, or the standard starting position for "" / "startpos"
+    void setup_board(BoardState& board, const std::string& fen);
+
+    bool has_legal_move(BoardState& board);
+
+    // e.g. "e2e4", "e7e8q"
+    std::string move_to_uci(const Move& m);
+
+    // play() with the searches left to the caller, so many games' searches can be driven
+    // together (Batch). While next() returns true the side to move wants params searched
+    // from board, and the result goes to play(); next() plays book/random moves and returns
+    // false once the game is over.
+    class Runner {
+    public:
+        explicit Runner(const GameConfig& config);
+
+        bool next();
+        void play(Move best, const Search::SearchStats& stats);     // Time spent = since next()
+        const GameResult& result() const { return out; }
+
+        BoardState board;
+        Search::SearchParams params{};
+
+    private:
+        void finish(int result, int termination);
+
+        GameConfig config;
+        Search::SearchState states[2];      // Each engine keeps its own killers/history/TT for the game
+        GameResult out;
+        int64_t clock_ms[2] = {0, 0};
+        int move_num = 0;
+        int side = 0;
+        bool finished = false;
+        std::chrono::steady_clock::time_point search_start;
+        int64_t trace_game_start = -1;      // Trace::now_ns() values; -1 = not traced
+        int64_t trace_move_start = -1;
+
+        // Consecutive plies satisfying each adjudication rule (both engines alternate)
+        int resign_streak = 0;
+        int resign_sign = 0;
+        int draw_streak = 0;
+
+        uint64_t rng = 0;
+        bool in_book = false;
+    };
+
+    // Plays one headless game to completion on the calling thread.
+    // Each side's search calls its own eval directly, so games can run concurrently.
+    GameResult play(const GameConfig& config);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Search.hpp"
+#include "Game.hpp"
+#include "Batch.hpp"
+#include <cstdint>
+
+// Plain C layouts so Python can build the arrays with ctypes
+namespace Match {
+
+    struct MatchJob {
+        Search::EvalCallback white;
+        Search::EvalCallback black;
+        const char* fen;                // nullptr / "startpos" for the initial position
+        int64_t white_base_ms;          // 0 = untimed, search to the fixed depth
+        int64_t white_increment_ms;
+        int64_t black_base_ms;          // Set differently from white for time odds
+        int64_t black_increment_ms;
+    };
+
+    struct MatchResult {
+        int32_t result;                 // Game::Result
+        int32_t termination;            // Game::Termination
+        int32_t plies;
+        int32_t uci_moves_length;       // Bytes written (excluding the terminator)
+        uint64_t white_nodes;
+        uint64_t black_nodes;
+        char* uci_moves;                // Caller-owned buffer, may be nullptr
+        int32_t uci_moves_capacity;     // Including the terminator; moves that don't fit are dropped
+        int32_t move_times_length;      // Entries written to move_times_ms
+        int32_t* move_times_ms;         // Caller-owned, per-ply think time; may be nullptr
+        int32_t move_times_capacity;
+        int32_t book_plies;             // Leading moves taken from the opening book
+        int64_t white_time_ms;          // Total think time per side
+        int64_t black_time_ms;
+        int64_t white_max_move_ms;      // Longest single move per side
+        int64_t black_max_move_ms;
+        int64_t white_clock_left_ms;    // Remaining clock at the end (timed sides only)
+        int64_t black_clock_left_ms;
+    };
+
+    // Plays every job and fills results[i] for jobs[i]. depth caps timed searches too
+    // (<= 0 leaves them clock-limited only). num_threads: 1 = sequential, 0 = all cores.
+    // With a book, job i draws its book line from seed i.
+    int run(const MatchJob* jobs, MatchResult* results, int num_jobs,
+            int depth, int max_moves, int num_threads,
+            const Game::Adjudication& adjudication = Game::Adjudication(),
+            const Book::OpeningBook* book = nullptr, int book_plies = 0);
+
+    // run() with every game on the calling thread and evals batched across games (Batch).
+    // Clocks in the jobs are ignored; at most max_active games (<= 0 = all) are in flight.
+    // stats may be nullptr.
+    int run_batched(const MatchJob* jobs, MatchResult* results, int num_jobs,
+                    int depth, int max_moves, int max_active,
+                    const Game::Adjudication& adjudication = Game::Adjudication(),
+                    const Book::OpeningBook* book = nullptr, int book_plies = 0,
+                    Batch::Stats* stats = nullptr);
+}
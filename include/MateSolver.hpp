@@ -0,0 +1,41 @@
+#pragma once
+
+#include "BoardState.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Forced-mate solver: depth-limited df-pn (depth-first proof-number search) with its own
+// transposition table. Only mate / no mate matters, so no eval is involved and the search
+// goes deep along forcing lines instead of full width.
+// Like composed problems, repetitions and the fifty-move rule are ignored.
+namespace MateSolver {
+
+    enum Status : int {
+        Unknown = 0,    // Node budget or stop flag hit before an answer
+        Mate    = 1,
+        NoMate  = 2     // Proven: no mate in max_moves or fewer
+    };
+
+    struct Options {
+        int max_moves = 5;              // Attacker moves (mate in N); capped at MAX_MOVES
+        uint64_t node_budget = 0;       // Node limit over all iterations (0 = unlimited)
+        size_t hash_mb = 16;
+        const std::atomic<bool>* stop = nullptr;    // Raised by another thread to abort
+    };
+
+    static constexpr int MAX_MOVES = 60;
+
+    struct Result {
+        Status status = Unknown;
+        int mate_in = 0;                // Attacker moves of the shortest mate (Mate only)
+        std::vector<Move> pv;           // Mating line; defender replies resist longest
+        uint64_t nodes = 0;
+        int64_t time_ms = 0;
+    };
+
+    // Looks for a mate by the side to move. Tries mate in 1, 2, ... max_moves in turn, so
+    // a Mate result is the shortest one. board is restored before returning.
+    Result solve(BoardState& board, const Options& options);
+}
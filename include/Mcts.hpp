@@ -0,0 +1,72 @@
+#pragma once
+
+#include "BoardState.hpp"
+#include "Search.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Best-first search backend: PUCT Monte Carlo tree search with the eval callback as the
+// value function. Any number of threads walk one shared tree; virtual loss steers them
+// apart, and leaves are scored in batches when the eval has a batch version
+// (Search::register_batch_eval). The tree is kept in the SearchState and re-rooted at
+// the position reached two plies later, so the next move starts from the old subtree.
+namespace Mcts {
+
+    enum NodeState : uint8_t {
+        Unexpanded = 0,
+        Expanding  = 1,     // One thread is generating the children
+        Expanded   = 2,
+        Terminal   = 3      // Mate, stalemate or a draw by rule
+    };
+
+    struct Node {
+        std::atomic<int32_t> visits{0};
+        std::atomic<int32_t> virtual_loss{0};   // Playouts currently passing through
+        std::atomic<float> value_sum{0.0f};     // For the side that moved into this node
+        std::atomic<uint8_t> state{Unexpanded};
+        float prior = 0.0f;
+        float terminal_value = 0.0f;            // For the side to move (Terminal only)
+        uint16_t move = 0;
+        uint16_t num_children = 0;
+        uint32_t first_child = 0;               // Children are contiguous
+        uint64_t key = 0;
+    };
+
+    // Node arena. Memory is claimed chunk by chunk as the tree grows and never moves, so
+    // workers can read nodes while others allocate.
+    class Tree {
+    public:
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        explicit Tree(uint64_t max_nodes);
+        ~Tree();
+
+        Node& node(uint32_t index) { return chunks[index >> CHUNK_BITS][index & CHUNK_MASK]; }
+
+        // count contiguous nodes, or NONE once max_nodes is reached
+        uint32_t allocate(uint32_t count);
+        uint64_t size() const { return used.load(std::memory_order_relaxed); }
+        bool full() const { return out_of_space.load(std::memory_order_relaxed); }
+
+        uint32_t root = NONE;
+
+    private:
+        static constexpr uint32_t CHUNK_BITS = 16;
+        static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+        static constexpr uint32_t CHUNK_MASK = CHUNK_SIZE - 1;
+
+        std::unique_ptr<std::unique_ptr<Node[]>[]> chunks;
+        uint32_t max_chunks = 0;
+        std::atomic<uint64_t> used{0};
+        std::atomic<bool> out_of_space{false};
+        std::mutex alloc_mutex;
+    };
+
+    // Plays out params.mcts.playouts (or until params.max_nodes playouts, the soft time
+    // limit or the stop flag) and returns the most visited root move. stats.nodes counts
+    // playouts, depth_reached is the average playout depth and score converts the best
+    // move's value back to centipawns.
+    Move search(BoardState& board, const Search::SearchParams& params, Search::SearchStats& stats);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Where the big tables live: huge pages for the TT and the magic attack tables (one TLB
+// entry per 2 MB instead of per 4 KB), NUMA placement by first touch, per-node copies of
+// read-only data, and optional thread pinning. Each falls back to plain behaviour where
+// the OS doesn't offer it (no huge pages reserved or allowed, one node, not Linux).
+namespace Memory {
+
+    struct Options {
+        bool large_pages = true;    // Explicit huge pages if reserved, else transparent ones
+        bool pin_threads = false;   // Pin pool workers and UCI search threads to one CPU each
+        bool replicate = false;     // One copy of read-only tables (NNUE weights) per node
+    };
+
+    // Affects allocations made and threads started after the call, so call it before
+    // building tables or starting searches
+    void configure(const Options& options);
+    const Options& options();
+
+    enum class Pages : int {
+        Small       = 0,    // The default page size
+        Transparent = 1,    // Huge-page aligned and advised; the kernel may still use small ones
+        Explicit    = 2     // Reserved huge pages (MAP_HUGETLB / MEM_LARGE_PAGES)
+    };
+
+    struct Block {
+        void* ptr = nullptr;
+        size_t bytes = 0;           // Mapped size, a whole number of pages
+        Pages pages = Pages::Small;
+    };
+
+    // Zeroed memory for at least bytes bytes, or an empty Block if even the fallback
+    // fails. Pages are mapped on first use rather than here, so each lands on the node of
+    // the thread that first writes it.
+    Block allocate(size_t bytes);
+    void release(Block& block);
+
+    // Owning array in a Block, for types whose all-zero bytes are a valid value (empty TT
+    // entries, empty bitboards). reset() hands back fresh zero pages instead of filling the
+    // old ones, which also places them anew by first touch.
+    template <typename T>
+    class LargeArray {
+        static_assert(std::is_trivially_copyable_v<T>, "LargeArray memory is zeroed, not constructed");
+
+    public:
+        LargeArray() = default;
+        explicit LargeArray(size_t count) { reset(count); }
+        ~LargeArray() { release(block); }
+
+        LargeArray(const LargeArray&) = delete;
+        LargeArray& operator=(const LargeArray&) = delete;
+        LargeArray(LargeArray&& other) noexcept
+            : block(std::exchange(other.block, Block())), count(std::exchange(other.count, 0)) {}
+        LargeArray& operator=(LargeArray&& other) noexcept {
+            if (this != &other) {
+                release(block);
+                block = std::exchange(other.block, Block());
+                count = std::exchange(other.count, 0);
+            }
+            return *this;
+        }
+
+        // Drops the old memory first, so a resize never holds both
+        void reset(size_t new_count) {
+            release(block);
+            count = 0;
+            if (new_count == 0) return;
+            block = allocate(new_count * sizeof(T));
+            if (block.ptr) count = new_count;
+        }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        T* data() { return static_cast<T*>(block.ptr); }
+        const T* data() const { return static_cast<const T*>(block.ptr); }
+        T& operator[](size_t i) { return data()[i]; }
+        const T& operator[](size_t i) const { return data()[i]; }
+        T* begin() { return data(); }
+        T* end() { return data() + count; }
+
+        const Block& memory() const { return block; }
+
+    private:
+        Block block;
+        size_t count = 0;
+    };
+
+    // --- PLACEMENT ---
+    static constexpr int MAX_NODES = 8;     // Nodes past this share the last one's copies
+
+    int num_nodes();                // NUMA nodes (1 without NUMA support)
+    int current_node();             // Node of the CPU the calling thread is running on
+
+    // "16 MB on 2 MB pages (explicit), node 0 100%" for a block. Only pages that have
+    // been touched have a node; the rest show as untouched.
+    std::string describe(const Block& block);
+
+    // Huge page support, node count and what configure() turned on, on one line
+    std::string status();
+
+    // --- THREADS ---
+    // If pin_threads is on, pins the calling thread to the index-th CPU the process may
+    // use, taking CPUs from each node in turn so consecutive workers spread over nodes.
+    // Returns whether the thread was pinned.
+    bool pin_thread(int index);
+}
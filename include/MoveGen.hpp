@@ -2,8 +2,22 @@
 #include "BoardState.hpp"
 #include <vector>
 
+// Pseudo-legal move generation; callers reject moves that leave their king in check.
+// Each kind is compiled once per side to move, so the side is checked once per call.
 namespace MoveGen {
-    void generate_moves(const BoardState& board, std::vector<Move>& move_list);
+    enum GenType : int {
+        All      = 0,
+        Captures = 1,   // Captures, en passant and promotions
+        Quiets   = 2,   // Everything else, castling included
+        Evasions = 3    // In check: king moves, and captures/blocks of a single checker
+    };
+
+    void generate_moves(const Position& board, std::vector<Move>& move_list);
     
-    void generate_captures(const BoardState& board, std::vector<Move>& move_list);
+    void generate_captures(const Position& board, std::vector<Move>& move_list);
+
+    void generate_quiets(const Position& board, std::vector<Move>& move_list);
+
+    // Only for a side to move that is in check; a superset of its legal moves
+    void generate_evasions(const Position& board, std::vector<Move>& move_list);
 }
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct BoardState;
+
+// Native (768 -> H)x2 -> 1 network with a clipped-ReLU hidden layer. Features are
+// (piece, square) pairs seen from each side: own pieces first, squares flipped vertically
+// for black. The first layer lives in int16 accumulators that make_move/undo_move keep
+// up to date while a search has a stack attached, so a leaf only runs the output layer.
+//
+// Weight file (little-endian), written by app/nnue.py:
+//   char[4] magic "CENN"   uint32 version (1)   uint32 hidden (multiple of 16, <= 1024)
+//   int32 scale (output centipawns per unit)   int32 qa   int32 qb
+//   int16 feature_weights[768][hidden]   int16 feature_bias[hidden]
+//   int16 output_weights[2 * hidden]      (side to move's half first)
+//   int32 output_bias
+// eval = (sum(clamp(acc, 0, qa) * output_weights) + output_bias) * scale / (qa * qb)
+namespace Nnue {
+
+    static constexpr int INPUTS = 768;
+    static constexpr int MAX_HIDDEN = 1024;
+    static constexpr int STACK_SIZE = 256;          // Deeper than any search line
+
+    struct Network {
+        int hidden = 0;
+        int32_t scale = 0;
+        int32_t qa = 0;
+        int32_t qb = 0;
+        std::vector<int16_t> feature_weights;       // [INPUTS][hidden]
+        std::vector<int16_t> feature_bias;          // [hidden]
+        std::vector<int16_t> output_weights;        // [2 * hidden]
+        int32_t output_bias = 0;
+    };
+
+    // Reads a weight file. Returns false (network untouched) on a missing or malformed file.
+    bool load(const std::string& path, Network& net);
+
+    inline int feature_index(int perspective, int piece, int sq) {
+        int colour = piece / 6;
+        if (perspective == 1) {
+            colour ^= 1;
+            sq ^= 56;
+        }
+        return (colour * 6 + piece % 6) * 64 + sq;
+    }
+
+    // (piece, square) changes made by one move
+    struct DirtyPieces {
+        int num_removed = 0;
+        int num_added = 0;
+        int removed[2][2];          // {piece, square}
+        int added[2][2];
+
+        void remove(int piece, int sq) { removed[num_removed][0] = piece; removed[num_removed++][1] = sq; }
+        void add(int piece, int sq) { added[num_added][0] = piece; added[num_added++][1] = sq; }
+    };
+
+    // One accumulator pair per ply. Moves only record their DirtyPieces; accumulators are
+    // brought up to date from the nearest computed ply when a position is evaluated, so
+    // interior nodes that never reach an eval cost nothing.
+    struct AccumulatorStack {
+        const Network* net = nullptr;
+        int top = 0;
+        std::vector<int16_t> values;                // [STACK_SIZE][2][hidden]
+        DirtyPieces dirty[STACK_SIZE];
+        bool computed[STACK_SIZE] = {};
+
+        // Binds to net and computes ply 0 from scratch for board
+        void reset(const Network& network, const BoardState& board);
+
+        int16_t* accumulator(int ply, int perspective) {
+            return values.data() + (static_cast<size_t>(ply) * 2 + perspective) * net->hidden;
+        }
+    };
+
+    // make_move / undo_move hooks
+    void push(AccumulatorStack& stack, const DirtyPieces& dirty);
+    void pop(AccumulatorStack& stack);
+
+    // Score of the stack's current position for side (0 = white), from side's point of view
+    int32_t evaluate(AccumulatorStack& stack, int side);
+
+    // Same score computed from scratch (no stack)
+    int32_t evaluate(const Network& net, const uint64_t* pieces, int side);
+
+    // Networks loaded through register_network are reachable through a plain EvalCallback
+    // handle: searches recognise it and switch to the incremental stack; called directly it
+    // evaluates from scratch. Returns nullptr if all slots are taken.
+    using EvalHandle = int32_t(*)(const uint64_t*, const uint64_t*, uint32_t);
+    static constexpr int MAX_NETWORKS = 8;
+    EvalHandle register_network(Network&& net);
+
+    // The network behind a handle, or nullptr for any other eval. With Memory replication
+    // on, this is the copy for the calling thread's NUMA node.
+    const Network* network_for(EvalHandle fn);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "BoardState.hpp"
+#include <string_view>
+#include <vector>
+
+// Move text <-> Move conversion. Parsers return Move() (raw 0) for illegal or malformed input.
+namespace Notation {
+
+    void legal_moves(BoardState& board, std::vector<Move>& out);
+
+    // "e2e4", "e7e8q"
+    Move parse_uci(BoardState& board, std::string_view uci);
+
+    // "Nf3", "exd5", "O-O", "e8=Q+", "Rad1" — check/annotation suffixes are ignored
+    Move parse_san(BoardState& board, std::string_view san);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Hardware performance counters for the calling thread, read with Linux perf_event_open
+// (user-space only, so perf_event_paranoid <= 2 is enough). A counter the kernel refuses
+// (paranoid setting, containers, VMs without a PMU, other OSes) reads as -1 and the
+// rest keep working.
+namespace PerfCounters {
+
+    enum Event : int {
+        Cycles       = 0,
+        Instructions = 1,
+        L1DMisses    = 2,   // L1 data cache read misses
+        LLCMisses    = 3,   // Last-level cache misses
+        BranchMisses = 4,
+        NUM_EVENTS   = 5
+    };
+
+    const char* event_name(int event);
+
+    // Plain C layout for ctypes; -1 = counter unavailable
+    struct Values {
+        int64_t counts[NUM_EVENTS] = {-1, -1, -1, -1, -1};
+    };
+
+    // end - start per counter (-1 where either side is unavailable)
+    Values difference(const Values& end, const Values& start);
+    // total += delta, where delta has a value
+    void accumulate(Values& total, const Values& delta);
+
+    // The counters of the thread that constructs it. Opening costs a few syscalls, so keep
+    // one per thread rather than one per measurement; read() is one syscall.
+    class Group {
+    public:
+        Group();
+        ~Group();
+
+        Group(const Group&) = delete;
+        Group& operator=(const Group&) = delete;
+
+        int available() const { return num_open; }      // Counters that opened
+        const std::string& status() const { return why; }   // Why some didn't ("" = all open)
+
+        // Counts since construction, scaled up if the kernel had to multiplex them
+        Values read() const;
+
+    private:
+        int fds[NUM_EVENTS];
+        int slots[NUM_EVENTS];      // Position of each event in the group read, -1 = not open
+        int leader = -1;
+        int num_open = 0;
+        std::string why;
+    };
+
+    // "ipc 2.31 cycles/node 812 ..." (per count units of unit) for whichever counters are
+    // available, or "counters unavailable (<status>)" if none are
+    std::string summary(const Values& values, uint64_t count, const std::string& status,
+                        const char* unit = "node");
+}
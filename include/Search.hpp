@@ -1,24 +1,164 @@
 #pragma once
 
 #include "BoardState.hpp"
+#include "EvalContext.hpp"
+#include "Memory.hpp"
+#include "PerfCounters.hpp"
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Mcts { class Tree; }
 
 namespace Search {
 
     using EvalCallback = int32_t(*)(const uint64_t*, const uint64_t*, uint32_t);
+    // v2 evals additionally get the EvalContext for the position (read-only, valid for the call)
+    using ContextEvalCallback = int32_t(*)(const uint64_t*, const uint64_t*, uint32_t, const EvalContext*);
+
+    // Registers a context eval and returns the handle to pass wherever an EvalCallback is
+    // taken (SearchParams, games, tournaments, the C API); searches recognise the handle and
+    // call fn with a context. Registering the same fn again returns the same handle.
+    EvalCallback register_context_eval(ContextEvalCallback fn);
+
+    // The context eval behind a handle, or nullptr for a plain EvalCallback
+    ContextEvalCallback context_eval_for(EvalCallback fn);
+
+    // Scores count positions in one call: pieces[i * 12 ...], occupancy[i * 3 ...] and sides[i]
+    // describe position i, whose score (EvalCallback convention) goes to scores[i]
+    using BatchEvalCallback = void(*)(const uint64_t* pieces, const uint64_t* occupancy,
+                                      const uint32_t* sides, int32_t* scores, uint32_t count);
+
+    // Pairs fn with a batched version. Coroutine searches (SearchCoroutine.hpp) queue fn's
+    // evals for batch instead of calling fn; every other search keeps calling fn.
+    // A null batch removes the pairing.
+    void register_batch_eval(EvalCallback fn, BatchEvalCallback batch);
+    BatchEvalCallback batch_eval_for(EvalCallback fn);
+
+    // Lazy eval gate: with a margin set for fn, quiescence first takes the built-in PeSTO
+    // score and only calls fn if that score +/- margin can still reach the window. The margin
+    // should bound |fn - PeSTO| (see EvalProfiler::calibrate_lazy_margin); 0 turns it off.
+    void set_lazy_margin(EvalCallback fn, int32_t margin);
+    int32_t lazy_margin_for(EvalCallback fn);
+
+    // Eval callbacks made / avoided by the gate, summed over every finished search
+    void lazy_eval_totals(uint64_t& calls, uint64_t& skipped, bool reset);
+
+    // --- SEARCH BACKENDS ---
+    enum class Backend : int32_t { AlphaBeta = 0, Mcts = 1 };
+
+    // Best-first PUCT search (Mcts.hpp). Plain C layout so Python can fill it with ctypes.
+    struct MctsOptions {
+        int32_t threads = 1;            // Workers sharing one tree (0 = all hardware threads)
+        int32_t batch_size = 16;        // Leaves per call when the eval has a batch version
+        float cpuct = 1.5f;             // Exploration weight
+        int32_t value_scale = 400;      // Centipawns -> value: 2 / (1 + 10^(-cp / scale)) - 1
+        uint64_t playouts = 20000;      // Per move when neither a node nor a time limit is set
+        uint64_t max_tree_nodes = 1ULL << 22;   // Search stops growing the tree here
+    };
+
+    // Per-bot backend: searches whose eval is fn run MCTS with options even if their
+    // SearchParams ask for alpha-beta. nullptr options go back to alpha-beta.
+    void set_mcts_backend(EvalCallback fn, const MctsOptions* options);
+    bool mcts_options_for(EvalCallback fn, MctsOptions& out);
+
+    struct SearchStats;
+    // Called after every completed iteration (stats reflect that depth), on the search thread
+    using InfoCallback = void(*)(const SearchStats& stats, void* user);
+
+    static constexpr int MAX_PLY = 128;
+
+    // --- TRANSPOSITION TABLE ---
+    enum class Bound : uint8_t { None, Exact, Lower, Upper };
+
+    struct TTEntry {
+        uint64_t key = 0;
+        int32_t score = 0;
+        uint16_t move = 0;
+        int8_t depth = 0;
+        uint8_t bound_gen = 0;      // Low 2 bits: Bound, high 6 bits: generation
+    };
+
+    // Search memory for one engine over one game: killers, history and the TT.
+    // Kept alive between moves; aged when the game continues from the last search,
+    // wiped on a new game or a jump to an unrelated position.
+    // Not shared between engines (TT scores come from that engine's own eval).
+    struct SearchState {
+        explicit SearchState(size_t hash_mb = 16);
+        ~SearchState();
+        SearchState(SearchState&&) noexcept;
+        SearchState& operator=(SearchState&&) noexcept;
+
+        void resize(size_t hash_mb);    // Also clears
+        // Also swaps the TT for fresh pages, which the next search thread to touch them
+        // places on its own NUMA node
+        void clear();
+
+        // Called at the start of each search; decides between ageing and wiping
+        void prepare(const BoardState& board);
+
+        TTEntry* probe(uint64_t key);
+        void store(uint64_t key, int depth, int32_t score, Bound bound, uint16_t move, int ply);
+
+        Move killers[MAX_PLY][2];
+        int history[2][64][64];
+        Memory::LargeArray<TTEntry> tt; // Power-of-two sized; empty disables the TT
+        uint8_t generation = 0;
+
+        uint64_t last_root_key = 0;     // Position the previous search started from
+        uint64_t expected_key = 0;      // Position after our move + the predicted reply
+        bool ponder_hit = false;        // Current search started from expected_key
+
+        std::unique_ptr<Mcts::Tree> tree;   // MCTS tree, re-rooted between moves
+    };
 
     struct SearchParams {
-        int depth;
+        int depth;                  // Maximum depth (<= 0 means no depth cap; use with a time limit)
         EvalCallback evalFunc;
+        int64_t soft_time_ms = 0;   // Don't start a new iteration after this (0 = untimed)
+        int64_t hard_time_ms = 0;   // Abort mid-iteration after this (0 = untimed)
+        SearchState* state = nullptr;   // Persistent per-game state (nullptr = fresh tables, no TT)
+        uint64_t max_nodes = 0;     // Abort once this many nodes are visited (0 = unlimited)
+        const std::atomic<bool>* stop = nullptr;    // Raised by another thread to abort the search
+        InfoCallback on_iteration = nullptr;
+        void* info_user = nullptr;
+        Backend backend = Backend::AlphaBeta;   // Mcts ignores depth; see MctsOptions::playouts
+        MctsOptions mcts{};
+        bool profile = false;       // Read hardware counters into SearchStats::counters
+        bool copy_make = false;     // Restore a saved Position instead of undo_move (alpha-beta only)
     };
 
     struct SearchStats {
         int depth_reached = 0;
         int32_t score = 0;
         int best_move_raw = 0;
+        uint64_t nodes = 0;         // alpha_beta + quiescence nodes visited
+        int64_t time_ms = 0;
+        int ponder_move_raw = 0;    // Predicted reply to best_move (0 if unknown)
+        bool ponder_hit = false;    // Opponent played the predicted reply
+        uint64_t tt_hits = 0;       // TT probes that produced a cutoff
+        uint64_t tb_hits = 0;       // Successful tablebase probes (root included)
+        uint64_t eval_calls = 0;    // Eval callbacks made
+        uint64_t lazy_skips = 0;    // Eval callbacks the lazy gate avoided
+        // SearchParams::profile only: the search thread's counters since the search began
+        // (alpha-beta updates them every iteration, MCTS once at the end; helper threads
+        // aren't counted). -1 where unavailable, see counters_status().
+        PerfCounters::Values counters{};
     };
 
-    Square find_king(const BoardState& board, Colour side);
+    Square find_king(const Position& board, Colour side);
+
+    // Why profiled searches on this thread are missing counters ("" = none missing)
+    const std::string& counters_status();
+
+    // Splits a clock into soft/hard limits for one move.
+    // moves_to_go <= 0 assumes a sudden-death horizon.
+    void allocate_time(int64_t remaining_ms, int64_t increment_ms, int moves_to_go, SearchParams& params);
 
+    // Searches with the backend params (or set_mcts_backend for params.evalFunc) selects.
+    // Coroutine searches (SearchCoroutine.hpp) always use alpha-beta.
     Move iterative_deepening(BoardState& board, const SearchParams& params, SearchStats& stats);
 }
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Search.hpp"
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Search {
+
+    // Coroutine frames come and go once per node, so freed ones are recycled by size on the
+    // thread that made them rather than going back to the heap
+    void* allocate_frame(size_t size);
+    void release_frame(void* p, size_t size);
+
+    // Lazily started coroutine producing a T. Awaiting a Task runs it and resumes the awaiter
+    // once it returns; the hand-over is a symmetric transfer, so deep trees don't grow the stack.
+    template <typename T>
+    class Task {
+    public:
+        struct promise_type {
+            T value{};
+            std::coroutine_handle<> continuation;
+
+            static void* operator new(size_t size) { return allocate_frame(size); }
+            static void operator delete(void* p, size_t size) { release_frame(p, size); }
+
+            Task get_return_object() {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            auto final_suspend() noexcept {
+                struct ResumeAwaiter {
+                    bool await_ready() noexcept { return false; }
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                        std::coroutine_handle<> next = h.promise().continuation;
+                        return next ? next : std::noop_coroutine();
+                    }
+                    void await_resume() noexcept {}
+                };
+                return ResumeAwaiter{};
+            }
+            void return_value(T v) { value = std::move(v); }
+            void unhandled_exception() { std::terminate(); }    // The search never throws
+        };
+
+        Task() = default;
+        explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+        Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task() { if (handle) handle.destroy(); }
+
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+            handle.promise().continuation = caller;
+            return handle;
+        }
+        T await_resume() { return std::move(handle.promise().value); }
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    // A position a coroutine search is waiting on. Whoever drives the search scores it with
+    // batch and writes score before resuming.
+    struct PendingEval {
+        const BoardState* board = nullptr;
+        BatchEvalCallback batch = nullptr;
+        int32_t score = 0;
+    };
+
+    // iterative_deepening as a coroutine, for running many searches on one thread. resume()
+    // runs until the search needs an eval from a registered batch eval (appended to queue) or
+    // until it finishes. Each search swaps its own copy of the thread's search state in while
+    // it runs, so any number can be interleaved; moves, scores and stats match
+    // iterative_deepening's for the same position and params.
+    // board must stay untouched while the search is suspended.
+    class SearchCoroutine {
+    public:
+        SearchCoroutine(BoardState& board, const SearchParams& params, std::vector<PendingEval*>& queue);
+        ~SearchCoroutine();
+
+        SearchCoroutine(const SearchCoroutine&) = delete;
+        SearchCoroutine& operator=(const SearchCoroutine&) = delete;
+
+        // True once the search has finished. Queued evals must be scored before calling again.
+        bool resume();
+
+        bool done() const { return task.handle.done(); }
+        Move best_move() const { return task.handle.promise().value; }
+        const SearchStats& stats() const { return search_stats; }
+
+        struct Vars;
+
+    private:
+        SearchParams params;
+        SearchStats search_stats;
+        std::unique_ptr<SearchState> scratch;   // Killers/history when params.state is null
+        std::unique_ptr<Vars> vars;
+        bool started = false;
+        Task<Move> task;
+    };
+}
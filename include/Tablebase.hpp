@@ -0,0 +1,56 @@
+#pragma once
+
+#include "BoardState.hpp"
+#include <string>
+
+// Syzygy endgame tablebase probing (.rtbw WDL / .rtbz DTZ files on local disk).
+// Files are found at init time and memory-mapped on first access; probing is
+// thread-safe once init() has returned.
+namespace Tablebase {
+
+    // Win/draw/loss from the side to move. Cursed wins and blessed losses are
+    // wins/losses that the fifty-move rule turns into draws.
+    enum WDL : int {
+        Loss        = -2,
+        BlessedLoss = -1,
+        Draw        = 0,
+        CursedWin   = 1,
+        Win         = 2
+    };
+
+    enum ProbeState : int {
+        Fail            = 0,    // Table missing or corrupt
+        Ok              = 1,
+        ChangeSTM       = -1,   // DTZ table stores the other side to move
+        ZeroingBestMove = 2     // Best move is a capture or pawn move
+    };
+
+    // Scans the directories in paths (':'-separated, ';' on Windows) for WDL files.
+    // Replaces any previously loaded set. Returns the largest piece count available
+    // (0 = no tables).
+    int init(const std::string& paths);
+
+    int max_pieces();
+
+    // Search limits: probe only nodes with at least probe_depth plies left and at most
+    // probe_limit pieces on the board. Set before searches start.
+    void set_probe_limits(int probe_depth, int probe_limit);
+    int probe_depth();
+    int probe_limit();      // Already capped by max_pieces()
+
+    // Positions must have no castling rights
+    WDL probe_wdl(BoardState& board, ProbeState& state);
+
+    // Plies to the next capture or pawn move (positive when winning), 0 for draws
+    int probe_dtz(BoardState& board, ProbeState& state);
+
+    // Whether tests/syzygy_check.py has passed against real tables. Until it has, the
+    // search, the root and game adjudication don't act on probes: a wrong WDL would cut
+    // off or score every probed node. probe_wdl/probe_dtz still answer direct queries.
+    inline constexpr bool PROBES_VERIFIED = false;
+
+    // Picks the root move that wins fastest (or loses slowest) by DTZ without letting a
+    // win slip into a fifty-move draw. wdl is the outcome after that move, from the
+    // root side's point of view. Returns false if any probe fails.
+    bool root_probe(BoardState& board, Move& best, WDL& wdl, int& dtz);
+}
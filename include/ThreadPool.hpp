@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool: each worker owns a deque, pops its own work from the back
+// and steals from the front of the others when it runs dry.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(Task task);
+
+    // Blocks until every submitted task has finished
+    void wait_idle();
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    // 0 or negative means "use every hardware thread"
+    static int resolve_thread_count(int requested);
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool try_pop(int idx, Task& out);
+    void worker_loop(int idx);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex state_mutex;
+    std::condition_variable work_cv;
+    std::condition_variable idle_cv;
+    std::atomic<int> next_queue{0};
+    int queued = 0;     // Submitted but not yet picked up (guarded by state_mutex)
+    int pending = 0;    // Submitted but not yet finished (guarded by state_mutex)
+    bool stopping = false;
+};
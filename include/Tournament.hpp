@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Search.hpp"
+#include "Game.hpp"
+#include <string>
+#include <vector>
+
+namespace Tournament {
+
+    // Invoked once per finished game. Calls are serialised, but come from worker threads.
+    using ResultCallback = void(*)(int game_id, int white_bot, int black_bot,
+                                   int opening, int result, double elapsed_s);
+
+    struct TournamentConfig {
+        std::vector<Search::EvalCallback> bots;
+        std::vector<std::string> openings;      // FENs (or "startpos")
+        int games_per_pairing = 2;              // Per opening; colours alternate
+        int depth = 5;                          // Also caps timed searches (<= 0 = clock only)
+        int max_moves = 600;
+        int64_t base_ms = 0;                    // Per-side clock; 0 = fixed depth
+        int64_t increment_ms = 0;
+        int num_threads = 0;                    // 0 = all hardware threads
+        Game::Adjudication adjudication;
+        const Book::OpeningBook* book = nullptr;    // Continues each opening from the book
+        int book_plies = 0;                     // 0 = as deep as the book goes
+    };
+
+    // Plays a round-robin between every pair of bots on a shared thread pool.
+    // Returns the number of games played.
+    int run(const TournamentConfig& config, ResultCallback on_result);
+}
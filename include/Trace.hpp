@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Opt-in timeline of what the engine spent its time on, written as Chrome trace JSON
+// (open it in ui.perfetto.dev or chrome://tracing). Each thread appends to its own
+// fixed-size buffer without locks; once a buffer is full, further events are counted
+// and dropped. While tracing is off, every hook costs one relaxed load and a branch that
+// is never taken.
+// Event names and categories must be string literals: only the pointers are stored.
+namespace Trace {
+
+    struct Options {
+        size_t events_per_thread = 1 << 18;     // 88 bytes each, ~23 MB per thread
+        uint32_t sample_every = 256;            // Record 1 in N evals / move generations per thread
+    };
+
+    extern std::atomic<bool> recording;
+
+    inline bool enabled() { return recording.load(std::memory_order_relaxed); }
+
+    // Throws away the previous session's events and starts recording. Call it while nothing
+    // is being traced, since that frees the old buffers.
+    void start(const Options& options);
+
+    // Stops recording and writes everything recorded to path. Returns the number of events
+    // written, or -1 if the file can't be written. dropped (may be nullptr) gets the number
+    // of events lost to full buffers.
+    int64_t stop(const std::string& path, uint64_t* dropped);
+
+    struct Arg {
+        const char* name = nullptr;     // nullptr = unused
+        int64_t value = 0;
+    };
+
+    // Nanoseconds since start()
+    int64_t now_ns();
+
+    // A span from start_ns until now. move (a Move's raw bits, 0 = none) shows as UCI text.
+    void complete(const char* name, const char* category, int64_t start_ns,
+                  Arg a = {}, Arg b = {}, Arg c = {}, uint16_t move = 0);
+    void instant(const char* name, const char* category, Arg a = {}, Arg b = {}, uint16_t move = 0);
+
+    // --- SAMPLING ---
+    // Per-node work is too frequent to record in full
+    enum Sampler : int {
+        Eval    = 0,
+        MoveGen = 1
+    };
+
+    // True once every sample_every calls for which on this thread; a batch of count
+    // positions counts as count calls
+    bool sample(Sampler which, uint32_t count = 1);
+
+    // --- TRACKS ---
+    // Coroutine searches interleave on one thread, so their spans would overlap on the
+    // thread's own row. Each can record onto a track of its own instead; the trace shows
+    // tracks as extra rows named "<name> <index>".
+    uint32_t new_track(const char* name, int64_t index);
+
+    // Events recorded on this thread while alive go to track (0 = leave as is)
+    class TrackScope {
+    public:
+        explicit TrackScope(uint32_t track);
+        ~TrackScope();
+
+        TrackScope(const TrackScope&) = delete;
+        TrackScope& operator=(const TrackScope&) = delete;
+
+    private:
+        uint32_t previous = 0;
+        bool active = false;
+    };
+
+    // Records the lifetime of a scope. Args can be added any time before it closes.
+    class Span {
+    public:
+        Span(const char* span_name, const char* span_category)
+            : Span(span_name, span_category, enabled()) {}
+        // Only recorded if record is true (e.g. a sample() result)
+        Span(const char* span_name, const char* span_category, bool record)
+            : name(span_name), category(span_category), start_ns(record ? now_ns() : -1) {}
+        ~Span() {
+            if (start_ns >= 0) complete(name, category, start_ns, args[0], args[1], args[2], move_raw);
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        void arg(const char* arg_name, int64_t value) {
+            if (start_ns < 0) return;
+            for (Arg& a : args) {
+                if (a.name == nullptr || a.name == arg_name) {
+                    a = {arg_name, value};
+                    return;
+                }
+            }
+        }
+        void move(uint16_t raw) { move_raw = raw; }
+
+    private:
+        const char* name;
+        const char* category;
+        int64_t start_ns;
+        Arg args[3];
+        uint16_t move_raw = 0;
+    };
+
+    // f() as is, except that 1 in sample_every calls on a thread is recorded as a span
+    template <typename F>
+    inline auto sampled(Sampler which, const char* name, const char* category, F&& f) {
+        if (!enabled() || !sample(which)) return f();
+        Span span(name, category, true);
+        return f();
+    }
+}
@@ -14,5 +14,26 @@ namespace Zobrist {
     
     extern uint64_t side_key;
 
+    // --- CUCKOO TABLES ---
+    // Every reversible move, i.e. a knight, bishop, rook, queen or king of either colour
+    // going between two squares, keyed by the hash change it makes (piece out, piece in,
+    // side flipped). Two positions whose keys differ by one of these are a single quiet move
+    // apart, provided the squares in between are empty. Each key sits in one of its two
+    // slots, so a lookup is at most two probes.
+    constexpr int CUCKOO_SIZE = 8192;
+    extern std::array<uint64_t, CUCKOO_SIZE> cuckoo_keys;      // 0 = empty slot
+    extern std::array<uint64_t, CUCKOO_SIZE> cuckoo_paths;     // Squares strictly between
+
+    inline int cuckoo_h1(uint64_t k) { return static_cast<int>(k & (CUCKOO_SIZE - 1)); }
+    inline int cuckoo_h2(uint64_t k) { return static_cast<int>((k >> 16) & (CUCKOO_SIZE - 1)); }
+
+    // Slot holding move_key, or -1
+    inline int cuckoo_find(uint64_t move_key) {
+        int slot = cuckoo_h1(move_key);
+        if (cuckoo_keys[slot] == move_key) return slot;
+        slot = cuckoo_h2(move_key);
+        return (cuckoo_keys[slot] == move_key) ? slot : -1;
+    }
+
     void init();
 }
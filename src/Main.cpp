@@ -1,4 +1,18 @@
 #include "Interface.hpp"
+#include "Game.hpp"
+#include "Tournament.hpp"
+#include "Match.hpp"
+#include "DataGen.hpp"
+#include "Epd.hpp"
+#include "FenLoader.hpp"
+#include "EvalProfiler.hpp"
+#include "Nnue.hpp"
+#include "Book.hpp"
+#include "Tablebase.hpp"
+#include "MateSolver.hpp"
+#include "Trace.hpp"
+#include "Bench.hpp"
+#include "Memory.hpp"
 #include "Evaluation.hpp"
 #include "MoveGen.hpp"
 #include "Attacks.hpp"
@@ -7,11 +21,15 @@
 #include <iostream>
 #include <string>
 #include <cstdint>
+#include <cstring>
+#include <cstdio>
 #include <atomic>
 #include <vector>
 
 static Search::EvalCallback global_white_eval = nullptr;
 static Search::EvalCallback global_black_eval = nullptr;
+static Search::ContextEvalCallback global_white_context_eval = nullptr;
+static Search::ContextEvalCallback global_black_context_eval = nullptr;
 
 std::atomic<int> g_current_searcher{0};
 static std::string g_last_game_moves;  // UCI moves from last headed game
@@ -23,6 +41,14 @@ int cpp_dispatcher(const uint64_t* pieces, const uint64_t* occupancy, int side)
     return 0;
 }
 
+// Used instead of cpp_dispatcher when either side is a context eval
+int32_t cpp_context_dispatcher(const uint64_t* pieces, const uint64_t* occupancy, uint32_t side, const EvalContext* ctx) {
+    int searcher = g_current_searcher.load(std::memory_order_relaxed);
+    Search::ContextEvalCallback context_fn = (searcher == 0) ? global_white_context_eval : global_black_context_eval;
+    if (context_fn) return context_fn(pieces, occupancy, side, ctx);
+    return cpp_dispatcher(pieces, occupancy, static_cast<int>(side));
+}
+
 extern "C" {
     #ifdef _WIN32
     __declspec(dllexport)
@@ -31,10 +57,15 @@ extern "C" {
     void startEngine(Search::EvalCallback whiteFunc, Search::EvalCallback blackFunc, int depth, int human_side, const char* fen) {
         global_white_eval = whiteFunc;
         global_black_eval = blackFunc;
+        global_white_context_eval = Search::context_eval_for(whiteFunc);
+        global_black_context_eval = Search::context_eval_for(blackFunc);
 
         std::string fen_str = (fen != nullptr) ? std::string(fen) : "startpos";
         
-        GUI::Launch((Search::EvalCallback)cpp_dispatcher, depth, human_side, fen_str, g_last_game_moves);
+        Search::EvalCallback dispatcher = (global_white_context_eval || global_black_context_eval)
+            ? Search::register_context_eval(cpp_context_dispatcher)
+            : (Search::EvalCallback)cpp_dispatcher;
+        GUI::Launch(dispatcher, depth, human_side, fen_str, g_last_game_moves);
     }
 
     #ifdef _WIN32
@@ -50,78 +81,620 @@ extern "C" {
     #endif
     int runHeadlessGame(Search::EvalCallback whiteFunc, Search::EvalCallback blackFunc,
                         int depth, const char* fen, int max_moves) {
-        global_white_eval = whiteFunc;
-        global_black_eval = blackFunc;
+        Attacks::init();
+        Zobrist::init();
+
+        Game::GameConfig config;
+        config.white_eval = whiteFunc;
+        config.black_eval = blackFunc;
+        config.depth      = depth;
+        config.max_moves  = max_moves;
+        config.fen        = (fen != nullptr) ? std::string(fen) : "startpos";
+
+        return Game::play(config).result;
+    }
+
+    // In-process round-robin: every pair of bots plays games_per_pairing games per opening,
+    // concurrently on a work-stealing pool. Results stream back through on_result.
+    // base_ms/increment_ms give both sides a clock (0 = fixed depth).
+    // adjudication may be nullptr (play every game out). book (from openOpeningBook) may be
+    // nullptr; otherwise each opening continues from the book for up to book_plies plies.
+    // Returns the number of games played.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int runTournament(const Search::EvalCallback* bots, int num_bots,
+                      const char** openings, int num_openings,
+                      int games_per_pairing, int depth, int max_moves,
+                      int base_ms, int increment_ms, int num_threads,
+                      const Game::Adjudication* adjudication,
+                      const Book::OpeningBook* book, int book_plies,
+                      Tournament::ResultCallback on_result) {
+        Tournament::TournamentConfig config;
+        config.bots.assign(bots, bots + num_bots);
+        for (int i = 0; i < num_openings; ++i) {
+            config.openings.emplace_back(openings[i] != nullptr ? openings[i] : "startpos");
+        }
+        config.games_per_pairing = games_per_pairing;
+        config.depth             = depth;
+        config.max_moves         = max_moves;
+        config.base_ms           = base_ms;
+        config.increment_ms      = increment_ms;
+        config.num_threads       = num_threads;
+        if (adjudication != nullptr) config.adjudication = *adjudication;
+        config.book              = book;
+        config.book_plies        = book_plies;
+
+        return Tournament::run(config, on_result);
+    }
+
+    // Batched headless games: plays jobs[i] and fills results[i] (outcome, termination,
+    // plies, per-side nodes and clock usage, UCI moves). Jobs may carry per-side clocks.
+    // num_threads: 1 = sequential, 0 = all cores. adjudication and book may be nullptr.
+    // Returns the number of games played.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int runHeadlessMatch(const Match::MatchJob* jobs, Match::MatchResult* results, int num_jobs,
+                         int depth, int max_moves, int num_threads,
+                         const Game::Adjudication* adjudication,
+                         const Book::OpeningBook* book, int book_plies) {
+        return Match::run(jobs, results, num_jobs, depth, max_moves, num_threads,
+                          adjudication != nullptr ? *adjudication : Game::Adjudication(),
+                          book, book_plies);
+    }
+
+    // runHeadlessMatch with every game on the calling thread and bot evals batched across
+    // games (see registerBatchEval). Clocks in the jobs are ignored; at most max_active games
+    // (<= 0 = all) are in flight. stats may be nullptr. Returns the number of games played.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int runBatchedMatch(const Match::MatchJob* jobs, Match::MatchResult* results, int num_jobs,
+                        int depth, int max_moves, int max_active,
+                        const Game::Adjudication* adjudication,
+                        const Book::OpeningBook* book, int book_plies, Batch::Stats* stats) {
+        return Match::run_batched(jobs, results, num_jobs, depth, max_moves, max_active,
+                                  adjudication != nullptr ? *adjudication : Game::Adjudication(),
+                                  book, book_plies, stats);
+    }
+
+    // Pairs eval with batch, which scores many positions per call. Searches run by
+    // runBatchedMatch queue eval's positions and score them with batch; all other searches
+    // keep calling eval. batch = nullptr removes the pairing.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    void registerBatchEval(Search::EvalCallback eval, Search::BatchEvalCallback batch) {
+        if (eval != nullptr) Search::register_batch_eval(eval, batch);
+    }
+
+    // --- TRAINING DATA ---
+
+    // Self-play with eval (nullptr = built-in) on both sides at options->nodes per move,
+    // appending 32-byte DataGen::PackedPosition records to out_path. adjudication and
+    // on_progress may be nullptr. Returns positions written, or -1 on an I/O error.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int64_t generateTrainingData(Search::EvalCallback eval, const DataGen::Options* options,
+                                 const char* out_path, const Game::Adjudication* adjudication,
+                                 DataGen::ProgressCallback on_progress) {
+        if (options == nullptr || out_path == nullptr) return -1;
+        return DataGen::generate(eval, *options, out_path, adjudication, on_progress);
+    }
+
+    // Parses a FEN/EPD file (one position per line) in parallel and writes the positions
+    // as 32-byte DataGen::PackedPosition records to out_path. Bad lines are skipped; with
+    // errors_path they are listed there as "line: reason". num_errors may be nullptr.
+    // Returns positions written, or -1 on an I/O error.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int64_t convertPositionFile(const char* in_path, const char* out_path, int num_threads,
+                                const char* errors_path, int64_t* num_errors) {
+        if (in_path == nullptr || out_path == nullptr) return -1;
+        FenLoader::LoadResult loaded;
+        if (!FenLoader::load(in_path, loaded, num_threads)) return -1;
+        if (num_errors != nullptr) *num_errors = static_cast<int64_t>(loaded.errors.size());
+
+        std::FILE* f = std::fopen(out_path, "wb");
+        if (!f) return -1;
+        size_t n = loaded.positions.size();
+        bool ok = (n == 0 || std::fwrite(loaded.positions.data(), sizeof(DataGen::PackedPosition), n, f) == n);
+        ok = (std::fclose(f) == 0) && ok;
+
+        if (errors_path != nullptr && errors_path[0] != '\0') {
+            std::FILE* e = std::fopen(errors_path, "w");
+            if (!e) return -1;
+            for (const auto& err : loaded.errors) {
+                std::fprintf(e, "%lld: %s\n", static_cast<long long>(err.line), err.reason);
+            }
+            ok = (std::fclose(e) == 0) && ok;
+        }
+        return ok ? static_cast<int64_t>(n) : -1;
+    }
+
+    // --- EVAL PROFILING ---
+
+    // Times every bot's eval (nullptr entries = built-in) on each position of corpus_path
+    // (packed .bin or FEN/EPD text; the first max_positions, 0 = all) after warmup_calls
+    // untimed calls. Bots run concurrently on up to num_threads threads (0 = one per bot,
+    // capped at the core count). profiles gets num_bots entries; correlation (may be
+    // nullptr) a num_bots x num_bots row-major Pearson matrix of the scores.
+    // Returns the number of positions used, or -1 if the corpus can't be read.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int64_t profileEvals(const Search::EvalCallback* bots, int num_bots, const char* corpus_path,
+                         int64_t max_positions, int64_t warmup_calls, int num_threads,
+                         EvalProfiler::Profile* profiles, double* correlation) {
+        std::vector<DataGen::PackedPosition> positions;
+        if (corpus_path == nullptr || !EvalProfiler::load_corpus(corpus_path, positions)) return -1;
+        if (max_positions > 0 && static_cast<int64_t>(positions.size()) > max_positions) {
+            positions.resize(static_cast<size_t>(max_positions));
+        }
+
+        std::vector<Search::EvalCallback> evals(bots, bots + num_bots);
+        std::vector<EvalProfiler::Profile> results;
+        std::vector<double> matrix;
+        EvalProfiler::run(evals, positions, warmup_calls, num_threads, results,
+                          correlation != nullptr ? &matrix : nullptr);
+
+        if (profiles != nullptr) std::copy(results.begin(), results.end(), profiles);
+        if (correlation != nullptr) std::copy(matrix.begin(), matrix.end(), correlation);
+        return static_cast<int64_t>(positions.size());
+    }
+
+    // --- LAZY EVAL ---
+
+    // Sets the lazy-eval margin for eval (0 turns the gate off for it). Quiescence then skips
+    // the callback wherever the built-in PeSTO score +/- margin can't reach the window.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    void setLazyMargin(Search::EvalCallback eval, int32_t margin) {
+        if (eval != nullptr) Search::set_lazy_margin(eval, margin);
+    }
+
+    // Margin covering |eval - PeSTO| on a `coverage` fraction (e.g. 0.99) of corpus_path's
+    // positions (the first max_positions, 0 = all). Returns -1 if the corpus can't be read.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int32_t calibrateLazyMargin(Search::EvalCallback eval, const char* corpus_path,
+                                int64_t max_positions, double coverage) {
+        std::vector<DataGen::PackedPosition> positions;
+        if (corpus_path == nullptr || !EvalProfiler::load_corpus(corpus_path, positions)) return -1;
+        if (max_positions > 0 && static_cast<int64_t>(positions.size()) > max_positions) {
+            positions.resize(static_cast<size_t>(max_positions));
+        }
+        return EvalProfiler::calibrate_lazy_margin(eval, positions, coverage);
+    }
+
+    // Eval callbacks made and avoided by all searches since the last reset
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    void lazyEvalCounters(uint64_t* calls, uint64_t* skipped, bool reset) {
+        uint64_t c = 0, s = 0;
+        Search::lazy_eval_totals(c, s, reset);
+        if (calls != nullptr) *calls = c;
+        if (skipped != nullptr) *skipped = s;
+    }
+
+    // --- SEARCH BACKENDS ---
+
+    // Makes every search that uses eval run best-first MCTS with options (worker threads,
+    // leaf batch size, playouts per move, ...); nullptr puts it back on alpha-beta.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    void setMctsBackend(Search::EvalCallback eval, const Search::MctsOptions* options) {
+        if (eval != nullptr) Search::set_mcts_backend(eval, options);
+    }
+
+    // --- TRACING ---
+
+    // Starts recording search, eval, move generation and game events from every thread
+    // into per-thread buffers of events_per_thread events (0 = default). One in sample_every
+    // evals / move generations per thread is recorded (0 = default). Drops any unsaved trace.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    void startTrace(int64_t events_per_thread, int sample_every) {
+        Trace::Options options;
+        if (events_per_thread > 0) options.events_per_thread = static_cast<size_t>(events_per_thread);
+        if (sample_every > 0) options.sample_every = static_cast<uint32_t>(sample_every);
+        Trace::start(options);
+    }
+
+    // Stops recording and writes Chrome trace JSON to path (open in ui.perfetto.dev).
+    // dropped (may be nullptr) gets the events lost to full buffers. Returns the number of
+    // events written, or -1 if path can't be written.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int64_t stopTrace(const char* path, uint64_t* dropped) {
+        if (path == nullptr) return -1;
+        return Trace::stop(path, dropped);
+    }
+
+    // --- BENCH ---
+
+    // Runs the fixed bench workload on the calling thread with eval (nullptr = built-in)
+    // searching to depth (<= 0 = default), copy-make if copy_make. results gets one entry
+    // per Bench::Phase (attack lookups, make/undo perft, copy-make perft, eval calls,
+    // search), each with its time and hardware counters (-1 where unavailable). Returns
+    // the search node count.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int64_t runBench(Search::EvalCallback eval, int depth, bool copy_make, Bench::PhaseResult* results) {
+        if (results == nullptr) return -1;
+        Attacks::init();
+        Zobrist::init();
+        Bench::Options options;
+        options.eval = eval;
+        options.copy_make = copy_make;
+        if (depth > 0) options.depth = depth;
+        return static_cast<int64_t>(Bench::run(options, results));
+    }
+
+    // Writes why hardware counters are missing on the calling thread into out ("" = none
+    // missing) if it fits in capacity. Returns the number of counters that open.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int perfCounterStatus(char* out, int capacity) {
+        PerfCounters::Group group;
+        const std::string& status = group.status();
+        if (out != nullptr && capacity > 0) {
+            if (capacity > static_cast<int>(status.size())) std::memcpy(out, status.c_str(), status.size() + 1);
+            else out[0] = '\0';
+        }
+        return group.available();
+    }
+
+    // --- MEMORY PLACEMENT ---
+
+    // Huge pages for the TT and attack tables (explicit if reserved, else transparent),
+    // pinning of pool and MCTS threads to CPUs spread over NUMA nodes, and per-node copies
+    // of native networks. Affects tables built and threads started afterwards, so call it
+    // before anything else.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    void configureMemory(bool large_pages, bool pin_threads, bool replicate) {
+        Memory::Options options;
+        options.large_pages = large_pages;
+        options.pin_threads = pin_threads;
+        options.replicate = replicate;
+        Memory::configure(options);
+    }
+
+    // Writes huge page support, the node count, the configured options and where the
+    // attack tables ended up into out if it fits in capacity. Returns the number of nodes.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int memoryStatus(char* out, int capacity) {
+        Attacks::init();
+        std::string status = Memory::status() + "; attacks " + Memory::describe(Attacks::table_memory());
+        if (out != nullptr && capacity > 0) {
+            if (capacity > static_cast<int>(status.size())) std::memcpy(out, status.c_str(), status.size() + 1);
+            else out[0] = '\0';
+        }
+        return Memory::num_nodes();
+    }
+
+    // --- TEST SUITES ---
+
+    // Searches every bm/am position of an EPD file with eval (nullptr = built-in) under
+    // time_ms / nodes / depth per position, and writes one row per position to report_path
+    // (JSON if it ends in ".json", CSV otherwise). num_positions (may be nullptr) gets the
+    // number of positions run. Returns the solved count, -1 if the EPD file can't be read
+    // or -2 if the report can't be written.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int runEpdSuite(Search::EvalCallback eval, const char* epd_path, const char* report_path,
+                    int64_t time_ms, uint64_t nodes, int depth, int num_threads,
+                    int* num_positions, Epd::ProgressCallback on_progress) {
+        std::vector<Epd::EpdEntry> entries;
+        if (epd_path == nullptr || Epd::load(epd_path, entries) < 0) return -1;
+        if (num_positions != nullptr) *num_positions = static_cast<int>(entries.size());
+
+        Epd::RunOptions options;
+        options.time_ms     = time_ms;
+        options.nodes       = nodes;
+        options.depth       = depth;
+        options.num_threads = num_threads;
+
+        std::vector<Epd::PositionResult> results;
+        int solved = Epd::run(entries, eval, options, results, on_progress);
+
+        if (report_path != nullptr && report_path[0] != '\0') {
+            std::string path(report_path);
+            bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+            bool ok = json ? Epd::write_json(path, entries, results) : Epd::write_csv(path, entries, results);
+            if (!ok) return -2;
+        }
+        return solved;
+    }
+
+    // --- OPENING BOOK ---
 
+    // Streams PGN files into a sorted book file. Records the first max_ply plies of each
+    // game and drops moves whose result-weighted score is below min_weight.
+    // Returns the number of entries written, or -1 on an I/O error.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int64_t buildOpeningBook(const char** pgn_paths, int num_paths, const char* out_path,
+                             int max_ply, int min_weight) {
+        Attacks::init();
+        Zobrist::init();
+
+        std::vector<std::string> paths;
+        for (int i = 0; i < num_paths; ++i) {
+            if (pgn_paths[i] != nullptr) paths.emplace_back(pgn_paths[i]);
+        }
+        Book::BuildOptions options;
+        options.max_ply    = max_ply;
+        options.min_weight = min_weight;
+        return Book::build(paths, out_path != nullptr ? out_path : "", options);
+    }
+
+    // Maps a book file into memory. Returns nullptr if it can't be opened.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    Book::OpeningBook* openOpeningBook(const char* path) {
         Attacks::init();
         Zobrist::init();
 
+        auto* book = new Book::OpeningBook();
+        if (path == nullptr || !book->open(path)) {
+            delete book;
+            return nullptr;
+        }
+        return book;
+    }
+
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    void closeOpeningBook(Book::OpeningBook* book) {
+        delete book;
+    }
+
+    // Picks a weighted book move for fen into uci_out. Returns the number of book moves
+    // for the position (0 = out of book, nothing written).
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int probeOpeningBook(const Book::OpeningBook* book, const char* fen, uint64_t seed,
+                         char* uci_out, int capacity) {
+        if (book == nullptr) return 0;
         BoardState board;
-        std::string fen_str = (fen != nullptr) ? std::string(fen) : "startpos";
+        Game::setup_board(board, fen != nullptr ? fen : "startpos");
 
-        if (fen_str.empty() || fen_str == "startpos") {
-            board.pieces[0]  = 0x000000000000FF00ULL; board.pieces[6]  = 0x00FF000000000000ULL;
-            board.pieces[1]  = 0x0000000000000042ULL; board.pieces[7]  = 0x4200000000000000ULL;
-            board.pieces[2]  = 0x0000000000000024ULL; board.pieces[8]  = 0x2400000000000000ULL;
-            board.pieces[3]  = 0x0000000000000081ULL; board.pieces[9]  = 0x8100000000000000ULL;
-            board.pieces[4]  = 0x0000000000000008ULL; board.pieces[10] = 0x0800000000000000ULL;
-            board.pieces[5]  = 0x0000000000000010ULL; board.pieces[11] = 0x1000000000000000ULL;
-            board.occupancy[0] = 0ULL; board.occupancy[1] = 0ULL;
-            for (int i = 0;  i < 6;  ++i) board.occupancy[0] |= board.pieces[i];
-            for (int i = 6;  i < 12; ++i) board.occupancy[1] |= board.pieces[i];
-            board.occupancy[2] = board.occupancy[0] | board.occupancy[1];
-            board.to_move = Colour::White;
-            board.castle_rights = 0b1111;
-            board.full_move_number = 1;
-            board.refresh_hash();
-        } else {
-            board.load_fen(fen_str);
+        int count = static_cast<int>(book->lookup(board).size());
+        Move m = book->pick(board, seed);
+        if (m.raw() == 0) return 0;
+
+        std::string uci = Game::move_to_uci(m);
+        if (uci_out != nullptr && capacity > static_cast<int>(uci.size())) {
+            std::memcpy(uci_out, uci.c_str(), uci.size() + 1);
         }
+        return count;
+    }
 
-        for (int move_num = 0; move_num < max_moves; ++move_num) {
-            if (board.is_draw()) return 0;
-
-            // Check for any legal move
-            std::vector<Move> all_moves;
-            MoveGen::generate_moves(board, all_moves);
-
-            bool has_legal = false;
-            for (const auto& m : all_moves) {
-                board.make_move(m);
-                Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
-                Square k = Search::find_king(board, us);
-                bool illegal = Attacks::is_square_attacked(
-                    k, board.to_move, board.pieces.data(), board.occupancy[2]);
-                board.undo_move(m);
-                if (!illegal) { has_legal = true; break; }
-            }
+    // --- ENDGAME TABLEBASES ---
 
-            if (!has_legal) {
-                Colour us   = board.to_move;
-                Colour them = (us == Colour::White) ? Colour::Black : Colour::White;
-                Square k    = Search::find_king(board, us);
-                if (Attacks::is_square_attacked(k, them, board.pieces.data(), board.occupancy[2]))
-                    return (us == Colour::White) ? 2 : 1;  // Checkmate
-                return 0;  // Stalemate
-            }
+    // Loads Syzygy files from paths (':'-separated, ';' on Windows) for every search and
+    // for tablebase adjudication. Searches probe WDL at nodes with at least probe_depth
+    // plies left and at most probe_limit pieces. Call before starting games.
+    // Returns the largest piece count found (0 = none).
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int initTablebases(const char* paths, int probe_depth, int probe_limit) {
+        Attacks::init();
+        Zobrist::init();
+        Tablebase::set_probe_limits(probe_depth, probe_limit);
+        return Tablebase::init(paths != nullptr ? paths : "");
+    }
+
+    // Returns the WDL for the side to move (-2 loss .. 2 win; +-1 = cursed win / blessed
+    // loss), or -3 if the position isn't covered. dtz (may be nullptr) gets the DTZ in plies.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int probeTablebase(const char* fen, int* dtz) {
+        BoardState board;
+        Game::setup_board(board, fen != nullptr ? fen : "startpos");
+        if (board.castle_rights != 0) return -3;
+
+        Tablebase::ProbeState state;
+        Tablebase::WDL wdl = Tablebase::probe_wdl(board, state);
+        if (state == Tablebase::Fail) return -3;
+        if (dtz != nullptr) {
+            *dtz = Tablebase::probe_dtz(board, state);
+            if (state == Tablebase::Fail) *dtz = 0;
+        }
+        return wdl;
+    }
 
-            // Run search
-            g_current_searcher.store(
-                (board.to_move == Colour::White) ? 0 : 1,
-                std::memory_order_relaxed);
+    // --- MATE SOLVER ---
 
-            Search::SearchParams params;
-            params.depth    = depth;
-            params.evalFunc = (Search::EvalCallback)cpp_dispatcher;
+    // Looks for a forced mate by the side to move in at most max_moves moves (proof-number
+    // search, no eval). node_budget 0 = unlimited. Returns 1 = mate, 2 = no mate within
+    // max_moves, 0 = budget ran out first. mate_in / nodes (may be nullptr) get the mate
+    // length in moves and the nodes searched; pv_out gets the mating line as space-separated
+    // UCI moves if it fits in capacity.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int solveMate(const char* fen, int max_moves, uint64_t node_budget, int* mate_in,
+                  uint64_t* nodes, char* pv_out, int capacity) {
+        Attacks::init();
+        Zobrist::init();
+        BoardState board;
+        Game::setup_board(board, fen != nullptr ? fen : "startpos");
 
-            Search::SearchStats stats;
-            Move best = Search::iterative_deepening(board, params, stats);
-            if (best.raw() == 0) return 0;
+        MateSolver::Options options;
+        options.max_moves = max_moves;
+        options.node_budget = node_budget;
+        MateSolver::Result result = MateSolver::solve(board, options);
 
-            board.make_move(best);
+        if (mate_in != nullptr) *mate_in = result.mate_in;
+        if (nodes != nullptr) *nodes = result.nodes;
+        if (pv_out != nullptr && capacity > 0) {
+            std::string pv;
+            for (const Move& m : result.pv) {
+                if (!pv.empty()) pv += ' ';
+                pv += Game::move_to_uci(m);
+            }
+            if (capacity > static_cast<int>(pv.size())) std::memcpy(pv_out, pv.c_str(), pv.size() + 1);
+            else pv_out[0] = '\0';
         }
+        return result.status;
+    }
+
+    // --- CONTEXT EVALS ---
+
+    // Registers a v2 eval, which also receives a read-only EvalContext (attack maps,
+    // checkers, pins, cached pawn structure). Returns the handle to pass wherever an
+    // eval callback is taken, or nullptr if the registry is full.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    Search::EvalCallback registerContextEval(Search::ContextEvalCallback fn) {
+        Attacks::init();
+        return fn ? Search::register_context_eval(fn) : nullptr;
+    }
+
+    // Fills out with the context a v2 eval would get for fen. Returns false on a bad FEN.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    bool buildEvalContext(const char* fen, EvalContext* out) {
+        Attacks::init();
+        Zobrist::init();
+        BoardState board;
+        if (fen == nullptr || out == nullptr) return false;
+        if (std::strcmp(fen, "startpos") == 0) Game::setup_board(board, fen);
+        else if (!board.load_fen(fen)) return false;
+        Context::build(board, *out);
+        return true;
+    }
+
+    // --- NATIVE NETWORKS ---
+
+    // Loads a weight file written by app/nnue.py (format in include/Nnue.hpp). Returns the
+    // eval handle to pass wherever an eval callback is taken (searches update the network
+    // incrementally), or nullptr if the file is missing/malformed or all slots are used.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    Search::EvalCallback loadNnue(const char* path) {
+        Nnue::Network net;
+        if (path == nullptr || !Nnue::load(path, net)) return nullptr;
+        return Nnue::register_network(std::move(net));
+    }
+
+    // --- ATTACK HELPERS ---
+    // Magic-bitboard lookups for evals, which only get raw bitboards (bound for Numba by
+    // app/native_attacks.py). Squares are 0-63 with A1 = 0; side is 0 = white, 1 = black.
+
+    // Builds the attack tables. Needed only when calling these before any game or search.
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    void initAttackTables() {
+        Attacks::init();
+    }
+
+    // Squares come straight from ctypes/Numba callers (lsbIndex gives 64 for an empty
+    // board), so the lookups below return no attacks for anything off the board
+    static bool on_board(int sq) {
+        return static_cast<unsigned>(sq) < 64;
+    }
+
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    uint64_t rookAttacks(int sq, uint64_t occupancy) {
+        return on_board(sq) ? Attacks::get_rook_attacks(sq, occupancy) : 0;
+    }
+
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    uint64_t bishopAttacks(int sq, uint64_t occupancy) {
+        return on_board(sq) ? Attacks::get_bishop_attacks(sq, occupancy) : 0;
+    }
+
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    uint64_t queenAttacks(int sq, uint64_t occupancy) {
+        return on_board(sq) ? Attacks::get_queen_attacks(sq, occupancy) : 0;
+    }
+
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    uint64_t knightAttacks(int sq) {
+        return on_board(sq) ? Attacks::KnightAttacks[sq] : 0;
+    }
+
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    uint64_t kingAttacks(int sq) {
+        return on_board(sq) ? Attacks::KingAttacks[sq] : 0;
+    }
+
+    // Squares a pawn of side on sq attacks
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    uint64_t pawnAttacks(int sq, int side) {
+        return on_board(sq) ? Attacks::PawnAttacks[side & 1][sq] : 0;
+    }
+
+    // Squares attacked by every pawn in pawns at once
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    uint64_t pawnAttackSpan(uint64_t pawns, int side) {
+        return Attacks::get_pawn_attacks((side & 1) ? Colour::Black : Colour::White, pawns);
+    }
+
+    // Every square attacked by side; pieces is the 12-bitboard array the eval receives
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    uint64_t attackMap(const uint64_t* pieces, uint64_t occupancy, int side) {
+        return Attacks::attacked_squares((side & 1) ? Colour::Black : Colour::White, pieces, occupancy);
+    }
 
-        return -1;  // Exceeded max moves
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int popCount(uint64_t bb) {
+        return BitUtil::count_bits(bb);
+    }
+
+    // Index of the lowest set bit, or 64 for an empty board
+    #ifdef _WIN32
+    __declspec(dllexport)
+    #endif
+    int lsbIndex(uint64_t bb) {
+        return BitUtil::lsb(bb);
     }
 }
 
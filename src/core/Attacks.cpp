@@ -2,6 +2,7 @@
 #include "BitUtil.hpp"
 #include <vector>
 #include <cassert>
+#include <cstddef>
 
 namespace Attacks {
 
@@ -11,8 +12,14 @@ std::array<uint64_t, 64> KingAttacks;
 
 std::array<Magic, 64> RookMagics;
 std::array<Magic, 64> BishopMagics;
-std::array<Bitboard, 102400> RookTable;
-std::array<Bitboard, 5248>   BishopTable;
+
+// Rook then bishop attack sets in one block, so a single huge page can map every lookup.
+// Built once and never freed, so threads still running at exit can't see it go.
+static constexpr size_t ROOK_ENTRIES = 102400;
+static constexpr size_t BISHOP_ENTRIES = 5248;
+static Memory::Block slider_block;
+static Bitboard* RookTable = nullptr;
+static Bitboard* BishopTable = nullptr;
 
 namespace {
     // Improved pseudo-RNG (Xorshift)
@@ -137,8 +144,11 @@ void init() {
     static bool initialized = false;
     if (initialized) return;
 
-    find_magics(true, RookMagics, RookTable.data());
-    find_magics(false, BishopMagics, BishopTable.data());
+    slider_block = Memory::allocate((ROOK_ENTRIES + BISHOP_ENTRIES) * sizeof(Bitboard));
+    RookTable = static_cast<Bitboard*>(slider_block.ptr);
+    BishopTable = RookTable + ROOK_ENTRIES;
+    find_magics(true, RookMagics, RookTable);
+    find_magics(false, BishopMagics, BishopTable);
 
     // Init Leapers (Pawns, Knights, Kings)
     for (int sq = 0; sq < 64; ++sq) {
@@ -178,6 +188,10 @@ void init() {
     initialized = true;
 }
 
+const Memory::Block& table_memory() {
+    return slider_block;
+}
+
 uint64_t get_rook_attacks(int sq, uint64_t occ) {
     const auto& m = RookMagics[sq];
     occ &= m.mask;
@@ -212,4 +226,29 @@ bool is_square_attacked(Square sq, Colour attacker, const Bitboard pieces[], Bit
     return false;
 }
 
+uint64_t get_pawn_attacks(Colour side, uint64_t pawns) {
+    if (side == Colour::White) {
+        return ((pawns << 7) & 0x7F7F7F7F7F7F7F7FULL) | ((pawns << 9) & 0xFEFEFEFEFEFEFEFEULL);
+    }
+    return ((pawns >> 7) & 0xFEFEFEFEFEFEFEFEULL) | ((pawns >> 9) & 0x7F7F7F7F7F7F7F7FULL);
+}
+
+uint64_t attacked_squares(Colour side, const Bitboard pieces[], Bitboard all_occ) {
+    int base = static_cast<int>(side) * 6;
+    Bitboard attacks = get_pawn_attacks(side, pieces[base]);
+
+    Bitboard bb = pieces[base + 1];
+    while (bb) attacks |= KnightAttacks[static_cast<int>(BitUtil::pop_lsb(bb))];
+
+    bb = pieces[base + 2] | pieces[base + 4];
+    while (bb) attacks |= get_bishop_attacks(static_cast<int>(BitUtil::pop_lsb(bb)), all_occ);
+
+    bb = pieces[base + 3] | pieces[base + 4];
+    while (bb) attacks |= get_rook_attacks(static_cast<int>(BitUtil::pop_lsb(bb)), all_occ);
+
+    bb = pieces[base + 5];
+    while (bb) attacks |= KingAttacks[static_cast<int>(BitUtil::pop_lsb(bb))];
+    return attacks;
+}
+
 }
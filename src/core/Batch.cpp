@@ -0,0 +1,122 @@
+#include "Batch.hpp"
+#include "SearchCoroutine.hpp"
+#include "Attacks.hpp"
+#include "Zobrist.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+namespace Batch {
+
+    struct Slot {
+        size_t index;                                       // Into configs / results
+        std::unique_ptr<Game::Runner> game;
+        std::unique_ptr<Search::SearchCoroutine> search;    // Current move's search, if any
+        uint32_t track;                                     // Trace row of this game's events
+    };
+
+    // Plays on until the game's search waits for a batch eval (true) or the game is over
+    static bool advance(Slot& slot, std::vector<Search::PendingEval*>& queue) {
+        Trace::TrackScope track(slot.track);
+        for (;;) {
+            if (!slot.search) {
+                if (!slot.game->next()) return false;
+                slot.search = std::make_unique<Search::SearchCoroutine>(slot.game->board, slot.game->params, queue);
+            }
+            if (!slot.search->resume()) return true;
+            slot.game->play(slot.search->best_move(), slot.search->stats());
+            slot.search.reset();
+        }
+    }
+
+    // --- BATCH BUFFERS ---
+    // Reused across rounds so a round allocates nothing once warmed up
+    struct Buffers {
+        std::vector<uint64_t> pieces;
+        std::vector<uint64_t> occupancy;
+        std::vector<uint32_t> sides;
+        std::vector<int32_t> scores;
+    };
+
+    // Scores every queued position, one call per distinct batch eval
+    static void score_queue(std::vector<Search::PendingEval*>& queue, Buffers& buf, Stats& stats) {
+        // Group by eval; the queue is small and mostly one or two evals, so a sort is plenty
+        std::stable_sort(queue.begin(), queue.end(), [](const Search::PendingEval* a, const Search::PendingEval* b) {
+            return reinterpret_cast<uintptr_t>(a->batch) < reinterpret_cast<uintptr_t>(b->batch);
+        });
+
+        for (size_t begin = 0; begin < queue.size();) {
+            Search::BatchEvalCallback batch = queue[begin]->batch;
+            size_t end = begin;
+            while (end < queue.size() && queue[end]->batch == batch) ++end;
+            size_t n = end - begin;
+
+            buf.pieces.resize(n * 12);
+            buf.occupancy.resize(n * 3);
+            buf.sides.resize(n);
+            buf.scores.assign(n, 0);
+            for (size_t i = 0; i < n; ++i) {
+                const BoardState& board = *queue[begin + i]->board;
+                std::copy(board.pieces.begin(), board.pieces.end(), buf.pieces.begin() + i * 12);
+                std::copy(board.occupancy.begin(), board.occupancy.end(), buf.occupancy.begin() + i * 3);
+                buf.sides[i] = (board.to_move == Colour::White) ? 0 : 1;
+            }
+
+            {
+                Trace::Span span("eval batch", "eval", Trace::enabled() && Trace::sample(Trace::Eval, static_cast<uint32_t>(n)));
+                span.arg("positions", static_cast<int64_t>(n));
+                batch(buf.pieces.data(), buf.occupancy.data(), buf.sides.data(), buf.scores.data(), static_cast<uint32_t>(n));
+            }
+            for (size_t i = 0; i < n; ++i) queue[begin + i]->score = buf.scores[i];
+
+            stats.positions += static_cast<int64_t>(n);
+            stats.batch_calls++;
+            stats.max_batch = std::max(stats.max_batch, static_cast<int64_t>(n));
+            begin = end;
+        }
+        stats.rounds++;
+        queue.clear();
+    }
+
+    std::vector<Game::GameResult> play(const std::vector<Game::GameConfig>& configs,
+                                       int max_active, Stats* stats) {
+        Attacks::init();
+        Zobrist::init();
+
+        Stats totals{};
+        std::vector<Game::GameResult> results(configs.size());
+        size_t limit = (max_active > 0) ? std::min(configs.size(), static_cast<size_t>(max_active)) : configs.size();
+
+        std::vector<Slot> active;
+        active.reserve(limit);
+        std::vector<Search::PendingEval*> queue;
+        Buffers buf;
+        size_t next_config = 0;
+
+        while (next_config < configs.size() || !active.empty()) {
+            while (active.size() < limit && next_config < configs.size()) {
+                Game::GameConfig config = configs[next_config];
+                config.time_control[0] = config.time_control[1] = Game::TimeControl();
+                uint32_t track = Trace::new_track("game", static_cast<int64_t>(next_config));
+                active.push_back(Slot{next_config++, std::make_unique<Game::Runner>(config), nullptr, track});
+            }
+
+            // Every game in flight is new or has its eval scored: run each to its next eval
+            for (size_t i = 0; i < active.size();) {
+                if (advance(active[i], queue)) {
+                    ++i;
+                    continue;
+                }
+                results[active[i].index] = active[i].game->result();
+                active[i] = std::move(active.back());
+                active.pop_back();
+            }
+
+            if (!queue.empty()) score_queue(queue, buf, totals);
+        }
+
+        if (stats) *stats = totals;
+        return results;
+    }
+}
@@ -0,0 +1,220 @@
+#include "Bench.hpp"
+#include "Attacks.hpp"
+#include "EvalContext.hpp"
+#include "Evaluation.hpp"
+#include "Game.hpp"
+#include "MoveGen.hpp"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace Bench {
+
+    static const char* PHASE_NAMES[NUM_PHASES] = { "attacks", "perft", "perft-copy", "eval", "search" };
+
+    const char* phase_name(int phase) {
+        return (phase >= 0 && phase < NUM_PHASES) ? PHASE_NAMES[phase] : "?";
+    }
+
+    // Openings, middlegames and endgames, including the usual perft test positions
+    static const char* POSITIONS[] = {
+        "startpos",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 0 9",
+    };
+    static constexpr int NUM_POSITIONS = sizeof(POSITIONS) / sizeof(POSITIONS[0]);
+
+    static constexpr int ATTACK_REPS = 20000;           // Passes over every position x square
+    static constexpr size_t MAX_EVAL_INPUTS = 4096;     // Leaves kept per position for the eval phase
+    static constexpr int64_t EVAL_CALLS = 1000000;
+
+    // Eval arguments copied out of a board, so the eval phase times only the calls
+    struct EvalInput {
+        uint64_t pieces[12];
+        uint64_t occupancy[3];
+        uint32_t side;
+        uint64_t pawn_key;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // The timed loops store their results here so the compiler can't drop them
+    static volatile uint64_t keep_result = 0;
+
+    static thread_local std::unique_ptr<PerfCounters::Group> counter_group;
+
+    static PerfCounters::Group& thread_counters() {
+        if (!counter_group) counter_group = std::make_unique<PerfCounters::Group>();
+        return *counter_group;
+    }
+
+    const std::string& counters_status() {
+        return thread_counters().status();
+    }
+
+    // Times a phase and reads the counters around it; body returns the phase's op count
+    template <typename F>
+    static void measure(PhaseResult& out, F&& body) {
+        const PerfCounters::Group& group = thread_counters();
+        PerfCounters::Values before = group.read();
+        auto t0 = Clock::now();
+        out.ops = body();
+        auto t1 = Clock::now();
+        out.counters = PerfCounters::difference(group.read(), before);
+        out.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    }
+
+    // --- PHASES ---
+    static int64_t attack_lookups(const std::vector<BoardState>& boards) {
+        uint64_t sink = 0;
+        int64_t ops = 0;
+        for (int rep = 0; rep < ATTACK_REPS; ++rep) {
+            for (const BoardState& board : boards) {
+                // Varies the occupancy a little each pass so the loop can't be hoisted
+                uint64_t occ = board.occupancy[2] ^ (sink & 0xFF00000000000000ULL);
+                for (int sq = 0; sq < 64; ++sq) {
+                    sink += Attacks::get_rook_attacks(sq, occ);
+                    sink ^= Attacks::get_bishop_attacks(sq, occ);
+                }
+                ops += 128;
+            }
+        }
+        keep_result = sink;
+        return ops;
+    }
+
+    static bool left_in_check(const Position& pos) {
+        Colour us = (pos.to_move == Colour::White) ? Colour::Black : Colour::White;
+        return Attacks::is_square_attacked(Search::find_king(pos, us), pos.to_move,
+                                           pos.pieces.data(), pos.occupancy[2]);
+    }
+
+    static int64_t perft(BoardState& board, int depth) {
+        if (depth == 0) return 0;
+        std::vector<Move> moves;
+        MoveGen::generate_moves(board, moves);
+        int64_t made = 0;
+        for (Move m : moves) {
+            board.make_move(m);
+            ++made;
+            if (!left_in_check(board)) made += perft(board, depth - 1);
+            board.undo_move(m);
+        }
+        return made;
+    }
+
+    static int64_t perft_copy(const Position& pos, int depth) {
+        if (depth == 0) return 0;
+        std::vector<Move> moves;
+        MoveGen::generate_moves(pos, moves);
+        int64_t made = 0;
+        Position::Undo unused;
+        for (Move m : moves) {
+            Position child = pos;
+            child.make_move(m, unused);
+            ++made;
+            if (!left_in_check(child)) made += perft_copy(child, depth - 1);
+        }
+        return made;
+    }
+
+    // Legal positions depth plies from pos, until leaves is at capacity
+    static void collect_leaves(const Position& pos, int depth, std::vector<EvalInput>& leaves) {
+        if (leaves.size() >= leaves.capacity()) return;
+        if (depth == 0) {
+            EvalInput in;
+            for (int i = 0; i < 12; ++i) in.pieces[i] = pos.pieces[i];
+            for (int i = 0; i < 3; ++i) in.occupancy[i] = pos.occupancy[i];
+            in.side = (pos.to_move == Colour::White) ? 0 : 1;
+            in.pawn_key = pos.pawn_key;
+            leaves.push_back(in);
+            return;
+        }
+        std::vector<Move> moves;
+        MoveGen::generate_moves(pos, moves);
+        Position::Undo unused;
+        for (Move m : moves) {
+            Position child = pos;
+            child.make_move(m, unused);
+            if (!left_in_check(child)) collect_leaves(child, depth - 1, leaves);
+        }
+    }
+
+    static int64_t eval_calls(Search::EvalCallback eval, const std::vector<EvalInput>& inputs) {
+        if (inputs.empty()) return 0;
+        Search::ContextEvalCallback context_eval = Search::context_eval_for(eval);
+        int64_t sink = 0;
+        int64_t calls = 0;
+        while (calls < EVAL_CALLS) {
+            for (const EvalInput& in : inputs) {
+                if (context_eval) {
+                    EvalContext ctx;
+                    Context::build(in.pieces, in.occupancy, in.side, in.pawn_key, ctx);
+                    sink += context_eval(in.pieces, in.occupancy, in.side, &ctx);
+                } else {
+                    sink += eval(in.pieces, in.occupancy, in.side);
+                }
+            }
+            calls += static_cast<int64_t>(inputs.size());
+        }
+        keep_result = static_cast<uint64_t>(sink);
+        return calls;
+    }
+
+    static int64_t searches(const std::vector<BoardState>& boards, const Options& options) {
+        Search::SearchState state(options.hash_mb);
+        int64_t nodes = 0;
+        for (const BoardState& start : boards) {
+            state.clear();
+            BoardState board = start;
+            Search::SearchParams params{};
+            params.depth = options.depth;
+            params.evalFunc = options.eval;
+            params.state = &state;
+            params.copy_make = options.copy_make;
+            Search::SearchStats stats;
+            Search::iterative_deepening(board, params, stats);
+            nodes += static_cast<int64_t>(stats.nodes);
+        }
+        return nodes;
+    }
+
+    uint64_t run(const Options& options, PhaseResult* results) {
+        Options opts = options;
+        if (opts.eval == nullptr) opts.eval = Evaluation::evaluate;
+
+        std::vector<BoardState> boards(NUM_POSITIONS);
+        for (int i = 0; i < NUM_POSITIONS; ++i) Game::setup_board(boards[i], POSITIONS[i]);
+
+        measure(results[AttackLookups], [&]() { return attack_lookups(boards); });
+
+        measure(results[Perft], [&]() {
+            int64_t made = 0;
+            for (const BoardState& start : boards) {
+                BoardState board = start;
+                made += perft(board, opts.perft_depth);
+            }
+            return made;
+        });
+        measure(results[PerftCopy], [&]() {
+            int64_t made = 0;
+            for (const Position& start : boards) made += perft_copy(start, opts.perft_depth);
+            return made;
+        });
+
+        std::vector<EvalInput> leaves, found;
+        for (const Position& start : boards) {
+            found.clear();
+            found.reserve(MAX_EVAL_INPUTS);
+            collect_leaves(start, opts.perft_depth, found);
+            leaves.insert(leaves.end(), found.begin(), found.end());
+        }
+        measure(results[EvalCalls], [&]() { return eval_calls(opts.eval, leaves); });
+        measure(results[Searches], [&]() { return searches(boards, opts); });
+        return static_cast<uint64_t>(results[Searches].ops);
+    }
+}
@@ -0,0 +1,147 @@
+#include "DataGen.hpp"
+#include "Evaluation.hpp"
+#include "ThreadPool.hpp"
+#include "Attacks.hpp"
+#include "Zobrist.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace DataGen {
+
+    PackedPosition pack(const BoardState& board, int32_t score, int result) {
+        PackedPosition p{};
+        p.occupancy = board.occupancy[2];
+
+        int n = 0;
+        uint64_t occ = board.occupancy[2];
+        while (occ) {
+            int sq = BitUtil::lsb(occ);
+            occ &= occ - 1;
+            uint8_t piece = 0;
+            for (int i = 0; i < 12; ++i) {
+                if (board.pieces[i] & (1ULL << sq)) { piece = static_cast<uint8_t>(i); break; }
+            }
+            p.pieces[n / 2] |= static_cast<uint8_t>(piece << (4 * (n & 1)));
+            ++n;
+        }
+
+        p.score = static_cast<int16_t>(std::clamp(score, -32767, 32767));
+        p.result = static_cast<uint8_t>(result == Game::WhiteWin ? 2 : result == Game::BlackWin ? 0 : 1);
+        p.stm_castle = static_cast<uint8_t>((board.to_move == Colour::Black ? 1 : 0) | (board.castle_rights << 4));
+        p.en_passant = static_cast<uint8_t>(board.en_passant_sq == Square::None ? 64 : static_cast<int>(board.en_passant_sq));
+        p.half_move_clock = static_cast<uint8_t>(std::min<int>(board.half_move_clock, 255));
+        p.full_move_number = board.full_move_number;
+        return p;
+    }
+
+    void unpack(const PackedPosition& packed, BoardState& board) {
+        board = BoardState();
+
+        int n = 0;
+        uint64_t occ = packed.occupancy;
+        while (occ) {
+            int sq = BitUtil::lsb(occ);
+            occ &= occ - 1;
+            int piece = (packed.pieces[n / 2] >> (4 * (n & 1))) & 0xF;
+            if (piece < 12) board.pieces[piece] |= 1ULL << sq;
+            ++n;
+        }
+        for (int i = 0; i < 6; ++i)  board.occupancy[0] |= board.pieces[i];
+        for (int i = 6; i < 12; ++i) board.occupancy[1] |= board.pieces[i];
+        board.occupancy[2] = board.occupancy[0] | board.occupancy[1];
+
+        board.to_move = (packed.stm_castle & 1) ? Colour::Black : Colour::White;
+        board.castle_rights = packed.stm_castle >> 4;
+        board.en_passant_sq = (packed.en_passant < 64) ? static_cast<Square>(packed.en_passant) : Square::None;
+        board.half_move_clock = packed.half_move_clock;
+        board.full_move_number = packed.full_move_number;
+        board.refresh_hash();
+    }
+
+    // --- GAME -> RECORDS ---
+    // Replays the game and keeps the searched, quiet positions
+    static void collect(const Game::GameResult& game, const Options& options, std::vector<PackedPosition>& out) {
+        BoardState board;
+        Game::setup_board(board, "startpos");
+
+        int first_searched = game.random_plies + game.book_plies;
+        for (size_t ply = 0; ply < game.moves.size(); ++ply) {
+            const Move& m = game.moves[ply];
+            int32_t score = game.scores[ply];
+
+            bool keep = static_cast<int>(ply) >= first_searched
+                        && !m.is_capture() && !m.is_promotion()
+                        && (options.score_limit <= 0 || std::abs(score) <= options.score_limit);
+            if (keep) {
+                Colour them = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+                Square k = Search::find_king(board, board.to_move);
+                keep = !Attacks::is_square_attacked(k, them, board.pieces.data(), board.occupancy[2]);
+            }
+            if (keep) out.push_back(pack(board, score, game.result));
+
+            board.make_move(m);
+        }
+    }
+
+    int64_t generate(Search::EvalCallback eval, const Options& options, const std::string& out_path,
+                     const Game::Adjudication* adjudication, ProgressCallback on_progress) {
+        std::FILE* f = std::fopen(out_path.c_str(), "ab");
+        if (!f) return -1;
+        if (options.games <= 0) {
+            std::fclose(f);
+            return 0;
+        }
+
+        Attacks::init();
+        Zobrist::init();
+
+        std::mutex write_mutex;
+        int64_t games_done = 0;
+        int64_t written = 0;
+        bool write_failed = false;
+
+        auto play_one = [&](int64_t game_id) {
+            Game::GameConfig config;
+            config.white_eval   = eval ? eval : Evaluation::evaluate;
+            config.black_eval   = config.white_eval;
+            config.depth        = options.depth;
+            if (options.nodes == 0 && options.depth <= 0) config.depth = Game::GameConfig().depth;
+            config.max_nodes    = options.nodes;
+            config.max_moves    = options.max_plies;
+            config.hash_mb      = options.hash_mb;
+            config.random_plies = options.random_plies;
+            config.seed         = options.seed + static_cast<uint64_t>(game_id);
+            if (adjudication) config.adjudication = *adjudication;
+
+            Game::GameResult game = Game::play(config);
+
+            std::vector<PackedPosition> records;
+            records.reserve(game.moves.size());
+            collect(game, options, records);
+
+            std::lock_guard<std::mutex> lock(write_mutex);
+            if (!records.empty() && std::fwrite(records.data(), sizeof(PackedPosition), records.size(), f) != records.size())
+                write_failed = true;
+            written += static_cast<int64_t>(records.size());
+            games_done++;
+            if (on_progress) on_progress(games_done, written);
+        };
+
+        int threads = static_cast<int>(std::min<int64_t>(ThreadPool::resolve_thread_count(options.num_threads), options.games));
+        if (threads == 1) {
+            for (int64_t i = 0; i < options.games; ++i) play_one(i);
+        } else {
+            ThreadPool pool(threads);
+            for (int64_t i = 0; i < options.games; ++i) {
+                pool.submit([&, i]() { play_one(i); });
+            }
+            pool.wait_idle();
+        }
+
+        if (std::fclose(f) != 0) write_failed = true;
+        return write_failed ? -1 : written;
+    }
+}
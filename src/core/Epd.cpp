@@ -0,0 +1,293 @@
+#include "Epd.hpp"
+#include "Game.hpp"
+#include "Evaluation.hpp"
+#include "Notation.hpp"
+#include "ThreadPool.hpp"
+#include "Attacks.hpp"
+#include "Zobrist.hpp"
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+namespace Epd {
+
+    // --- PARSING ---
+
+    // Splits "bm Nf3 Qd5; id \"WAC.001\";" into operations, keeping quoted text whole
+    static std::vector<std::vector<std::string>> split_operations(const std::string& ops) {
+        std::vector<std::vector<std::string>> out;
+        std::vector<std::string> current;
+        std::string token;
+        bool quoted = false;
+
+        auto flush_token = [&]() {
+            if (!token.empty()) current.push_back(token);
+            token.clear();
+        };
+        for (char c : ops) {
+            if (quoted) {
+                if (c == '"') { quoted = false; current.push_back(token); token.clear(); }
+                else token += c;
+            } else if (c == '"') {
+                flush_token();
+                quoted = true;
+            } else if (c == ';') {
+                flush_token();
+                if (!current.empty()) out.push_back(std::move(current));
+                current.clear();
+            } else if (c == ' ' || c == '\t' || c == '\r') {
+                flush_token();
+            } else {
+                token += c;
+            }
+        }
+        flush_token();
+        if (!current.empty()) out.push_back(std::move(current));
+        return out;
+    }
+
+    static Move parse_move(BoardState& board, const std::string& text) {
+        Move m = Notation::parse_san(board, text);
+        if (m.raw() == 0) m = Notation::parse_uci(board, text);
+        return m;
+    }
+
+    // false if the line has no usable bm/am, or one of its moves doesn't parse
+    static bool parse_line(const std::string& line, int64_t line_number, EpdEntry& entry) {
+        std::istringstream in(line);
+        std::string fields[4];
+        for (auto& f : fields) {
+            if (!(in >> f)) return false;
+        }
+        std::string rest;
+        std::getline(in, rest);
+
+        std::string half_moves = "0";
+        std::string full_moves = "1";
+        std::vector<std::string> bm, am;
+        entry.id = std::to_string(line_number);
+
+        for (const auto& op : split_operations(rest)) {
+            const std::string& code = op[0];
+            if (code == "bm")         bm.insert(bm.end(), op.begin() + 1, op.end());
+            else if (code == "am")    am.insert(am.end(), op.begin() + 1, op.end());
+            else if (code == "id" && op.size() > 1)   entry.id = op[1];
+            else if (code == "hmvc" && op.size() > 1) half_moves = op[1];
+            else if (code == "fmvn" && op.size() > 1) full_moves = op[1];
+        }
+        if (bm.empty() && am.empty()) return false;
+
+        entry.fen = fields[0] + ' ' + fields[1] + ' ' + fields[2] + ' ' + fields[3]
+                    + ' ' + half_moves + ' ' + full_moves;
+
+        BoardState board;
+        Game::setup_board(board, entry.fen);
+        for (const auto& text : bm) {
+            Move m = parse_move(board, text);
+            if (m.raw() == 0) return false;
+            entry.best_moves.push_back(m);
+        }
+        for (const auto& text : am) {
+            Move m = parse_move(board, text);
+            if (m.raw() == 0) return false;
+            entry.avoid_moves.push_back(m);
+        }
+        return true;
+    }
+
+    int64_t load(const std::string& path, std::vector<EpdEntry>& out, int64_t* skipped) {
+        std::ifstream file(path);
+        if (!file) return -1;
+
+        Attacks::init();
+        Zobrist::init();
+
+        out.clear();
+        int64_t bad = 0;
+        int64_t line_number = 0;
+        std::string line;
+        while (std::getline(file, line)) {
+            ++line_number;
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#') continue;
+
+            EpdEntry entry;
+            if (parse_line(line.substr(start), line_number, entry)) out.push_back(std::move(entry));
+            else ++bad;
+        }
+        if (skipped) *skipped = bad;
+        return static_cast<int64_t>(out.size());
+    }
+
+    // --- RUNNING ---
+
+    static bool contains(const std::vector<Move>& moves, uint16_t raw) {
+        return std::any_of(moves.begin(), moves.end(), [raw](const Move& m) { return m.raw() == raw; });
+    }
+
+    static bool is_answer(const EpdEntry& entry, uint16_t raw) {
+        if (raw == 0) return false;
+        if (!entry.best_moves.empty() && !contains(entry.best_moves, raw)) return false;
+        return !contains(entry.avoid_moves, raw);
+    }
+
+    // Tracks the earliest iteration after which the answer stayed on the board
+    struct SolveTracker {
+        const EpdEntry* entry;
+        PositionResult* result;
+    };
+
+    static void on_iteration(const Search::SearchStats& stats, void* user) {
+        auto& t = *static_cast<SolveTracker*>(user);
+        if (!is_answer(*t.entry, static_cast<uint16_t>(stats.best_move_raw))) {
+            t.result->solve_time_ms = -1;
+        } else if (t.result->solve_time_ms < 0) {
+            t.result->solve_time_ms = stats.time_ms;
+            t.result->solve_nodes = stats.nodes;
+            t.result->solve_depth = stats.depth_reached;
+        }
+    }
+
+    static void run_one(const EpdEntry& entry, Search::EvalCallback eval, const RunOptions& options,
+                        PositionResult& result) {
+        BoardState board;
+        Game::setup_board(board, entry.fen);
+
+        Search::SearchState state(static_cast<size_t>(std::max(options.hash_mb, 0)));
+        SolveTracker tracker{&entry, &result};
+
+        Search::SearchParams params{};
+        params.depth        = options.depth;
+        params.evalFunc     = eval ? eval : Evaluation::evaluate;
+        params.soft_time_ms = options.time_ms;
+        params.hard_time_ms = options.time_ms;
+        params.max_nodes    = options.nodes;
+        params.state        = (options.hash_mb > 0) ? &state : nullptr;
+        params.on_iteration = on_iteration;
+        params.info_user    = &tracker;
+
+        Search::SearchStats stats;
+        result.best_move = Search::iterative_deepening(board, params, stats);
+        result.score   = stats.score;
+        result.depth   = stats.depth_reached;
+        result.nodes   = stats.nodes;
+        result.time_ms = stats.time_ms;
+        result.solved  = is_answer(entry, result.best_move.raw());
+        if (!result.solved) {
+            result.solve_time_ms = -1;
+            result.solve_nodes = 0;
+            result.solve_depth = 0;
+        }
+    }
+
+    int run(const std::vector<EpdEntry>& entries, Search::EvalCallback eval, const RunOptions& options,
+            std::vector<PositionResult>& results, ProgressCallback on_progress) {
+        Attacks::init();
+        Zobrist::init();
+
+        results.assign(entries.size(), PositionResult());
+        if (entries.empty()) return 0;
+
+        std::mutex report_mutex;
+        int solved = 0;
+        auto task = [&](size_t i) {
+            run_one(entries[i], eval, options, results[i]);
+            std::lock_guard<std::mutex> lock(report_mutex);
+            if (results[i].solved) ++solved;
+            if (on_progress) on_progress(static_cast<int>(i), results[i].solved ? 1 : 0);
+        };
+
+        int threads = std::min(ThreadPool::resolve_thread_count(options.num_threads),
+                               static_cast<int>(entries.size()));
+        if (threads == 1) {
+            for (size_t i = 0; i < entries.size(); ++i) task(i);
+            return solved;
+        }
+
+        ThreadPool pool(threads);
+        for (size_t i = 0; i < entries.size(); ++i) {
+            pool.submit([&task, i]() { task(i); });
+        }
+        pool.wait_idle();
+        return solved;
+    }
+
+    // --- REPORTS ---
+
+    static std::string join_uci(const std::vector<Move>& moves) {
+        std::string s;
+        for (const auto& m : moves) {
+            if (!s.empty()) s += ' ';
+            s += Game::move_to_uci(m);
+        }
+        return s;
+    }
+
+    static std::string csv_field(const std::string& s) {
+        if (s.find_first_of(",\"\n") == std::string::npos) return s;
+        std::string q = "\"";
+        for (char c : s) {
+            if (c == '"') q += '"';
+            q += c;
+        }
+        return q + '"';
+    }
+
+    static std::string json_string(const std::string& s) {
+        std::string q = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\') q += '\\';
+            if (static_cast<unsigned char>(c) < 0x20) continue;
+            q += c;
+        }
+        return q + '"';
+    }
+
+    bool write_csv(const std::string& path, const std::vector<EpdEntry>& entries,
+                   const std::vector<PositionResult>& results) {
+        std::ofstream out(path);
+        if (!out) return false;
+
+        out << "id,fen,bm,am,solved,move,score,depth,nodes,time_ms,solve_time_ms,solve_nodes,solve_depth\n";
+        for (size_t i = 0; i < entries.size() && i < results.size(); ++i) {
+            const EpdEntry& e = entries[i];
+            const PositionResult& r = results[i];
+            out << csv_field(e.id) << ',' << e.fen << ','
+                << join_uci(e.best_moves) << ',' << join_uci(e.avoid_moves) << ','
+                << (r.solved ? 1 : 0) << ','
+                << (r.best_move.raw() ? Game::move_to_uci(r.best_move) : "") << ','
+                << r.score << ',' << r.depth << ',' << r.nodes << ',' << r.time_ms << ','
+                << r.solve_time_ms << ',' << r.solve_nodes << ',' << r.solve_depth << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+
+    bool write_json(const std::string& path, const std::vector<EpdEntry>& entries,
+                    const std::vector<PositionResult>& results) {
+        std::ofstream out(path);
+        if (!out) return false;
+
+        out << "[\n";
+        for (size_t i = 0; i < entries.size() && i < results.size(); ++i) {
+            const EpdEntry& e = entries[i];
+            const PositionResult& r = results[i];
+            out << "  {\"id\": " << json_string(e.id)
+                << ", \"fen\": " << json_string(e.fen)
+                << ", \"bm\": " << json_string(join_uci(e.best_moves))
+                << ", \"am\": " << json_string(join_uci(e.avoid_moves))
+                << ", \"solved\": " << (r.solved ? "true" : "false")
+                << ", \"move\": " << json_string(r.best_move.raw() ? Game::move_to_uci(r.best_move) : "")
+                << ", \"score\": " << r.score
+                << ", \"depth\": " << r.depth
+                << ", \"nodes\": " << r.nodes
+                << ", \"time_ms\": " << r.time_ms
+                << ", \"solve_time_ms\": " << r.solve_time_ms
+                << ", \"solve_nodes\": " << r.solve_nodes
+                << ", \"solve_depth\": " << r.solve_depth
+                << "}" << (i + 1 < entries.size() ? "," : "") << "\n";
+        }
+        out << "]\n";
+        return static_cast<bool>(out);
+    }
+}
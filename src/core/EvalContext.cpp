@@ -0,0 +1,144 @@
+#include "EvalContext.hpp"
+#include "Attacks.hpp"
+#include <vector>
+
+namespace Context {
+
+    static constexpr uint64_t FILE_A = 0x0101010101010101ULL;
+
+    // --- PAWN HASH ---
+    // Pawn structure depends on pawn_key alone, so one table per thread serves every eval
+    // and every game on it. A zeroed entry is valid for key 0 (no pawns: all masks empty).
+    struct PawnEntry {
+        uint64_t key;
+        uint64_t pawn_attacks[2];
+        uint64_t passed[2];
+        uint64_t isolated[2];
+        uint64_t doubled[2];
+    };
+
+    static constexpr size_t PAWN_HASH_ENTRIES = 1 << 14;   // ~1.2 MB per thread
+    static thread_local std::vector<PawnEntry> pawn_hash;
+
+    static uint64_t adjacent_files(uint64_t file_mask) {
+        return ((file_mask << 1) & ~FILE_A) | ((file_mask >> 1) & ~(FILE_A << 7));
+    }
+
+    // Squares strictly ahead of sq (from side's point of view) on its own and adjacent files
+    static uint64_t front_span(int sq, int side) {
+        uint64_t files = FILE_A << (sq & 7);
+        files |= adjacent_files(files);
+        int rank = sq >> 3;
+        uint64_t ahead = (side == 0) ? ((rank < 7) ? ~0ULL << ((rank + 1) * 8) : 0)
+                                     : ((rank > 0) ? ~0ULL >> ((8 - rank) * 8) : 0);
+        return files & ahead;
+    }
+
+    static void compute_pawns(const uint64_t* pieces, PawnEntry& e) {
+        for (int side = 0; side < 2; ++side) {
+            uint64_t own = pieces[side * 6];
+            uint64_t enemy = pieces[(side ^ 1) * 6];
+            Colour colour = side == 0 ? Colour::White : Colour::Black;
+            e.pawn_attacks[side] = Attacks::get_pawn_attacks(colour, own);
+            e.passed[side] = e.isolated[side] = e.doubled[side] = 0;
+
+            for (int f = 0; f < 8; ++f) {
+                uint64_t on_file = own & (FILE_A << f);
+                if (!on_file) continue;
+                if (!(own & adjacent_files(FILE_A << f))) e.isolated[side] |= on_file;
+                if (BitUtil::count_bits(on_file) > 1) e.doubled[side] |= on_file;
+            }
+
+            uint64_t bb = own;
+            while (bb) {
+                int sq = static_cast<int>(BitUtil::pop_lsb(bb));
+                if (!(front_span(sq, side) & enemy)) e.passed[side] |= 1ULL << sq;
+            }
+        }
+    }
+
+    // --- PINS ---
+    // Squares strictly between two aligned squares (both as blockers of each other)
+    static uint64_t between(int a, int b, bool diagonal) {
+        uint64_t bit_a = 1ULL << a, bit_b = 1ULL << b;
+        return diagonal ? Attacks::get_bishop_attacks(a, bit_b) & Attacks::get_bishop_attacks(b, bit_a)
+                        : Attacks::get_rook_attacks(a, bit_b) & Attacks::get_rook_attacks(b, bit_a);
+    }
+
+    static uint64_t pinned_pieces(const uint64_t* pieces, const uint64_t* occupancy, int side) {
+        uint64_t king = pieces[side * 6 + 5];
+        if (!king) return 0;
+        int ksq = BitUtil::lsb(king);
+        int them = (side ^ 1) * 6;
+
+        uint64_t pinned = 0;
+        for (int diagonal = 0; diagonal < 2; ++diagonal) {
+            uint64_t sliders = pieces[them + 4] | pieces[them + (diagonal ? 2 : 3)];
+            uint64_t snipers = sliders & (diagonal ? Attacks::get_bishop_attacks(ksq, 0)
+                                                   : Attacks::get_rook_attacks(ksq, 0));
+            while (snipers) {
+                int sq = static_cast<int>(BitUtil::pop_lsb(snipers));
+                uint64_t blockers = between(ksq, sq, diagonal) & occupancy[2];
+                if (BitUtil::count_bits(blockers) == 1) pinned |= blockers & occupancy[side];
+            }
+        }
+        return pinned;
+    }
+
+    void build(const uint64_t* pieces, const uint64_t* occupancy, uint32_t side,
+               uint64_t pawn_key, EvalContext& ctx) {
+        uint64_t occ = occupancy[2];
+
+        // --- ATTACK MAPS ---
+        for (int s = 0; s < 2; ++s) {
+            int base = s * 6;
+            ctx.attacks_by[base] = Attacks::get_pawn_attacks(s == 0 ? Colour::White : Colour::Black, pieces[base]);
+            for (int p = 1; p < 6; ++p) {
+                uint64_t attacks = 0;
+                uint64_t bb = pieces[base + p];
+                while (bb) {
+                    int sq = static_cast<int>(BitUtil::pop_lsb(bb));
+                    switch (p) {
+                        case 1: attacks |= Attacks::KnightAttacks[sq]; break;
+                        case 2: attacks |= Attacks::get_bishop_attacks(sq, occ); break;
+                        case 3: attacks |= Attacks::get_rook_attacks(sq, occ); break;
+                        case 4: attacks |= Attacks::get_queen_attacks(sq, occ); break;
+                        case 5: attacks |= Attacks::KingAttacks[sq]; break;
+                    }
+                }
+                ctx.attacks_by[base + p] = attacks;
+            }
+            ctx.attacks[s] = 0;
+            for (int p = 0; p < 6; ++p) ctx.attacks[s] |= ctx.attacks_by[base + p];
+        }
+
+        // --- CHECKERS / PINS ---
+        int us = static_cast<int>(side & 1);
+        int them = (us ^ 1) * 6;
+        ctx.checkers = 0;
+        if (uint64_t king = pieces[us * 6 + 5]) {
+            int ksq = BitUtil::lsb(king);
+            ctx.checkers = (Attacks::PawnAttacks[us][ksq] & pieces[them])
+                         | (Attacks::KnightAttacks[ksq] & pieces[them + 1])
+                         | (Attacks::get_bishop_attacks(ksq, occ) & (pieces[them + 2] | pieces[them + 4]))
+                         | (Attacks::get_rook_attacks(ksq, occ) & (pieces[them + 3] | pieces[them + 4]));
+        }
+        ctx.pinned[0] = pinned_pieces(pieces, occupancy, 0);
+        ctx.pinned[1] = pinned_pieces(pieces, occupancy, 1);
+
+        // --- PAWN STRUCTURE ---
+        if (pawn_hash.empty()) pawn_hash.assign(PAWN_HASH_ENTRIES, PawnEntry{});
+        PawnEntry& e = pawn_hash[pawn_key & (PAWN_HASH_ENTRIES - 1)];
+        if (e.key != pawn_key) {
+            e.key = pawn_key;
+            compute_pawns(pieces, e);
+        }
+        for (int s = 0; s < 2; ++s) {
+            ctx.pawn_attacks[s] = e.pawn_attacks[s];
+            ctx.passed[s] = e.passed[s];
+            ctx.isolated[s] = e.isolated[s];
+            ctx.doubled[s] = e.doubled[s];
+        }
+        ctx.pawn_key = pawn_key;
+    }
+}
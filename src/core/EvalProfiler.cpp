@@ -0,0 +1,219 @@
+#include "EvalProfiler.hpp"
+#include "EvalContext.hpp"
+#include "Evaluation.hpp"
+#include "FenLoader.hpp"
+#include "MappedFile.hpp"
+#include "ThreadPool.hpp"
+#include "Attacks.hpp"
+#include "Zobrist.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace EvalProfiler {
+
+    // Eval arguments unpacked once, so only the call itself is timed
+    struct EvalInput {
+        uint64_t pieces[12];
+        uint64_t occupancy[3];
+        uint32_t side;
+        uint64_t pawn_key;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    bool load_corpus(const std::string& path, std::vector<DataGen::PackedPosition>& out) {
+        bool packed = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+        if (!packed) {
+            FenLoader::LoadResult loaded;
+            if (!FenLoader::load(path, loaded)) return false;
+            out = std::move(loaded.positions);
+            return true;
+        }
+
+        MappedFile file;
+        if (!file.open(path)) return false;
+        size_t n = file.size() / sizeof(DataGen::PackedPosition);
+        out.resize(n);
+        if (n > 0) std::memcpy(out.data(), file.data(), n * sizeof(DataGen::PackedPosition));
+        return true;
+    }
+
+    // Cost of the two clock reads around each call (median of many back-to-back pairs)
+    static double clock_overhead_ns() {
+        static constexpr int SAMPLES = 2001;
+        std::vector<int64_t> samples(SAMPLES);
+        for (auto& s : samples) {
+            auto t0 = Clock::now();
+            auto t1 = Clock::now();
+            s = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        }
+        std::nth_element(samples.begin(), samples.begin() + SAMPLES / 2, samples.end());
+        return static_cast<double>(samples[SAMPLES / 2]);
+    }
+
+    template <typename T>
+    static T percentile(const std::vector<T>& sorted, double p) {
+        size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(idx, sorted.size() - 1)];
+    }
+
+    // Context evals are timed together with building their EvalContext, as a search pays both
+    static int32_t call(Search::EvalCallback eval, Search::ContextEvalCallback context_eval, const EvalInput& in) {
+        if (context_eval) {
+            EvalContext ctx;
+            Context::build(in.pieces, in.occupancy, in.side, in.pawn_key, ctx);
+            return context_eval(in.pieces, in.occupancy, in.side, &ctx);
+        }
+        return eval(in.pieces, in.occupancy, in.side);
+    }
+
+    static Profile profile_one(Search::EvalCallback eval, const std::vector<EvalInput>& inputs,
+                               int64_t warmup_calls, double overhead_ns, std::vector<int32_t>& scores) {
+        Search::ContextEvalCallback context_eval = Search::context_eval_for(eval);
+        Profile p{};
+        size_t n = inputs.size();
+        scores.assign(n, 0);
+        if (n == 0) return p;
+
+        // --- WARMUP ---
+        // Fills caches and lets JIT-compiled callbacks settle; cycles through the corpus
+        volatile int32_t sink = 0;
+        for (int64_t i = 0; i < warmup_calls; ++i) {
+            const EvalInput& in = inputs[static_cast<size_t>(i) % n];
+            sink = sink + call(eval, context_eval, in);
+        }
+
+        // --- TIMED PASS ---
+        std::vector<double> ns(n);
+        for (size_t i = 0; i < n; ++i) {
+            const EvalInput& in = inputs[i];
+            auto t0 = Clock::now();
+            int32_t s = call(eval, context_eval, in);
+            auto t1 = Clock::now();
+            scores[i] = s;
+            double t = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+            ns[i] = std::max(0.0, t - overhead_ns);
+        }
+
+        double total = 0.0;
+        for (double t : ns) total += t;
+        std::sort(ns.begin(), ns.end());
+
+        p.calls = static_cast<int64_t>(n);
+        p.ns_mean = total / static_cast<double>(n);
+        p.ns_p50 = percentile(ns, 0.50);
+        p.ns_p90 = percentile(ns, 0.90);
+        p.ns_p99 = percentile(ns, 0.99);
+        p.ns_p999 = percentile(ns, 0.999);
+        p.ns_max = ns.back();
+        p.calls_per_sec = (p.ns_mean > 0.0) ? 1e9 / p.ns_mean : 0.0;
+
+        // --- SCORE DISTRIBUTION ---
+        double sum = 0.0, sum_sq = 0.0;
+        for (int32_t s : scores) {
+            sum += s;
+            sum_sq += static_cast<double>(s) * s;
+        }
+        p.score_mean = sum / static_cast<double>(n);
+        p.score_std = std::sqrt(std::max(0.0, sum_sq / static_cast<double>(n) - p.score_mean * p.score_mean));
+
+        std::vector<int32_t> sorted = scores;
+        std::sort(sorted.begin(), sorted.end());
+        p.score_min = sorted.front();
+        p.score_p1 = percentile(sorted, 0.01);
+        p.score_p50 = percentile(sorted, 0.50);
+        p.score_p99 = percentile(sorted, 0.99);
+        p.score_max = sorted.back();
+        return p;
+    }
+
+    static double pearson(const std::vector<int32_t>& a, const std::vector<int32_t>& b) {
+        size_t n = std::min(a.size(), b.size());
+        if (n == 0) return 0.0;
+        double ma = 0.0, mb = 0.0;
+        for (size_t i = 0; i < n; ++i) { ma += a[i]; mb += b[i]; }
+        ma /= static_cast<double>(n);
+        mb /= static_cast<double>(n);
+
+        double cov = 0.0, va = 0.0, vb = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double da = a[i] - ma, db = b[i] - mb;
+            cov += da * db;
+            va += da * da;
+            vb += db * db;
+        }
+        return (va > 0.0 && vb > 0.0) ? cov / std::sqrt(va * vb) : 0.0;
+    }
+
+    static std::vector<EvalInput> unpack_inputs(const std::vector<DataGen::PackedPosition>& positions) {
+        Attacks::init();
+        Zobrist::init();
+        std::vector<EvalInput> inputs(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            BoardState board;
+            DataGen::unpack(positions[i], board);
+            std::copy(board.pieces.begin(), board.pieces.end(), inputs[i].pieces);
+            std::copy(board.occupancy.begin(), board.occupancy.end(), inputs[i].occupancy);
+            inputs[i].side = (board.to_move == Colour::White) ? 0 : 1;
+            inputs[i].pawn_key = board.pawn_key;
+        }
+        return inputs;
+    }
+
+    void run(const std::vector<Search::EvalCallback>& bots,
+             const std::vector<DataGen::PackedPosition>& positions,
+             int64_t warmup_calls, int num_threads,
+             std::vector<Profile>& profiles, std::vector<double>* correlation) {
+        size_t num_bots = bots.size();
+        profiles.assign(num_bots, Profile{});
+        if (correlation) correlation->assign(num_bots * num_bots, 0.0);
+        if (num_bots == 0) return;
+
+        std::vector<EvalInput> inputs = unpack_inputs(positions);
+        double overhead = clock_overhead_ns();
+        std::vector<std::vector<int32_t>> scores(num_bots);
+        auto task = [&](size_t b) {
+            Search::EvalCallback eval = bots[b] ? bots[b] : Evaluation::evaluate;
+            profiles[b] = profile_one(eval, inputs, warmup_calls, overhead, scores[b]);
+        };
+
+        // More threads than cores would time the scheduler rather than the evals
+        int hw = ThreadPool::resolve_thread_count(0);
+        int threads = (num_threads > 0) ? num_threads : hw;
+        threads = std::min({threads, hw, static_cast<int>(num_bots)});
+        if (threads == 1) {
+            for (size_t b = 0; b < num_bots; ++b) task(b);
+        } else {
+            ThreadPool pool(threads);
+            for (size_t b = 0; b < num_bots; ++b) pool.submit([&task, b]() { task(b); });
+            pool.wait_idle();
+        }
+
+        if (correlation) {
+            for (size_t a = 0; a < num_bots; ++a) {
+                for (size_t b = 0; b < num_bots; ++b) {
+                    (*correlation)[a * num_bots + b] = (a == b) ? 1.0 : pearson(scores[a], scores[b]);
+                }
+            }
+        }
+    }
+
+    int32_t calibrate_lazy_margin(Search::EvalCallback eval,
+                                  const std::vector<DataGen::PackedPosition>& positions, double coverage) {
+        if (!eval || positions.empty()) return -1;
+        std::vector<EvalInput> inputs = unpack_inputs(positions);
+        Search::ContextEvalCallback context_eval = Search::context_eval_for(eval);
+
+        std::vector<int64_t> gaps(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            int64_t bot = call(eval, context_eval, inputs[i]);
+            int64_t pesto = Evaluation::evaluate(inputs[i].pieces, inputs[i].occupancy, inputs[i].side);
+            gaps[i] = std::abs(bot - pesto);
+        }
+        std::sort(gaps.begin(), gaps.end());
+        int64_t margin = percentile(gaps, std::clamp(coverage, 0.0, 1.0));
+        return static_cast<int32_t>(std::min<int64_t>(margin, INT32_MAX));
+    }
+}
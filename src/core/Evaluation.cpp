@@ -93,8 +93,8 @@ namespace Evaluation {
     const int phase_weights[6] = { 0, 1, 1, 2, 4, 0 };
 
     // Helper: Reconstruct board for check detection
-    BoardState reconstruct_board(const uint64_t* pieces, const uint64_t* occupancy, uint32_t moveCount) {
-        BoardState board;
+    Position reconstruct_board(const uint64_t* pieces, const uint64_t* occupancy, uint32_t moveCount) {
+        Position board;
         for(int i=0; i<12; ++i) board.pieces[i] = pieces[i];
         for(int i=0; i<3; ++i) board.occupancy[i] = occupancy[i];
         board.to_move = (moveCount % 2 == 0) ? Colour::White : Colour::Black;
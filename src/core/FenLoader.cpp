@@ -0,0 +1,170 @@
+#include "FenLoader.hpp"
+#include "Game.hpp"
+#include "MappedFile.hpp"
+#include "ThreadPool.hpp"
+#include "Attacks.hpp"
+#include "Zobrist.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace FenLoader {
+
+    // --- LABELS ---
+
+    static std::string_view trim(std::string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '\r')) s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+        return s;
+    }
+
+    // Text after the first n whitespace-separated fields
+    static std::string_view skip_fields(std::string_view s, int n) {
+        size_t pos = 0;
+        for (int i = 0; i < n; ++i) {
+            while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t')) ++pos;
+            while (pos < s.size() && s[pos] != ' ' && s[pos] != '\t') ++pos;
+        }
+        return s.substr(pos);
+    }
+
+    // "1-0" / "1.0" -> WhiteWin, "0-1" / "0.0" -> BlackWin, "1/2-1/2" / "0.5" -> Draw; else MaxMoves
+    static int result_from_text(std::string_view s) {
+        s = trim(s);
+        if (s.size() >= 2 && s.front() == '"' && s.back() == '"') s = s.substr(1, s.size() - 2);
+        if (s == "1-0" || s == "1.0" || s == "1")   return Game::WhiteWin;
+        if (s == "0-1" || s == "0.0" || s == "0")   return Game::BlackWin;
+        if (s == "1/2-1/2" || s == "0.5" || s == "1/2") return Game::Draw;
+        return Game::MaxMoves;
+    }
+
+    static void parse_labels(std::string_view rest, int32_t& score, int& result) {
+        size_t open = rest.find('[');
+        if (open != std::string_view::npos) {
+            size_t close = rest.find(']', open);
+            if (close != std::string_view::npos) {
+                result = result_from_text(rest.substr(open + 1, close - open - 1));
+                rest = rest.substr(0, open);
+            }
+        }
+
+        while (!rest.empty()) {
+            size_t end = rest.find(';');
+            std::string_view op = trim(rest.substr(0, end));
+            rest = (end == std::string_view::npos) ? std::string_view() : rest.substr(end + 1);
+
+            if (op.size() > 3 && op.substr(0, 3) == "ce ") {
+                std::string_view v = trim(op.substr(3));
+                int32_t cp = 0;
+                if (std::from_chars(v.data(), v.data() + v.size(), cp).ec == std::errc()) score = cp;
+            } else if (op.size() > 3 && op.substr(0, 3) == "c9 ") {
+                result = result_from_text(op.substr(3));
+            }
+        }
+    }
+
+    // --- PARSING ---
+
+    bool parse_line(std::string_view line, BoardState& scratch, DataGen::PackedPosition& out,
+                    const char*& reason) {
+        if (!scratch.load_fen(line)) {
+            reason = "malformed FEN";
+            return false;
+        }
+        if (BitUtil::count_bits(scratch.pieces[5]) != 1 || BitUtil::count_bits(scratch.pieces[11]) != 1) {
+            reason = "each side needs exactly one king";
+            return false;
+        }
+        if (BitUtil::count_bits(scratch.occupancy[2]) > 32) {
+            reason = "more than 32 pieces";
+            return false;
+        }
+
+        int32_t score = 0;
+        int result = Game::MaxMoves;
+        parse_labels(skip_fields(line, 4), score, result);
+
+        out = DataGen::pack(scratch, score, result);
+        if (result == Game::MaxMoves) out.result = DataGen::RESULT_UNKNOWN;
+        return true;
+    }
+
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        std::vector<DataGen::PackedPosition> positions;
+        std::vector<LineError> errors;     // Line numbers relative to the chunk (0-based)
+        int64_t lines = 0;
+    };
+
+    static void parse_chunk(Chunk& chunk) {
+        BoardState scratch;
+        const char* p = chunk.begin;
+        while (p < chunk.end) {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+            const char* line_end = nl ? nl : chunk.end;
+            std::string_view line = trim(std::string_view(p, line_end - p));
+
+            if (!line.empty() && line.front() != '#') {
+                DataGen::PackedPosition packed;
+                const char* reason = nullptr;
+                if (parse_line(line, scratch, packed, reason)) chunk.positions.push_back(packed);
+                else chunk.errors.push_back({chunk.lines, reason});
+            }
+            chunk.lines++;
+            p = line_end + 1;
+        }
+    }
+
+    bool load(const std::string& path, LoadResult& out, int num_threads) {
+        MappedFile file;
+        if (!file.open(path)) return false;
+
+        Attacks::init();
+        Zobrist::init();
+
+        out.positions.clear();
+        out.errors.clear();
+        out.lines = 0;
+        if (file.size() == 0) return true;
+
+        // Several chunks per thread so uneven lines still balance; boundaries move to the next line
+        static constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+        int threads = ThreadPool::resolve_thread_count(num_threads);
+        size_t want = std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(threads) * 4,
+                                                           file.size() / MIN_CHUNK_BYTES));
+
+        const char* data = file.data();
+        const char* data_end = data + file.size();
+        std::vector<Chunk> chunks;
+        const char* begin = data;
+        for (size_t i = 1; i <= want && begin < data_end; ++i) {
+            const char* end = (i == want) ? data_end : data + file.size() * i / want;
+            if (end < begin) end = begin;
+            if (end < data_end) {
+                const char* nl = static_cast<const char*>(std::memchr(end, '\n', data_end - end));
+                end = nl ? nl + 1 : data_end;
+            }
+            chunks.push_back({begin, end, {}, {}, 0});
+            begin = end;
+        }
+
+        if (threads == 1 || chunks.size() == 1) {
+            for (auto& c : chunks) parse_chunk(c);
+        } else {
+            ThreadPool pool(std::min(threads, static_cast<int>(chunks.size())));
+            for (auto& c : chunks) pool.submit([&c]() { parse_chunk(c); });
+            pool.wait_idle();
+        }
+
+        size_t total = 0;
+        for (const auto& c : chunks) total += c.positions.size();
+        out.positions.reserve(total);
+        for (auto& c : chunks) {
+            out.positions.insert(out.positions.end(), c.positions.begin(), c.positions.end());
+            for (const auto& e : c.errors) out.errors.push_back({out.lines + e.line + 1, e.reason});
+            out.lines += c.lines;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,259 @@
+#include "Game.hpp"
+#include "MoveGen.hpp"
+#include "Attacks.hpp"
+#include "Tablebase.hpp"
+#include "Notation.hpp"
+#include "Trace.hpp"
+#include <vector>
+#include <chrono>
+
+namespace Game {
+
+    // Stand-in for a missing callback, matching the old dispatcher's behaviour
+    static int32_t null_eval(const uint64_t*, const uint64_t*, uint32_t) { return 0; }
+
+    void setup_board(BoardState& board, const std::string& fen) {
+        if (fen.empty() || fen == "startpos") {
+            board = BoardState();
+            board.pieces[0]  = 0x000000000000FF00ULL; board.pieces[6]  = 0x00FF000000000000ULL;
+            board.pieces[1]  = 0x0000000000000042ULL; board.pieces[7]  = 0x4200000000000000ULL;
+            board.pieces[2]  = 0x0000000000000024ULL; board.pieces[8]  = 0x2400000000000000ULL;
+            board.pieces[3]  = 0x0000000000000081ULL; board.pieces[9]  = 0x8100000000000000ULL;
+            board.pieces[4]  = 0x0000000000000008ULL; board.pieces[10] = 0x0800000000000000ULL;
+            board.pieces[5]  = 0x0000000000000010ULL; board.pieces[11] = 0x1000000000000000ULL;
+            board.occupancy[0] = 0ULL; board.occupancy[1] = 0ULL;
+            for (int i = 0;  i < 6;  ++i) board.occupancy[0] |= board.pieces[i];
+            for (int i = 6;  i < 12; ++i) board.occupancy[1] |= board.pieces[i];
+            board.occupancy[2] = board.occupancy[0] | board.occupancy[1];
+            board.to_move = Colour::White;
+            board.castle_rights = 0b1111;
+            board.full_move_number = 1;
+            board.refresh_hash();
+        } else {
+            board.load_fen(fen);
+        }
+    }
+
+    bool has_legal_move(BoardState& board) {
+        std::vector<Move> all_moves;
+        MoveGen::generate_moves(board, all_moves);
+
+        for (const auto& m : all_moves) {
+            board.make_move(m);
+            Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+            Square k = Search::find_king(board, us);
+            bool illegal = Attacks::is_square_attacked(
+                k, board.to_move, board.pieces.data(), board.occupancy[2]);
+            board.undo_move(m);
+            if (!illegal) return true;
+        }
+        return false;
+    }
+
+    std::string move_to_uci(const Move& m) {
+        int from = static_cast<int>(m.from());
+        int to   = static_cast<int>(m.to());
+        char buf[6];
+        buf[0] = 'a' + (from % 8);
+        buf[1] = '1' + (from / 8);
+        buf[2] = 'a' + (to % 8);
+        buf[3] = '1' + (to / 8);
+        int len = 4;
+        if (m.is_promotion()) {
+            if      (m.is_promo_queen())  buf[4] = 'q';
+            else if (m.is_promo_rook())   buf[4] = 'r';
+            else if (m.is_promo_bishop()) buf[4] = 'b';
+            else if (m.is_promo_knight()) buf[4] = 'n';
+            len = 5;
+        }
+        buf[len] = '\0';
+        return std::string(buf);
+    }
+
+    Runner::Runner(const GameConfig& game_config)
+        : config(game_config),
+          states{Search::SearchState(game_config.hash_mb), Search::SearchState(game_config.hash_mb)} {
+        setup_board(board, config.fen);
+
+        out.moves.reserve(config.max_moves > 0 ? config.max_moves : 0);
+        out.move_times_ms.reserve(config.max_moves > 0 ? config.max_moves : 0);
+        out.scores.reserve(config.max_moves > 0 ? config.max_moves : 0);
+
+        clock_ms[0] = config.time_control[0].base_ms;
+        clock_ms[1] = config.time_control[1].base_ms;
+        rng = config.seed;
+        in_book = (config.book != nullptr && config.book->is_open());
+        if (Trace::enabled()) trace_game_start = Trace::now_ns();
+    }
+
+    void Runner::finish(int result, int termination) {
+        out.result = result;
+        out.termination = termination;
+        out.plies = static_cast<int>(out.moves.size());
+        for (int s = 0; s < 2; ++s) {
+            out.clock_left_ms[s] = (config.time_control[s].base_ms > 0) ? clock_ms[s] : 0;
+        }
+        finished = true;
+        if (trace_game_start >= 0) {
+            Trace::complete("game", "game", trace_game_start, {"result", result},
+                            {"termination", termination}, {"plies", out.plies});
+        }
+    }
+
+    bool Runner::next() {
+        for (; !finished && move_num < config.max_moves; ++move_num) {
+            if (board.is_draw()) {
+                if (board.half_move_clock >= 100) finish(Draw, FiftyMove);
+                else if (board.insufficient_material()) finish(Draw, InsufficientMaterial);
+                else finish(Draw, Repetition);
+                return false;
+            }
+
+            if (!has_legal_move(board)) {
+                Colour us   = board.to_move;
+                Colour them = (us == Colour::White) ? Colour::Black : Colour::White;
+                Square k    = Search::find_king(board, us);
+                if (Attacks::is_square_attacked(k, them, board.pieces.data(), board.occupancy[2]))
+                    finish((us == Colour::White) ? BlackWin : WhiteWin, Checkmate);
+                else
+                    finish(Draw, Stalemate);
+                return false;
+            }
+
+            side = (board.to_move == Colour::White) ? 0 : 1;
+
+            // Cursed wins and blessed losses are draws under the fifty-move rule
+            if (Tablebase::PROBES_VERIFIED && config.adjudication.tablebase && board.castle_rights == 0
+                && BitUtil::count_bits(board.occupancy[2]) <= Tablebase::max_pieces()) {
+                Tablebase::ProbeState state;
+                Tablebase::WDL wdl = Tablebase::probe_wdl(board, state);
+                if (state != Tablebase::Fail) {
+                    if (wdl == Tablebase::Win)       finish(side == 0 ? WhiteWin : BlackWin, TablebaseAdjudicated);
+                    else if (wdl == Tablebase::Loss) finish(side == 0 ? BlackWin : WhiteWin, TablebaseAdjudicated);
+                    else                             finish(Draw, TablebaseAdjudicated);
+                    return false;
+                }
+            }
+
+            // --- RANDOM OPENING ---
+            // Free moves like book moves; used to diversify self-play games
+            if (move_num < config.random_plies) {
+                std::vector<Move> moves;
+                Notation::legal_moves(board, moves);
+                Move m = moves[BitUtil::splitmix64(rng) % moves.size()];
+                board.make_move(m);
+                out.moves.push_back(m);
+                out.move_times_ms.push_back(0);
+                out.scores.push_back(0);
+                out.random_plies++;
+                if (Trace::enabled()) Trace::instant("random move", "game", {"ply", move_num}, {}, m.raw());
+                if (config.time_control[side].base_ms > 0) clock_ms[side] += config.time_control[side].increment_ms;
+                continue;
+            }
+
+            // --- BOOK ---
+            // Book moves are free: no search, no clock used, increment still earned
+            if (in_book) {
+                if (config.book_plies > 0 && move_num >= config.book_plies) in_book = false;
+                Move book_move = in_book ? config.book->pick(board, rng) : Move();
+                if (book_move.raw() != 0) {
+                    board.make_move(book_move);
+                    out.moves.push_back(book_move);
+                    out.move_times_ms.push_back(0);
+                    out.scores.push_back(0);
+                    out.book_plies++;
+                    if (Trace::enabled()) Trace::instant("book move", "game", {"ply", move_num}, {}, book_move.raw());
+                    if (config.time_control[side].base_ms > 0) clock_ms[side] += config.time_control[side].increment_ms;
+                    continue;
+                }
+                in_book = false;    // Once out of book, stay out
+            }
+
+            params = Search::SearchParams();
+            params.depth    = config.depth;
+            params.evalFunc = (side == 0) ? config.white_eval : config.black_eval;
+            if (!params.evalFunc) params.evalFunc = null_eval;
+            if (config.hash_mb > 0) params.state = &states[side];
+            params.max_nodes = config.max_nodes;
+
+            const TimeControl& tc = config.time_control[side];
+            if (tc.base_ms > 0) Search::allocate_time(clock_ms[side], tc.increment_ms, 0, params);
+
+            search_start = std::chrono::steady_clock::now();
+            trace_move_start = Trace::enabled() ? Trace::now_ns() : -1;
+            return true;
+        }
+
+        if (!finished) finish(MaxMoves, MoveLimit);
+        return false;
+    }
+
+    void Runner::play(Move best, const Search::SearchStats& stats) {
+        int64_t spent = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - search_start).count();
+        if (trace_move_start >= 0) {
+            Trace::complete("move", "game", trace_move_start, {"ply", move_num},
+                            {"nodes", static_cast<int64_t>(stats.nodes)}, {"score", stats.score}, best.raw());
+        }
+
+        out.nodes[side] += stats.nodes;
+        out.time_used_ms[side] += spent;
+        if (spent > out.max_move_ms[side]) out.max_move_ms[side] = spent;
+
+        const TimeControl& tc = config.time_control[side];
+        if (tc.base_ms > 0) {
+            clock_ms[side] -= spent;
+            if (clock_ms[side] < 0) {
+                // Flagging against a bare opponent who can't mate is still a draw
+                BoardState winner_only = board;
+                int loser = side * 6;
+                for (int p = loser; p < loser + 5; ++p) winner_only.pieces[p] = 0;
+                if (winner_only.insufficient_material()) finish(Draw, TimeForfeit);
+                else finish((side == 0) ? BlackWin : WhiteWin, TimeForfeit);
+                return;
+            }
+            clock_ms[side] += tc.increment_ms;
+        }
+
+        if (best.raw() == 0) {
+            finish(Draw, NoMove);
+            return;
+        }
+
+        board.make_move(best);
+        out.moves.push_back(best);
+        out.move_times_ms.push_back(static_cast<int32_t>(spent));
+        out.scores.push_back(stats.score);
+        ++move_num;
+
+        // --- ADJUDICATION ---
+        const Adjudication& adj = config.adjudication;
+        int32_t white_score = (side == 0) ? stats.score : -stats.score;
+
+        if (adj.resign_score > 0 && adj.resign_moves > 0) {
+            int sign = (white_score >= adj.resign_score) ? 1 : (white_score <= -adj.resign_score) ? -1 : 0;
+            resign_streak = (sign != 0 && sign == resign_sign) ? resign_streak + 1 : (sign != 0 ? 1 : 0);
+            resign_sign = sign;
+            if (resign_streak >= 2 * adj.resign_moves) {
+                finish(sign > 0 ? WhiteWin : BlackWin, AdjudicatedWin);
+                return;
+            }
+        }
+
+        if (adj.draw_moves > 0 && board.full_move_number >= adj.draw_move_number) {
+            bool level = (white_score >= -adj.draw_score && white_score <= adj.draw_score);
+            draw_streak = level ? draw_streak + 1 : 0;
+            if (draw_streak >= 2 * adj.draw_moves) finish(Draw, AdjudicatedDraw);
+        }
+    }
+
+    GameResult play(const GameConfig& config) {
+        Runner game(config);
+        while (game.next()) {
+            Search::SearchStats stats;
+            Move best = Search::iterative_deepening(game.board, game.params, stats);
+            game.play(best, stats);
+        }
+        return game.result();
+    }
+}
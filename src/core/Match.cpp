@@ -0,0 +1,119 @@
+#include "Match.hpp"
+#include "Game.hpp"
+#include "Batch.hpp"
+#include "ThreadPool.hpp"
+#include "Attacks.hpp"
+#include "Zobrist.hpp"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace Match {
+
+    struct JobSettings {
+        int depth;
+        int max_moves;
+        Game::Adjudication adjudication;
+        const Book::OpeningBook* book;
+        int book_plies;
+    };
+
+    static Game::GameConfig make_config(const MatchJob& job, const JobSettings& s, uint64_t seed) {
+        Game::GameConfig config;
+        config.white_eval = job.white;
+        config.black_eval = job.black;
+        config.depth      = s.depth;
+        config.max_moves  = s.max_moves;
+        config.fen        = (job.fen != nullptr) ? std::string(job.fen) : "startpos";
+        config.time_control[0] = {job.white_base_ms, job.white_increment_ms};
+        config.time_control[1] = {job.black_base_ms, job.black_increment_ms};
+        config.adjudication    = s.adjudication;
+        config.book            = s.book;
+        config.book_plies      = s.book_plies;
+        config.seed            = seed;
+        return config;
+    }
+
+    static void fill_result(const Game::GameResult& game, MatchResult& out) {
+        out.result      = game.result;
+        out.termination = game.termination;
+        out.plies       = game.plies;
+        out.book_plies  = game.book_plies;
+        out.white_nodes = game.nodes[0];
+        out.black_nodes = game.nodes[1];
+        out.white_time_ms       = game.time_used_ms[0];
+        out.black_time_ms       = game.time_used_ms[1];
+        out.white_max_move_ms   = game.max_move_ms[0];
+        out.black_max_move_ms   = game.max_move_ms[1];
+        out.white_clock_left_ms = game.clock_left_ms[0];
+        out.black_clock_left_ms = game.clock_left_ms[1];
+        out.uci_moves_length  = 0;
+        out.move_times_length = 0;
+
+        if (out.move_times_ms != nullptr && out.move_times_capacity > 0) {
+            int n = std::min(out.move_times_capacity, static_cast<int>(game.move_times_ms.size()));
+            std::copy(game.move_times_ms.begin(), game.move_times_ms.begin() + n, out.move_times_ms);
+            out.move_times_length = n;
+        }
+
+        // Space-separated UCI list, truncated at a move boundary if the buffer is short
+        if (out.uci_moves != nullptr && out.uci_moves_capacity > 0) {
+            int len = 0;
+            for (const auto& m : game.moves) {
+                std::string uci = Game::move_to_uci(m);
+                int needed = static_cast<int>(uci.size()) + (len > 0 ? 1 : 0);
+                if (len + needed >= out.uci_moves_capacity) break;
+                if (len > 0) out.uci_moves[len++] = ' ';
+                std::memcpy(out.uci_moves + len, uci.data(), uci.size());
+                len += static_cast<int>(uci.size());
+            }
+            out.uci_moves[len] = '\0';
+            out.uci_moves_length = len;
+        }
+    }
+
+    static void play_job(const MatchJob& job, MatchResult& out, const JobSettings& s, uint64_t seed) {
+        fill_result(Game::play(make_config(job, s, seed)), out);
+    }
+
+    int run(const MatchJob* jobs, MatchResult* results, int num_jobs,
+            int depth, int max_moves, int num_threads,
+            const Game::Adjudication& adjudication,
+            const Book::OpeningBook* book, int book_plies) {
+        if (num_jobs <= 0) return 0;
+
+        Attacks::init();
+        Zobrist::init();
+
+        JobSettings settings{depth, max_moves, adjudication, book, book_plies};
+
+        int threads = std::min(ThreadPool::resolve_thread_count(num_threads), num_jobs);
+        if (threads == 1) {
+            for (int i = 0; i < num_jobs; ++i) play_job(jobs[i], results[i], settings, i);
+            return num_jobs;
+        }
+
+        ThreadPool pool(threads);
+        for (int i = 0; i < num_jobs; ++i) {
+            pool.submit([&, i]() { play_job(jobs[i], results[i], settings, i); });
+        }
+        pool.wait_idle();
+        return num_jobs;
+    }
+
+    int run_batched(const MatchJob* jobs, MatchResult* results, int num_jobs,
+                    int depth, int max_moves, int max_active,
+                    const Game::Adjudication& adjudication,
+                    const Book::OpeningBook* book, int book_plies, Batch::Stats* stats) {
+        if (num_jobs <= 0) return 0;
+
+        JobSettings settings{depth, max_moves, adjudication, book, book_plies};
+        std::vector<Game::GameConfig> configs;
+        configs.reserve(num_jobs);
+        for (int i = 0; i < num_jobs; ++i) configs.push_back(make_config(jobs[i], settings, i));
+
+        std::vector<Game::GameResult> games = Batch::play(configs, max_active, stats);
+        for (int i = 0; i < num_jobs; ++i) fill_result(games[i], results[i]);
+        return num_jobs;
+    }
+}
@@ -0,0 +1,335 @@
+#include "MateSolver.hpp"
+#include "MoveGen.hpp"
+#include "Attacks.hpp"
+#include "Search.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+
+namespace MateSolver {
+
+    // Proof / disproof numbers: the number of leaves that still have to be shown mated
+    // (resp. escaping) to prove (resp. disprove) a node. INF marks a settled node; sums stop
+    // just short of it so a large unsettled tree never looks settled.
+    static constexpr uint32_t INF = 1u << 30;
+    static constexpr int16_t NO_PROOF = INT16_MAX;
+
+    static uint32_t add(uint32_t a, uint32_t b) {
+        return std::min<uint32_t>(a + b, INF - 1);
+    }
+
+    // --- TRANSPOSITION TABLE ---
+    // One entry per position holds everything learned about it at any remaining depth:
+    // a proof of length L holds at every depth >= L, a disproof at depth r at every depth
+    // <= r, and pn/dn of an unsettled search only at the depth they were computed for.
+    struct Entry {
+        uint64_t key = 0;
+        uint32_t pn = 1;
+        uint32_t dn = 1;
+        uint32_t work = 0;              // Nodes spent below this entry (replacement priority)
+        int16_t rem = -1;               // Depth pn/dn belong to
+        int16_t proof_len = NO_PROOF;   // Plies to mate, if proven
+        int16_t disproof_rem = -1;      // Deepest depth proven to hold no mate
+    };
+
+    struct Values {
+        uint32_t pn = 1;
+        uint32_t dn = 1;
+        int proof_len = NO_PROOF;
+    };
+
+    // Candidate move of an expanded node and the key it leads to
+    struct Child {
+        Move move;
+        uint64_t key;
+        bool check;     // Gives check (children of attacker nodes only)
+    };
+
+    class Solver {
+    public:
+        Solver(BoardState& b, const Options& options) : board(b), opts(options) {
+            size_t bytes = std::max<size_t>(options.hash_mb, 1) * 1024 * 1024;
+            size_t count = 1;
+            while (count * 2 * sizeof(Entry) <= bytes) count *= 2;
+            tt.assign(count, Entry());
+            attacker = board.to_move;
+        }
+
+        // Runs df-pn from the root with rem plies left until it settles or is aborted
+        Values solve_root(int rem) {
+            Values v;
+            while (!aborted) {
+                v = mid(rem, 0, INF, INF);
+                if (v.pn == 0 || v.dn == 0) break;
+            }
+            return v;
+        }
+
+        // Walks the proof from the root: the quickest mate for the attacker, the longest
+        // resistance for the defender. Subtrees lost from the TT are proven again.
+        void extract_pv(int rem, std::vector<Move>& pv) {
+            std::vector<Move> line;
+            while (!aborted && rem > 0) {
+                std::vector<Child>& children = expand(static_cast<int>(line.size()), rem);
+                if (children.empty()) break;
+                bool attacker_node = board.to_move == attacker;
+
+                Move best;
+                int best_len = attacker_node ? INT_MAX : -1;
+                for (const Child& c : children) {
+                    Values cv = lookup(c.key, rem - 1);
+                    if (cv.pn != 0) {
+                        if (attacker_node) continue;
+                        board.make_move(c.move);
+                        cv = prove(rem - 1, static_cast<int>(line.size()) + 1);
+                        board.undo_move(c.move);
+                        if (cv.pn != 0) { best = Move(); break; }
+                    }
+                    if (attacker_node ? cv.proof_len < best_len : cv.proof_len > best_len) {
+                        best = c.move;
+                        best_len = cv.proof_len;
+                    }
+                }
+                if (best.raw() == 0 && attacker_node) {
+                    // Every proven child was evicted: prove this node again
+                    if (prove(rem, static_cast<int>(line.size())).pn != 0) break;
+                    continue;
+                }
+                if (best.raw() == 0) break;
+
+                line.push_back(best);
+                board.make_move(best);
+                rem = best_len;
+            }
+            for (auto it = line.rbegin(); it != line.rend(); ++it) board.undo_move(*it);
+            pv = line;
+        }
+
+        uint64_t nodes = 0;
+        bool aborted = false;
+
+    private:
+        BoardState& board;
+        Options opts;
+        Colour attacker;
+        std::vector<Entry> tt;
+        std::vector<Move> move_buffers[MAX_MOVES * 2 + 1];
+        std::vector<Child> child_buffers[MAX_MOVES * 2 + 1];
+
+        Entry* slot(uint64_t key) {
+            size_t i = static_cast<size_t>(key) & (tt.size() - 2);
+            if (tt[i].key == key) return &tt[i];
+            if (tt[i + 1].key == key) return &tt[i + 1];
+            return nullptr;
+        }
+
+        Values lookup(uint64_t key, int rem) {
+            Values v;
+            Entry* e = slot(key);
+            if (e == nullptr) return v;
+            if (e->proof_len <= rem) {
+                v.pn = 0; v.dn = INF; v.proof_len = e->proof_len;
+            } else if (e->disproof_rem >= rem) {
+                v.pn = INF; v.dn = 0;
+            } else if (e->rem == rem) {
+                v.pn = e->pn; v.dn = e->dn;
+            }
+            return v;
+        }
+
+        void store(uint64_t key, int rem, const Values& v, uint64_t work) {
+            Entry* e = slot(key);
+            if (e == nullptr) {
+                // Two-way bucket: keep the entry that cost more to compute
+                size_t i = static_cast<size_t>(key) & (tt.size() - 2);
+                e = (tt[i].work <= tt[i + 1].work) ? &tt[i] : &tt[i + 1];
+                *e = Entry();
+                e->key = key;
+            }
+            e->work = static_cast<uint32_t>(std::min<uint64_t>(e->work + work, UINT32_MAX));
+            if (v.pn == 0) {
+                e->proof_len = static_cast<int16_t>(std::min<int>(e->proof_len, v.proof_len));
+            } else if (v.dn == 0) {
+                e->disproof_rem = static_cast<int16_t>(std::max<int>(e->disproof_rem, rem));
+            } else {
+                e->rem = static_cast<int16_t>(rem);
+                e->pn = v.pn;
+                e->dn = v.dn;
+            }
+        }
+
+        bool in_check() const {
+            Colour them = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+            return Attacks::is_square_attacked(Search::find_king(board, board.to_move), them,
+                                               board.pieces.data(), board.occupancy[2]);
+        }
+
+        // Legal moves of the current position, with the keys they lead to. With one ply
+        // left the attacker can only mate with a check, so quiet moves are dropped.
+        std::vector<Child>& expand(int ply, int rem) {
+            std::vector<Move>& moves = move_buffers[ply];
+            std::vector<Child>& children = child_buffers[ply];
+            moves.clear();
+            children.clear();
+            MoveGen::generate_moves(board, moves);
+
+            bool attacker_node = board.to_move == attacker;
+            for (const Move& m : moves) {
+                board.make_move(m);
+                Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+                bool legal = !Attacks::is_square_attacked(Search::find_king(board, us), board.to_move,
+                                                          board.pieces.data(), board.occupancy[2]);
+                bool check = legal && attacker_node && in_check();
+                uint64_t key = board.key;
+                board.undo_move(m);
+
+                if (!legal) continue;
+                if (attacker_node && rem == 1 && !check) continue;
+                children.push_back({m, key, check});
+            }
+            return children;
+        }
+
+        // Re-proves the current position (PV extraction after TT losses)
+        Values prove(int rem, int ply) {
+            Values v = lookup(board.key, rem);
+            while (!aborted && v.pn != 0 && v.dn != 0) v = mid(rem, ply, INF, INF);
+            return v;
+        }
+
+        // Multiple iterative deepening: expands the current position until its proof
+        // number reaches thpn or its disproof number reaches thdn
+        Values mid(int rem, int ply, uint32_t thpn, uint32_t thdn) {
+            Values v;
+            if (opts.node_budget != 0 && nodes >= opts.node_budget) aborted = true;
+            if (opts.stop != nullptr && (nodes & 1023) == 0 && opts.stop->load(std::memory_order_relaxed)) aborted = true;
+            if (aborted) return v;
+            ++nodes;
+            uint64_t nodes_before = nodes;
+
+            bool attacker_node = board.to_move == attacker;
+
+            // Out of plies: only a mate that has already happened counts
+            if (rem == 0 && !in_check()) {
+                v.pn = INF; v.dn = 0;
+                store(board.key, rem, v, 1);
+                return v;
+            }
+
+            std::vector<Child>& children = expand(ply, rem);
+            if (children.empty()) {
+                // Attacker stuck (or no checks left), stalemate, or the defender is mated
+                if (!attacker_node && in_check()) {
+                    v.pn = 0; v.dn = INF; v.proof_len = 0;
+                } else {
+                    v.pn = INF; v.dn = 0;
+                }
+                store(board.key, rem, v, 1);
+                return v;
+            }
+            if (rem == 0) {
+                // Defender in check with a way out
+                v.pn = INF; v.dn = 0;
+                store(board.key, rem, v, 1);
+                return v;
+            }
+
+            while (true) {
+                // Gather the children's numbers. At attacker nodes pn is the smallest child pn
+                // and dn the sum; defender nodes are the mirror image.
+                uint32_t pn = attacker_node ? INF : 0;
+                uint32_t dn = attacker_node ? 0 : INF;
+                uint32_t second = INF;      // Runner-up to the best child's deciding number
+                size_t best = 0;
+                Values best_values;
+                int proof_len = attacker_node ? NO_PROOF : 0;
+
+                for (size_t i = 0; i < children.size(); ++i) {
+                    Values cv = lookup(children[i].key, rem - 1);
+                    if (cv.pn == 1 && cv.dn == 1 && attacker_node && !children[i].check) {
+                        cv.pn = 2;      // Unexplored quiet move: checks are likelier to mate
+                    }
+                    if (attacker_node) {
+                        dn = add(dn, cv.dn);
+                        if (cv.pn == 0) proof_len = std::min(proof_len, cv.proof_len + 1);
+                        if (cv.pn < pn) {
+                            second = pn;
+                            pn = cv.pn;
+                            best = i;
+                            best_values = cv;
+                        } else if (cv.pn < second) {
+                            second = cv.pn;
+                        }
+                    } else {
+                        pn = add(pn, cv.pn);
+                        if (cv.pn == 0) proof_len = std::max(proof_len, cv.proof_len + 1);
+                        if (cv.dn < dn) {
+                            second = dn;
+                            dn = cv.dn;
+                            best = i;
+                            best_values = cv;
+                        } else if (cv.dn < second) {
+                            second = cv.dn;
+                        }
+                    }
+                }
+                if (dn == 0) pn = INF;      // Settled: undo the capped sums
+                if (pn == 0) dn = INF;
+
+                v.pn = pn;
+                v.dn = dn;
+                v.proof_len = (pn == 0) ? proof_len : NO_PROOF;
+                if (pn >= thpn || dn >= thdn || pn == 0 || dn == 0) break;
+
+                // The child's threshold on its deciding number reaches just past the runner-up
+                // (with 25% slack, so the search doesn't flip between close siblings); its
+                // other threshold takes up the parent's remaining slack.
+                uint32_t child_thpn, child_thdn;
+                uint32_t runner_up = std::min<uint64_t>(INF - 1, second + second / 4 + 1);
+                if (attacker_node) {
+                    child_thpn = std::min(thpn, runner_up);
+                    child_thdn = std::min<uint64_t>(INF, uint64_t(thdn) - dn + best_values.dn);
+                } else {
+                    child_thdn = std::min(thdn, runner_up);
+                    child_thpn = std::min<uint64_t>(INF, uint64_t(thpn) - pn + best_values.pn);
+                }
+
+                Move m = children[best].move;
+                board.make_move(m);
+                mid(rem - 1, ply + 1, child_thpn, child_thdn);
+                board.undo_move(m);
+                if (aborted) return v;
+            }
+
+            store(board.key, rem, v, nodes - nodes_before + 1);
+            return v;
+        }
+    };
+
+    Result solve(BoardState& board, const Options& options) {
+        auto start = std::chrono::steady_clock::now();
+        Result result;
+        Nnue::AccumulatorStack* nnue = board.nnue;
+        board.nnue = nullptr;
+
+        Solver solver(board, options);
+        int max_moves = std::clamp(options.max_moves, 0, MAX_MOVES);
+        for (int n = 1; n <= max_moves; ++n) {
+            Values v = solver.solve_root(2 * n - 1);
+            if (solver.aborted) break;
+            if (v.pn == 0) {
+                result.status = Mate;
+                result.mate_in = n;
+                solver.extract_pv(v.proof_len, result.pv);
+                break;
+            }
+        }
+        if (result.status != Mate && !solver.aborted && max_moves > 0) result.status = NoMate;
+
+        board.nnue = nnue;
+        result.nodes = solver.nodes;
+        result.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+}
@@ -0,0 +1,552 @@
+#include "Mcts.hpp"
+#include "MoveGen.hpp"
+#include "Attacks.hpp"
+#include "EvalContext.hpp"
+#include "Memory.hpp"
+#include "Nnue.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace Mcts {
+
+    static constexpr int32_t MATE_SCORE = 100000;
+    static constexpr int32_t MAX_REPORTED_CP = 5000;
+    static constexpr int MAX_PV = 32;
+    static constexpr float FPU_REDUCTION = 0.2f;    // Unvisited children start this far below the parent
+    static constexpr int64_t REPORT_INTERVAL_MS = 1000;
+
+    // --- TREE ---
+    Tree::Tree(uint64_t max_nodes) {
+        max_nodes = std::clamp<uint64_t>(max_nodes, CHUNK_SIZE, uint64_t(NONE) - CHUNK_SIZE);
+        max_chunks = static_cast<uint32_t>((max_nodes + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        chunks = std::make_unique<std::unique_ptr<Node[]>[]>(max_chunks);
+    }
+
+    Tree::~Tree() = default;
+
+    uint32_t Tree::allocate(uint32_t count) {
+        std::lock_guard<std::mutex> lock(alloc_mutex);
+        uint64_t first = used.load(std::memory_order_relaxed);
+        // A block never straddles two chunks
+        if ((first & CHUNK_MASK) + count > CHUNK_SIZE) first = (first | CHUNK_MASK) + 1;
+        uint64_t chunk = first >> CHUNK_BITS;
+        if (count > CHUNK_SIZE || chunk >= max_chunks) {
+            out_of_space = true;
+            return NONE;
+        }
+        if (!chunks[chunk]) chunks[chunk] = std::make_unique<Node[]>(CHUNK_SIZE);
+        used.store(first + count, std::memory_order_relaxed);
+        return static_cast<uint32_t>(first);
+    }
+
+    // --- VALUES ---
+    // Centipawns <-> values in [-1, 1] for the side to move (2 * win probability - 1)
+    static float to_value(int32_t cp, float scale) {
+        return 2.0f / (1.0f + std::pow(10.0f, -static_cast<float>(cp) / scale)) - 1.0f;
+    }
+
+    static int32_t to_centipawns(float value, float scale) {
+        value = std::clamp(value, -0.9999f, 0.9999f);
+        float cp = scale * std::log10((1.0f + value) / (1.0f - value));
+        return std::clamp(static_cast<int32_t>(std::lround(cp)), -MAX_REPORTED_CP, MAX_REPORTED_CP);
+    }
+
+    static Move to_move(uint16_t raw) {
+        return Move(static_cast<Square>(raw & 0x3F), static_cast<Square>((raw >> 6) & 0x3F),
+                    static_cast<MoveFlag>(raw >> 12));
+    }
+
+    // --- EXPANSION ---
+    static int piece_at(const BoardState& board, int sq) {
+        uint64_t bit = 1ULL << sq;
+        for (int p = 0; p < 12; ++p) {
+            if (board.pieces[p] & bit) return p % 6;
+        }
+        return -1;
+    }
+
+    static bool in_check(const BoardState& board) {
+        Colour them = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+        return Attacks::is_square_attacked(Search::find_king(board, board.to_move), them,
+                                           board.pieces.data(), board.occupancy[2]);
+    }
+
+    // Prior logit of a move: captures by victim value, promotions and checks first
+    static float prior_logit(const BoardState& board, Move m, bool gives_check) {
+        static constexpr float VALUE[6] = {1.0f, 3.0f, 3.0f, 5.0f, 9.0f, 0.0f};
+        float logit = 0.0f;
+        if (m.is_capture()) {
+            int victim = (m.flag() == MoveFlag::EnPassant) ? 0 : piece_at(board, static_cast<int>(m.to()));
+            int attacker = piece_at(board, static_cast<int>(m.from()));
+            logit += 1.0f + 0.2f * VALUE[std::max(victim, 0)] - 0.05f * VALUE[std::max(attacker, 0)];
+        }
+        if (m.is_promotion()) logit += m.is_promo_queen() ? 1.5f : -1.0f;
+        if (gives_check) logit += 0.5f;
+        return logit;
+    }
+
+    // Generates the children of a node this thread has claimed (state Expanding) and
+    // publishes them. Returns false if the tree is full (the node is left Unexpanded).
+    static bool expand(Tree& tree, uint32_t index, BoardState& board, bool root, std::vector<Move>& moves) {
+        Node& node = tree.node(index);
+        if (!root && board.is_draw()) {
+            node.terminal_value = 0.0f;
+            node.state.store(Terminal, std::memory_order_release);
+            return true;
+        }
+
+        struct Candidate { Move move; uint64_t key; float logit; };
+        Candidate candidates[256];
+        int count = 0;
+
+        moves.clear();
+        MoveGen::generate_moves(board, moves);
+        for (const Move& m : moves) {
+            board.make_move(m);
+            Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+            bool legal = !Attacks::is_square_attacked(Search::find_king(board, us), board.to_move,
+                                                      board.pieces.data(), board.occupancy[2]);
+            bool check = legal && in_check(board);
+            uint64_t key = board.key;
+            board.undo_move(m);
+            if (!legal || count == 256) continue;
+            candidates[count++] = {m, key, prior_logit(board, m, check)};
+        }
+
+        if (count == 0) {
+            node.terminal_value = in_check(board) ? -1.0f : 0.0f;
+            node.state.store(Terminal, std::memory_order_release);
+            return true;
+        }
+
+        uint32_t first = tree.allocate(static_cast<uint32_t>(count));
+        if (first == Tree::NONE) {
+            node.state.store(Unexpanded, std::memory_order_release);
+            return false;
+        }
+
+        // Softmax over the logits
+        float max_logit = candidates[0].logit;
+        for (int i = 1; i < count; ++i) max_logit = std::max(max_logit, candidates[i].logit);
+        float total = 0.0f;
+        for (int i = 0; i < count; ++i) {
+            candidates[i].logit = std::exp(candidates[i].logit - max_logit);
+            total += candidates[i].logit;
+        }
+        for (int i = 0; i < count; ++i) {
+            Node& child = tree.node(first + i);
+            child.move = candidates[i].move.raw();
+            child.key = candidates[i].key;
+            child.prior = candidates[i].logit / total;
+        }
+        node.first_child = first;
+        node.num_children = static_cast<uint16_t>(count);
+        node.state.store(Expanded, std::memory_order_release);
+        return true;
+    }
+
+    // --- SELECTION ---
+    // PUCT: Q + cpuct * P * sqrt(N) / (1 + n). A playout in flight counts as a visit that
+    // lost, so concurrent playouts spread over different children.
+    static uint32_t select_child(Tree& tree, Node& node, float cpuct) {
+        int32_t parent_visits = node.visits.load(std::memory_order_relaxed)
+                              + node.virtual_loss.load(std::memory_order_relaxed);
+        float sqrt_visits = std::sqrt(static_cast<float>(std::max(parent_visits, 1)));
+
+        int32_t own_visits = node.visits.load(std::memory_order_relaxed);
+        float parent_q = own_visits > 0 ? -node.value_sum.load(std::memory_order_relaxed) / own_visits : 0.0f;
+        float fpu = parent_q - FPU_REDUCTION;
+
+        uint32_t best = node.first_child;
+        float best_score = -1e9f;
+        for (uint32_t i = 0; i < node.num_children; ++i) {
+            Node& child = tree.node(node.first_child + i);
+            int32_t n = child.visits.load(std::memory_order_relaxed);
+            int32_t vl = child.virtual_loss.load(std::memory_order_relaxed);
+            float q = (n + vl > 0)
+                ? (child.value_sum.load(std::memory_order_relaxed) - vl) / static_cast<float>(n + vl)
+                : fpu;
+            float score = q + cpuct * child.prior * sqrt_visits / static_cast<float>(1 + n + vl);
+            if (score > best_score) {
+                best_score = score;
+                best = node.first_child + i;
+            }
+        }
+        return best;
+    }
+
+    // --- SEARCH ---
+    struct Shared {
+        Tree& tree;
+        const Search::SearchParams& params;
+        const BoardState& root_board;
+        Search::EvalCallback eval;
+        Search::BatchEvalCallback batch;
+        Search::ContextEvalCallback context_eval;
+        const Nnue::Network* net;
+        float cpuct;
+        float scale;
+        uint64_t playout_limit;
+        int64_t time_limit_ms;
+        std::chrono::steady_clock::time_point start;
+
+        std::atomic<uint64_t> started{0};
+        std::atomic<uint64_t> playouts{0};
+        std::atomic<uint64_t> depth_sum{0};
+        std::atomic<uint64_t> eval_calls{0};
+        std::atomic<bool> done{false};
+
+        int64_t elapsed_ms() const {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    static int32_t evaluate(const Shared& shared, const BoardState& board) {
+        return Trace::sampled(Trace::Eval, "eval", "eval", [&]() -> int32_t {
+            uint32_t side = (board.to_move == Colour::White ? 0 : 1);
+            if (shared.net) return Nnue::evaluate(*shared.net, board.pieces.data(), static_cast<int>(side));
+            if (shared.context_eval) {
+                EvalContext ctx;
+                Context::build(board, ctx);
+                return shared.context_eval(board.pieces.data(), board.occupancy.data(), side, &ctx);
+            }
+            return shared.eval(board.pieces.data(), board.occupancy.data(), side);
+        });
+    }
+
+    // value is for the side to move at the end of path
+    static void backup(Tree& tree, const uint32_t* path, size_t length, float value) {
+        float v = -value;
+        for (size_t i = length; i-- > 0;) {
+            Node& node = tree.node(path[i]);
+            node.value_sum.fetch_add(v, std::memory_order_relaxed);
+            node.visits.fetch_add(1, std::memory_order_relaxed);
+            node.virtual_loss.fetch_sub(1, std::memory_order_relaxed);
+            v = -v;
+        }
+    }
+
+    static void fill_stats(Shared& shared, Search::SearchStats& stats);
+
+    // Leaves waiting for one batch eval call
+    struct LeafBatch {
+        std::vector<uint64_t> pieces;
+        std::vector<uint64_t> occupancy;
+        std::vector<uint32_t> sides;
+        std::vector<int32_t> scores;
+        std::vector<uint32_t> paths;            // Concatenated
+        std::vector<size_t> path_ends;
+
+        void add(const BoardState& board, const std::vector<uint32_t>& path) {
+            pieces.insert(pieces.end(), board.pieces.begin(), board.pieces.end());
+            occupancy.insert(occupancy.end(), board.occupancy.begin(), board.occupancy.end());
+            sides.push_back(board.to_move == Colour::White ? 0 : 1);
+            paths.insert(paths.end(), path.begin(), path.end());
+            path_ends.push_back(paths.size());
+        }
+        size_t size() const { return sides.size(); }
+
+        void flush(Shared& shared) {
+            if (sides.empty()) return;
+            scores.assign(sides.size(), 0);
+            {
+                Trace::Span span("eval batch", "eval", Trace::enabled() && Trace::sample(Trace::Eval, static_cast<uint32_t>(sides.size())));
+                span.arg("positions", static_cast<int64_t>(sides.size()));
+                shared.batch(pieces.data(), occupancy.data(), sides.data(), scores.data(),
+                             static_cast<uint32_t>(sides.size()));
+            }
+            shared.eval_calls.fetch_add(sides.size(), std::memory_order_relaxed);
+            size_t begin = 0;
+            for (size_t i = 0; i < sides.size(); ++i) {
+                backup(shared.tree, paths.data() + begin, path_ends[i] - begin, to_value(scores[i], shared.scale));
+                begin = path_ends[i];
+            }
+            shared.playouts.fetch_add(sides.size(), std::memory_order_relaxed);
+            pieces.clear(); occupancy.clear(); sides.clear(); paths.clear(); path_ends.clear();
+        }
+    };
+
+    static void worker(Shared& shared, bool main_thread, Search::SearchStats* report) {
+        Tree& tree = shared.tree;
+        BoardState board = shared.root_board;
+        std::vector<uint32_t> path;
+        std::vector<Move> made;
+        std::vector<Move> moves;
+        LeafBatch leaves;
+        size_t batch_size = shared.batch ? static_cast<size_t>(std::max(shared.params.mcts.batch_size, 1)) : 0;
+        int64_t next_report_ms = REPORT_INTERVAL_MS;
+
+        while (!shared.done.load(std::memory_order_relaxed)) {
+            if (shared.started.fetch_add(1, std::memory_order_relaxed) >= shared.playout_limit
+                || (shared.params.stop && shared.params.stop->load(std::memory_order_relaxed))
+                || tree.full()) {
+                shared.done = true;
+                break;
+            }
+            if (shared.time_limit_ms > 0 && shared.elapsed_ms() >= shared.time_limit_ms) {
+                shared.done = true;
+                break;
+            }
+
+            // Walk down to a leaf, claiming it for expansion
+            path.clear();
+            made.clear();
+            uint32_t index = tree.root;
+            tree.node(index).virtual_loss.fetch_add(1, std::memory_order_relaxed);
+            path.push_back(index);
+
+            bool known = false;         // Leaf value already known (terminal)
+            bool pending = false;       // Leaf queued for the batch eval
+            float value = 0.0f;
+            while (true) {
+                Node& node = tree.node(index);
+                uint8_t state = node.state.load(std::memory_order_acquire);
+                if (state == Expanded) {
+                    index = select_child(tree, node, shared.cpuct);
+                    Node& child = tree.node(index);
+                    child.virtual_loss.fetch_add(1, std::memory_order_relaxed);
+                    Move m = to_move(child.move);
+                    board.make_move(m);
+                    made.push_back(m);
+                    path.push_back(index);
+                    continue;
+                }
+                if (state == Terminal) {
+                    value = node.terminal_value;
+                    known = true;
+                    break;
+                }
+                if (state == Expanding) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                uint8_t expected = Unexpanded;
+                if (!node.state.compare_exchange_strong(expected, Expanding, std::memory_order_acq_rel)) continue;
+                expand(tree, index, board, false, moves);
+                if (node.state.load(std::memory_order_acquire) == Terminal) {
+                    value = node.terminal_value;
+                    known = true;
+                } else if (batch_size > 0) {
+                    leaves.add(board, path);
+                    pending = true;
+                } else {
+                    value = to_value(evaluate(shared, board), shared.scale);
+                    shared.eval_calls.fetch_add(1, std::memory_order_relaxed);
+                    known = true;
+                }
+                break;
+            }
+            shared.depth_sum.fetch_add(made.size(), std::memory_order_relaxed);
+            for (auto it = made.rbegin(); it != made.rend(); ++it) board.undo_move(*it);
+
+            if (known) {
+                backup(tree, path.data(), path.size(), value);
+                shared.playouts.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (pending && leaves.size() >= batch_size) leaves.flush(shared);
+
+            if (main_thread && shared.params.on_iteration && shared.elapsed_ms() >= next_report_ms) {
+                next_report_ms += REPORT_INTERVAL_MS;
+                fill_stats(shared, *report);
+                shared.params.on_iteration(*report, shared.params.info_user);
+            }
+        }
+        leaves.flush(shared);
+    }
+
+    // Most visited child (ties to the better value); NONE without children
+    static uint32_t best_child(Tree& tree, uint32_t index) {
+        Node& node = tree.node(index);
+        if (node.state.load(std::memory_order_acquire) != Expanded) return Tree::NONE;
+        uint32_t best = Tree::NONE;
+        int32_t best_visits = -1;
+        float best_q = -2.0f;
+        for (uint32_t i = 0; i < node.num_children; ++i) {
+            Node& child = tree.node(node.first_child + i);
+            int32_t n = child.visits.load(std::memory_order_relaxed);
+            float q = n > 0 ? child.value_sum.load(std::memory_order_relaxed) / n : -2.0f;
+            if (n > best_visits || (n == best_visits && q > best_q)) {
+                best = node.first_child + i;
+                best_visits = n;
+                best_q = q;
+            }
+        }
+        return best;
+    }
+
+    static void fill_stats(Shared& shared, Search::SearchStats& stats) {
+        Tree& tree = shared.tree;
+        uint64_t playouts = shared.playouts.load(std::memory_order_relaxed);
+        stats.nodes = playouts;
+        stats.time_ms = shared.elapsed_ms();
+        stats.eval_calls = shared.eval_calls.load(std::memory_order_relaxed);
+        stats.depth_reached = playouts > 0
+            ? static_cast<int>((shared.depth_sum.load(std::memory_order_relaxed) + playouts / 2) / playouts) : 0;
+
+        uint32_t best = best_child(tree, tree.root);
+        if (best == Tree::NONE) return;
+        Node& child = tree.node(best);
+        int32_t n = child.visits.load(std::memory_order_relaxed);
+        stats.best_move_raw = child.move;
+        if (child.state.load(std::memory_order_acquire) == Terminal && child.terminal_value == -1.0f) {
+            stats.score = MATE_SCORE - 1;
+        } else {
+            stats.score = n > 0 ? to_centipawns(child.value_sum.load(std::memory_order_relaxed) / n, shared.scale) : 0;
+        }
+        uint32_t reply = best_child(tree, best);
+        stats.ponder_move_raw = (reply != Tree::NONE && tree.node(reply).visits.load() > 0) ? tree.node(reply).move : 0;
+    }
+
+    // --- TREE REUSE ---
+    static void copy_node(Node& from, Node& to) {
+        to.visits.store(from.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        to.virtual_loss.store(0, std::memory_order_relaxed);
+        to.value_sum.store(from.value_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        to.state.store(from.state.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        to.prior = from.prior;
+        to.terminal_value = from.terminal_value;
+        to.move = from.move;
+        to.num_children = from.num_children;
+        to.first_child = from.first_child;
+        to.key = from.key;
+    }
+
+    // The subtree under from, copied breadth-first into a fresh arena
+    static std::unique_ptr<Tree> extract_subtree(Tree& old, uint32_t from, uint64_t max_nodes) {
+        auto tree = std::make_unique<Tree>(max_nodes);
+        tree->root = tree->allocate(1);
+        copy_node(old.node(from), tree->node(tree->root));
+
+        std::vector<std::pair<uint32_t, uint32_t>> queue{{from, tree->root}};
+        for (size_t i = 0; i < queue.size(); ++i) {
+            Node& src = old.node(queue[i].first);
+            Node& dst = tree->node(queue[i].second);
+            if (dst.state.load(std::memory_order_relaxed) != Expanded) continue;
+            uint32_t first = tree->allocate(src.num_children);
+            if (first == Tree::NONE) {
+                dst.state.store(Unexpanded, std::memory_order_relaxed);
+                dst.num_children = 0;
+                continue;
+            }
+            dst.first_child = first;
+            for (uint32_t c = 0; c < src.num_children; ++c) {
+                copy_node(old.node(src.first_child + c), tree->node(first + c));
+                queue.emplace_back(src.first_child + c, first + c);
+            }
+        }
+        return tree;
+    }
+
+    // The node for key among the root, its children and grandchildren (NONE if absent)
+    static uint32_t find_descendant(Tree& tree, uint64_t key) {
+        if (tree.root == Tree::NONE) return Tree::NONE;
+        Node& root = tree.node(tree.root);
+        if (root.key == key) return tree.root;
+        if (root.state.load() != Expanded) return Tree::NONE;
+        for (uint32_t i = 0; i < root.num_children; ++i) {
+            uint32_t c = root.first_child + i;
+            Node& child = tree.node(c);
+            if (child.key == key) return c;
+            if (child.state.load() != Expanded) continue;
+            for (uint32_t j = 0; j < child.num_children; ++j) {
+                if (tree.node(child.first_child + j).key == key) return child.first_child + j;
+            }
+        }
+        return Tree::NONE;
+    }
+
+    Move search(BoardState& board, const Search::SearchParams& params, Search::SearchStats& stats) {
+        auto start = std::chrono::steady_clock::now();
+        stats = Search::SearchStats();
+        const Search::MctsOptions& options = params.mcts;
+
+        // Keep whatever the previous search learned below this position
+        std::unique_ptr<Tree> local;
+        std::unique_ptr<Tree>* owner = &local;
+        if (params.state) {
+            params.state->prepare(board);
+            stats.ponder_hit = params.state->ponder_hit;
+            owner = &params.state->tree;
+        }
+        if (*owner) {
+            uint32_t node = find_descendant(**owner, board.key);
+            if (node == Tree::NONE) owner->reset();
+            else if (node != (*owner)->root) *owner = extract_subtree(**owner, node, options.max_tree_nodes);
+        }
+        if (!*owner) {
+            *owner = std::make_unique<Tree>(options.max_tree_nodes);
+            (*owner)->root = (*owner)->allocate(1);
+            (*owner)->node((*owner)->root).key = board.key;
+        }
+        Tree& tree = **owner;
+
+        // A reused root may have been a draw by repetition on the old path: expand it anyway
+        Node& root = tree.node(tree.root);
+        if (root.state.load() != Expanded) {
+            std::vector<Move> moves;
+            root.state = Expanding;
+            expand(tree, tree.root, board, true, moves);
+        }
+        if (root.state.load() != Expanded) {
+            stats.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            return Move();      // Mated or stalemated (or no room for the root's children)
+        }
+
+        Nnue::AccumulatorStack* nnue = board.nnue;
+        board.nnue = nullptr;
+
+        uint64_t playout_limit = (params.max_nodes > 0) ? params.max_nodes
+                               : (params.soft_time_ms > 0 || params.hard_time_ms > 0) ? UINT64_MAX
+                               : std::max<uint64_t>(options.playouts, 1);
+        Shared shared{tree, params, board, params.evalFunc, Search::batch_eval_for(params.evalFunc),
+                      Search::context_eval_for(params.evalFunc), Nnue::network_for(params.evalFunc),
+                      options.cpuct, static_cast<float>(std::max(options.value_scale, 1)),
+                      playout_limit, params.soft_time_ms > 0 ? params.soft_time_ms : params.hard_time_ms, start};
+        if (shared.net || shared.context_eval) shared.batch = nullptr;
+
+        int threads = options.threads > 0 ? options.threads
+                                          : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        // Pinned helpers take the CPUs after the search thread's, which is CPU 0 under UCI
+        std::vector<std::thread> helpers;
+        for (int i = 1; i < threads; ++i) {
+            helpers.emplace_back([&shared, i]() {
+                Memory::pin_thread(i);
+                worker(shared, false, nullptr);
+            });
+        }
+        worker(shared, true, &stats);
+        for (auto& t : helpers) t.join();
+
+        board.nnue = nnue;
+        fill_stats(shared, stats);
+
+        // Leave the most visited line in the TT for move ordering and PV reporting
+        if (params.state) {
+            Search::SearchState& st = *params.state;
+            st.expected_key = 0;
+            uint32_t index = best_child(tree, tree.root);
+            std::vector<Move> line;
+            st.store(board.key, 0, stats.score, Search::Bound::None, static_cast<uint16_t>(stats.best_move_raw), 0);
+            while (index != Tree::NONE && line.size() < MAX_PV && tree.node(index).visits.load() > 0) {
+                Move m = to_move(tree.node(index).move);
+                board.make_move(m);
+                line.push_back(m);
+                if (line.size() == 2) st.expected_key = board.key;
+                uint32_t next = best_child(tree, index);
+                if (next != Tree::NONE && tree.node(next).visits.load() > 0) {
+                    st.store(board.key, 0, 0, Search::Bound::None, tree.node(next).move, 0);
+                }
+                index = next;
+            }
+            for (auto it = line.rbegin(); it != line.rend(); ++it) board.undo_move(*it);
+        }
+        if (params.on_iteration) params.on_iteration(stats, params.info_user);
+        return to_move(static_cast<uint16_t>(stats.best_move_raw));
+    }
+}
@@ -0,0 +1,308 @@
+#include "Memory.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+namespace Memory {
+
+    static Options current;
+
+    void configure(const Options& options) { current = options; }
+    const Options& options() { return current; }
+
+    static size_t round_up(size_t n, size_t multiple) {
+        return (n + multiple - 1) / multiple * multiple;
+    }
+
+    // "512 kB", "16 MB", "1.5 GB"
+    static std::string size_text(size_t bytes) {
+        char buf[32];
+        if (bytes >= (size_t(1) << 30)) std::snprintf(buf, sizeof(buf), "%.3g GB", static_cast<double>(bytes) / (1 << 30));
+        else if (bytes >= (size_t(1) << 20)) std::snprintf(buf, sizeof(buf), "%.3g MB", static_cast<double>(bytes) / (1 << 20));
+        else std::snprintf(buf, sizeof(buf), "%zu kB", bytes >> 10);
+        return buf;
+    }
+
+#ifdef __linux__
+    // Value of a "Name:   123 kB" line in a /proc file, in the file's unit; -1 if absent
+    static long long proc_value(const char* path, const std::string& name) {
+        std::ifstream f(path);
+        std::string line;
+        while (std::getline(f, line)) {
+            if (line.compare(0, name.size(), name) == 0 && line.size() > name.size() && line[name.size()] == ':') {
+                return std::stoll(line.substr(name.size() + 1));
+            }
+        }
+        return -1;
+    }
+
+    static size_t huge_page_size() {
+        static const size_t size = [] {
+            long long kb = proc_value("/proc/meminfo", "Hugepagesize");
+            return (kb > 0) ? static_cast<size_t>(kb) << 10 : size_t(2) << 20;
+        }();
+        return size;
+    }
+
+    // Kernel list syntax as in /sys: "0-3,8,10-11"
+    static std::vector<int> parse_list(const std::string& text) {
+        std::vector<int> ids;
+        std::stringstream in(text);
+        std::string range;
+        while (std::getline(in, range, ',')) {
+            if (range.empty() || range[0] < '0' || range[0] > '9') continue;
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+            for (int id = first; id <= last; ++id) ids.push_back(id);
+        }
+        return ids;
+    }
+
+    static std::vector<int> read_list(const std::string& path) {
+        std::ifstream f(path);
+        std::string text;
+        std::getline(f, text);
+        return parse_list(text);
+    }
+#endif
+
+    // --- ALLOCATION ---
+    Block allocate(size_t bytes) {
+        Block block;
+        if (bytes == 0) return block;
+#ifdef _WIN32
+        // Needs the "Lock pages in memory" privilege; without it this fails and we fall back
+        SIZE_T large = GetLargePageMinimum();
+        if (current.large_pages && large > 0) {
+            size_t size = round_up(bytes, large);
+            void* p = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (p) return {p, size, Pages::Explicit};
+        }
+        size_t size = round_up(bytes, 4096);
+        void* p = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (p) block = {p, size, Pages::Small};
+#else
+#ifdef __linux__
+        if (current.large_pages) {
+            size_t huge = huge_page_size();
+            size_t size = round_up(bytes, huge);
+            // Explicit pages come from the vm.nr_hugepages reserve; mmap fails up front if
+            // there aren't enough free, never later on a fault
+            void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) return {p, size, Pages::Explicit};
+
+            // Transparent pages need huge-page alignment: map one extra and trim the ends
+            char* raw = static_cast<char*>(mmap(nullptr, size + huge, PROT_READ | PROT_WRITE,
+                                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            if (raw != MAP_FAILED) {
+                char* start = reinterpret_cast<char*>(round_up(reinterpret_cast<uintptr_t>(raw), huge));
+                size_t head = static_cast<size_t>(start - raw);
+                if (head > 0) munmap(raw, head);
+                if (huge - head > 0) munmap(start + size, huge - head);
+                bool advised = madvise(start, size, MADV_HUGEPAGE) == 0;
+                return {start, size, advised ? Pages::Transparent : Pages::Small};
+            }
+        }
+#endif
+        size_t size = round_up(bytes, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED) block = {p, size, Pages::Small};
+#endif
+        return block;
+    }
+
+    void release(Block& block) {
+        if (!block.ptr) return;
+#ifdef _WIN32
+        VirtualFree(block.ptr, 0, MEM_RELEASE);
+#else
+        munmap(block.ptr, block.bytes);
+#endif
+        block = Block();
+    }
+
+    // --- PLACEMENT ---
+    int num_nodes() {
+#ifdef __linux__
+        static const int nodes = [] {
+            std::vector<int> online = read_list("/sys/devices/system/node/online");
+            return online.empty() ? 1 : *std::max_element(online.begin(), online.end()) + 1;
+        }();
+        return nodes;
+#else
+        return 1;
+#endif
+    }
+
+    int current_node() {
+#ifdef __linux__
+        unsigned cpu = 0, node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return 0;
+        return static_cast<int>(node);
+#else
+        return 0;
+#endif
+    }
+
+    std::string describe(const Block& block) {
+        if (!block.ptr) return "not allocated";
+        std::string out = size_text(block.bytes) + " on ";
+#ifdef __linux__
+        if (block.pages == Pages::Explicit) {
+            out += size_text(huge_page_size()) + " pages (explicit)";
+        } else {
+            // smaps has one entry per mapping; madvise may have split ours into several
+            uintptr_t lo = reinterpret_cast<uintptr_t>(block.ptr), hi = lo + block.bytes;
+            std::ifstream f("/proc/self/smaps");
+            std::string line;
+            bool inside = false;
+            long long huge_kb = 0;
+            while (std::getline(f, line)) {
+                unsigned long long start, end;
+                if (std::sscanf(line.c_str(), "%llx-%llx ", &start, &end) == 2 && line.find(':') > line.find(' ')) {
+                    inside = start < hi && end > lo;
+                } else if (inside && line.compare(0, 14, "AnonHugePages:") == 0) {
+                    huge_kb += std::stoll(line.substr(14));
+                }
+            }
+            out += size_text(static_cast<size_t>(sysconf(_SC_PAGESIZE))) + " pages";
+            if (huge_kb > 0) out += ", " + size_text(static_cast<size_t>(huge_kb) << 10) + " transparent huge";
+            else if (block.pages == Pages::Transparent) out += " (transparent huge advised, none yet)";
+        }
+
+        // Sample the node of up to 64 pages spread over the block
+        constexpr int SAMPLES = 64;
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        int samples = static_cast<int>(std::min<size_t>(SAMPLES, block.bytes / page));
+        void* pages[SAMPLES];
+        int status[SAMPLES];
+        for (int i = 0; i < samples; ++i) {
+            size_t offset = block.bytes / static_cast<size_t>(samples) * static_cast<size_t>(i) / page * page;
+            pages[i] = static_cast<char*>(block.ptr) + offset;
+        }
+        if (syscall(SYS_move_pages, 0, static_cast<unsigned long>(samples), pages, nullptr, status, 0) != 0) {
+            return out + ", node unknown";
+        }
+        int per_node[MAX_NODES] = {};
+        int untouched = 0;
+        for (int i = 0; i < samples; ++i) {
+            if (status[i] >= 0) per_node[std::min(status[i], MAX_NODES - 1)]++;
+            else untouched++;
+        }
+        if (untouched == samples) return out + ", not touched yet";
+        out += ", node";
+        for (int n = 0; n < MAX_NODES; ++n) {
+            if (per_node[n] > 0) out += " " + std::to_string(n) + " " + std::to_string(100 * per_node[n] / samples) + "%";
+        }
+        if (untouched > 0) out += ", " + std::to_string(100 * untouched / samples) + "% untouched";
+#else
+        out += (block.pages == Pages::Explicit) ? "large pages" : "small pages";
+#endif
+        return out;
+    }
+
+    std::string status() {
+        std::string out = "large pages ";
+        out += current.large_pages ? "on (" : "off (";
+#ifdef __linux__
+        long long total = proc_value("/proc/meminfo", "HugePages_Total");
+        long long free_pages = proc_value("/proc/meminfo", "HugePages_Free");
+        out += size_text(huge_page_size()) + ", " + std::to_string(std::max(free_pages, 0LL)) + " of "
+             + std::to_string(std::max(total, 0LL)) + " reserved free";
+        std::ifstream f("/sys/kernel/mm/transparent_hugepage/enabled");
+        std::string modes;
+        std::getline(f, modes);
+        size_t open = modes.find('['), close = modes.find(']');
+        if (open != std::string::npos && close > open) out += ", transparent " + modes.substr(open + 1, close - open - 1);
+#elif defined(_WIN32)
+        out += GetLargePageMinimum() > 0 ? size_text(GetLargePageMinimum()) : std::string("unsupported");
+#else
+        out += "unsupported";
+#endif
+        out += "), " + std::to_string(num_nodes()) + (num_nodes() == 1 ? " node" : " nodes");
+        out += current.pin_threads ? ", pinning on" : ", pinning off";
+        out += current.replicate ? ", replication on" : ", replication off";
+        return out;
+    }
+
+    // --- THREADS ---
+#ifdef __linux__
+    // CPUs this process may run on, one from each node in turn. Read once, before any
+    // thread has narrowed its own mask by pinning.
+    static const std::vector<int>& pin_order() {
+        static const std::vector<int> order = [] {
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return std::vector<int>();
+
+            std::vector<std::vector<int>> by_node(static_cast<size_t>(num_nodes()));
+            std::vector<bool> placed(CPU_SETSIZE, false);
+            for (int n = 0; n < num_nodes(); ++n) {
+                for (int cpu : read_list("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist")) {
+                    if (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed) && !placed[cpu]) {
+                        by_node[n].push_back(cpu);
+                        placed[cpu] = true;
+                    }
+                }
+            }
+            // Without node information every allowed CPU counts as node 0
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed) && !placed[cpu]) by_node[0].push_back(cpu);
+            }
+
+            std::vector<int> cpus;
+            for (size_t round = 0; ; ++round) {
+                size_t before = cpus.size();
+                for (const auto& node_cpus : by_node) {
+                    if (round < node_cpus.size()) cpus.push_back(node_cpus[round]);
+                }
+                if (cpus.size() == before) break;
+            }
+            return cpus;
+        }();
+        return order;
+    }
+#endif
+
+    bool pin_thread(int index) {
+        if (!current.pin_threads || index < 0) return false;
+#ifdef __linux__
+        const std::vector<int>& cpus = pin_order();
+        if (cpus.empty()) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[static_cast<size_t>(index) % cpus.size()], &set);
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+        DWORD_PTR process_mask = 0, system_mask = 0;
+        if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) || process_mask == 0) return false;
+        int allowed = 0;
+        for (DWORD_PTR m = process_mask; m; m &= m - 1) ++allowed;
+        int skip = index % allowed;
+        DWORD_PTR bit = process_mask;
+        for (int i = 0; i < skip; ++i) bit &= bit - 1;
+        bit &= ~(bit - 1);
+        return SetThreadAffinityMask(GetCurrentThread(), bit) != 0;
+#else
+        return false;
+#endif
+    }
+}
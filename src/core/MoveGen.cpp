@@ -1,6 +1,7 @@
 #include "MoveGen.hpp"
 #include "Attacks.hpp"
 #include "BitUtil.hpp"
+#include "Trace.hpp"
 
 namespace MoveGen {
 
@@ -27,243 +28,217 @@ namespace {
             list.emplace_back(from, to, MoveFlag::KnightPromotion);
         }
     }
-}
-
-void generate_moves(const BoardState& board, std::vector<Move>& move_list) {
-    Colour us = board.to_move;
-    Colour them = (us == Colour::White) ? Colour::Black : Colour::White;
-    Bitboard us_occ = board.occupancy[static_cast<int>(us)];
-    Bitboard them_occ = board.occupancy[static_cast<int>(them)];
-    Bitboard all_occ = board.occupancy[2];
-
-    // --- Pawns ---
-    Bitboard pawns = board.pieces[(us == Colour::White) ? 0 : 6];
-    
-    Bitboard promo_rank = (us == Colour::White) ? 0xFF00000000000000ULL : 0x00000000000000FFULL;
 
-    Bitboard single_push = (us == Colour::White) ? (pawns << 8) : (pawns >> 8);
-    single_push &= ~all_occ; // Must be empty
+    constexpr Bitboard FILE_A = 0x0101010101010101ULL;
+    constexpr Bitboard FILE_H = 0x8080808080808080ULL;
 
-    Bitboard quiet_pushes = single_push & ~promo_rank;
-    Bitboard promo_pushes = single_push & promo_rank;
+    // Everything that depends on the side to move, fixed at compile time
+    template <Colour Us>
+    struct Side {
+        static constexpr Colour them = (Us == Colour::White) ? Colour::Black : Colour::White;
+        static constexpr int base = (Us == Colour::White) ? 0 : 6;     // Our pawn bitboard
+        static constexpr int up = (Us == Colour::White) ? 8 : -8;
+        static constexpr Bitboard promo_rank = (Us == Colour::White) ? 0xFF00000000000000ULL : 0x00000000000000FFULL;
+        static constexpr Bitboard double_rank = (Us == Colour::White) ? 0x00000000FF000000ULL : 0x000000FF00000000ULL;
 
-    while (quiet_pushes) {
-        Square to = BitUtil::pop_lsb(quiet_pushes);
-        Square from = static_cast<Square>(static_cast<int>(to) + ((us == Colour::White) ? -8 : 8));
-        move_list.emplace_back(from, to, MoveFlag::Quiet);
-    }
+        static constexpr Bitboard push(Bitboard b) { return (Us == Colour::White) ? (b << 8) : (b >> 8); }
+        // Pawn captures towards the a-file / h-file, and how far each lands from its pawn
+        static constexpr Bitboard west(Bitboard b) { return (Us == Colour::White) ? ((b << 7) & ~FILE_H) : ((b >> 9) & ~FILE_H); }
+        static constexpr Bitboard east(Bitboard b) { return (Us == Colour::White) ? ((b << 9) & ~FILE_A) : ((b >> 7) & ~FILE_A); }
+        static constexpr int west_step = (Us == Colour::White) ? 7 : -9;
+        static constexpr int east_step = (Us == Colour::White) ? 9 : -7;
 
-    while (promo_pushes) {
-        Square to = BitUtil::pop_lsb(promo_pushes);
-        Square from = static_cast<Square>(static_cast<int>(to) + ((us == Colour::White) ? -8 : 8));
-        add_promotions(from, to, move_list, false); 
-    }
+        static constexpr Square king_from = (Us == Colour::White) ? Square::E1 : Square::E8;
+        static constexpr uint8_t king_side_right = (Us == Colour::White) ? 1 : 4;
+        static constexpr uint8_t queen_side_right = (Us == Colour::White) ? 2 : 8;
+    };
 
-    // Can only happen if the single push land was valid AND we are on start rank
-    Bitboard single_push_valid = single_push; 
-    Bitboard double_push_target = (us == Colour::White) ? 0x00000000FF000000ULL : 0x000000FF00000000ULL; 
-    
-    Bitboard double_push = (us == Colour::White) ? (single_push << 8) : (single_push >> 8);
-    
-    // Mask to ensure we are on the correct rank
-    Bitboard rank_4_5 = (us == Colour::White) ? 0x00000000FF000000ULL : 0x000000FF00000000ULL;
-    double_push &= rank_4_5;
-    double_push &= ~all_occ;
-
-    while (double_push) {
-        Square to = BitUtil::pop_lsb(double_push);
-        Square from = static_cast<Square>(static_cast<int>(to) + ((us == Colour::White) ? -16 : 16));
-        move_list.emplace_back(from, to, MoveFlag::DoublePawnPush);
+    constexpr Square offset(Square sq, int by) {
+        return static_cast<Square>(static_cast<int>(sq) + by);
     }
 
-    // Captures
-    Bitboard pawns_copy = pawns;
-    while(pawns_copy) {
-        Square from = BitUtil::pop_lsb(pawns_copy);
-        Bitboard attacks = (us == Colour::White) ? Attacks::PawnAttacks[0][static_cast<int>(from)] 
-                                                 : Attacks::PawnAttacks[1][static_cast<int>(from)];
-        
-        Bitboard valid_captures = attacks & them_occ;
-
-        Bitboard normal_captures = valid_captures & ~promo_rank;
-        Bitboard promo_captures  = valid_captures & promo_rank;
-
-        serialize_moves(from, normal_captures, move_list, MoveFlag::Capture);
-
-        while (promo_captures) {
-            Square to = BitUtil::pop_lsb(promo_captures);
-            add_promotions(from, to, move_list, true);
-        }
-
-        // En Passant
-        if (board.en_passant_sq != Square::None) {
-            if (attacks & (1ULL << static_cast<int>(board.en_passant_sq))) {
-                move_list.emplace_back(from, board.en_passant_sq, MoveFlag::EnPassant);
-            }
+    // Every target in targets reached from step squares back, as one flag
+    void serialize_pawns(Bitboard targets, int step, std::vector<Move>& list, MoveFlag flag) {
+        while (targets) {
+            Square to = BitUtil::pop_lsb(targets);
+            list.emplace_back(offset(to, -step), to, flag);
         }
     }
 
-    // --- Knights ---
-    Bitboard knights = board.pieces[(us == Colour::White) ? 1 : 7];
-    while (knights) {
-        Square from = BitUtil::pop_lsb(knights);
-        Bitboard moves = Attacks::KnightAttacks[static_cast<int>(from)] & ~us_occ;
-        serialize_moves(from, moves & them_occ, move_list, MoveFlag::Capture);
-        serialize_moves(from, moves & ~them_occ, move_list, MoveFlag::Quiet);
-    }
-
-    // --- King ---
-    Bitboard king = board.pieces[(us == Colour::White) ? 5 : 11];
-    if (king) {
-        Square from = static_cast<Square>(BitUtil::lsb(king));
-        Bitboard moves = Attacks::KingAttacks[static_cast<int>(from)] & ~us_occ;
-        serialize_moves(from, moves & them_occ, move_list, MoveFlag::Capture);
-        serialize_moves(from, moves & ~them_occ, move_list, MoveFlag::Quiet);
-    }
-
-    // --- Sliders ---
-    Bitboard bishops = board.pieces[(us == Colour::White) ? 2 : 8];
-    while (bishops) {
-        Square from = BitUtil::pop_lsb(bishops);
-        Bitboard moves = Attacks::get_bishop_attacks(static_cast<int>(from), all_occ) & ~us_occ;
-        serialize_moves(from, moves & them_occ, move_list, MoveFlag::Capture);
-        serialize_moves(from, moves & ~them_occ, move_list, MoveFlag::Quiet);
-    }
-
-    Bitboard rooks = board.pieces[(us == Colour::White) ? 3 : 9];
-    while (rooks) {
-        Square from = BitUtil::pop_lsb(rooks);
-        Bitboard moves = Attacks::get_rook_attacks(static_cast<int>(from), all_occ) & ~us_occ;
-        serialize_moves(from, moves & them_occ, move_list, MoveFlag::Capture);
-        serialize_moves(from, moves & ~them_occ, move_list, MoveFlag::Quiet);
-    }
-
-    Bitboard queens = board.pieces[(us == Colour::White) ? 4 : 10];
-    while (queens) {
-        Square from = BitUtil::pop_lsb(queens);
-        Bitboard moves = Attacks::get_queen_attacks(static_cast<int>(from), all_occ) & ~us_occ;
-        serialize_moves(from, moves & them_occ, move_list, MoveFlag::Capture);
-        serialize_moves(from, moves & ~them_occ, move_list, MoveFlag::Quiet);
+    void serialize_pawn_promotions(Bitboard targets, int step, std::vector<Move>& list, bool is_capture) {
+        while (targets) {
+            Square to = BitUtil::pop_lsb(targets);
+            add_promotions(offset(to, -step), to, list, is_capture);
+        }
     }
 
-    // --- Castling ---
-    if (us == Colour::White) {
-        if ((board.castle_rights & 1) && !BitUtil::get_bit(all_occ, Square::F1) && !BitUtil::get_bit(all_occ, Square::G1)) {
-            if (!Attacks::is_square_attacked(Square::E1, Colour::Black, board.pieces.data(), all_occ) &&
-                !Attacks::is_square_attacked(Square::F1, Colour::Black, board.pieces.data(), all_occ) &&
-                !Attacks::is_square_attacked(Square::G1, Colour::Black, board.pieces.data(), all_occ)) {
-                move_list.emplace_back(Square::E1, Square::G1, MoveFlag::KingCastle);
-            }
-        }
-        if ((board.castle_rights & 2) && !BitUtil::get_bit(all_occ, Square::D1) && !BitUtil::get_bit(all_occ, Square::C1) && !BitUtil::get_bit(all_occ, Square::B1)) {
-            if (!Attacks::is_square_attacked(Square::E1, Colour::Black, board.pieces.data(), all_occ) &&
-                !Attacks::is_square_attacked(Square::D1, Colour::Black, board.pieces.data(), all_occ) &&
-                !Attacks::is_square_attacked(Square::C1, Colour::Black, board.pieces.data(), all_occ)) {
-                move_list.emplace_back(Square::E1, Square::C1, MoveFlag::QueenCastle);
+    // Pieces of side `by` attacking sq
+    Bitboard attackers_of(const Position& board, Square sq, Colour by) {
+        int s = static_cast<int>(sq);
+        int b = static_cast<int>(by) * 6;
+        Bitboard occ = board.occupancy[2];
+        return (Attacks::PawnAttacks[static_cast<int>(by) ^ 1][s] & board.pieces[b])
+             | (Attacks::KnightAttacks[s] & board.pieces[b + 1])
+             | (Attacks::get_bishop_attacks(s, occ) & (board.pieces[b + 2] | board.pieces[b + 4]))
+             | (Attacks::get_rook_attacks(s, occ) & (board.pieces[b + 3] | board.pieces[b + 4]))
+             | (Attacks::KingAttacks[s] & board.pieces[b + 5]);
+    }
+
+    // Squares strictly between a king and a slider checking it along an open line
+    Bitboard between(Square king, Square checker, Bitboard occ) {
+        int k = static_cast<int>(king), c = static_cast<int>(checker);
+        Bitboard rook_k = Attacks::get_rook_attacks(k, occ);
+        if (rook_k & BitUtil::from_square(checker)) return rook_k & Attacks::get_rook_attacks(c, occ);
+        Bitboard bishop_k = Attacks::get_bishop_attacks(k, occ);
+        if (bishop_k & BitUtil::from_square(checker)) return bishop_k & Attacks::get_bishop_attacks(c, occ);
+        return 0;   // Knight or pawn: nothing to block
+    }
+
+    // Pseudo-legal moves of one kind for Us. Captures = every capture, en passant and
+    // promotion (what quiescence searches); Quiets = the rest, castling included.
+    // Evasions = moves that may get Us out of check: king moves, and with a single
+    // checker, captures of it and moves onto the line between it and the king.
+    template <Colour Us, GenType Type>
+    void generate(const Position& board, std::vector<Move>& move_list) {
+        using S = Side<Us>;
+        constexpr int us = static_cast<int>(Us);
+        constexpr int them = static_cast<int>(S::them);
+        const Bitboard us_occ = board.occupancy[us];
+        const Bitboard them_occ = board.occupancy[them];
+        const Bitboard all_occ = board.occupancy[2];
+        const Bitboard empty = ~all_occ;
+
+        Bitboard king = board.pieces[S::base + 5];
+        Square king_sq = king ? static_cast<Square>(BitUtil::lsb(king)) : Square::None;
+
+        // Where pieces other than the king may capture / move quietly
+        Bitboard capture_mask = (Type == Quiets) ? 0 : them_occ;
+        Bitboard quiet_mask = (Type == Captures) ? 0 : empty;
+        if constexpr (Type == Evasions) {
+            Bitboard checkers = (king_sq != Square::None) ? attackers_of(board, king_sq, S::them) : 0;
+            if (BitUtil::count_bits(checkers) > 1) {
+                capture_mask = 0;   // Double check: only the king can move
+                quiet_mask = 0;
+            } else if (checkers) {
+                capture_mask = checkers;
+                quiet_mask = between(king_sq, static_cast<Square>(BitUtil::lsb(checkers)), all_occ);
             }
         }
-    } else {
-        if ((board.castle_rights & 4) && !BitUtil::get_bit(all_occ, Square::F8) && !BitUtil::get_bit(all_occ, Square::G8)) {
-            if (!Attacks::is_square_attacked(Square::E8, Colour::White, board.pieces.data(), all_occ) &&
-                !Attacks::is_square_attacked(Square::F8, Colour::White, board.pieces.data(), all_occ) &&
-                !Attacks::is_square_attacked(Square::G8, Colour::White, board.pieces.data(), all_occ)) {
-                move_list.emplace_back(Square::E8, Square::G8, MoveFlag::KingCastle);
+
+        // --- Pawns ---
+        Bitboard pawns = board.pieces[S::base];
+        Bitboard single_push = S::push(pawns) & empty;
+
+        if constexpr (Type != Quiets) {
+            Bitboard promo_targets = (Type == Evasions) ? quiet_mask : empty;
+            serialize_pawn_promotions(single_push & S::promo_rank & promo_targets, S::up, move_list, false);
+
+            Bitboard west = S::west(pawns) & capture_mask;
+            Bitboard east = S::east(pawns) & capture_mask;
+            serialize_pawns(west & ~S::promo_rank, S::west_step, move_list, MoveFlag::Capture);
+            serialize_pawns(east & ~S::promo_rank, S::east_step, move_list, MoveFlag::Capture);
+            serialize_pawn_promotions(west & S::promo_rank, S::west_step, move_list, true);
+            serialize_pawn_promotions(east & S::promo_rank, S::east_step, move_list, true);
+
+            // A pawn checker that just double-pushed can be taken en passant; other evasions
+            // it can't help with are filtered out by the legality check like any other move
+            if (board.en_passant_sq != Square::None) {
+                Bitboard takers = Attacks::PawnAttacks[them][static_cast<int>(board.en_passant_sq)] & pawns;
+                while (takers) {
+                    move_list.emplace_back(BitUtil::pop_lsb(takers), board.en_passant_sq, MoveFlag::EnPassant);
+                }
             }
         }
-        if ((board.castle_rights & 8) && !BitUtil::get_bit(all_occ, Square::D8) && !BitUtil::get_bit(all_occ, Square::C8) && !BitUtil::get_bit(all_occ, Square::B8)) {
-            if (!Attacks::is_square_attacked(Square::E8, Colour::White, board.pieces.data(), all_occ) &&
-                !Attacks::is_square_attacked(Square::D8, Colour::White, board.pieces.data(), all_occ) &&
-                !Attacks::is_square_attacked(Square::C8, Colour::White, board.pieces.data(), all_occ)) {
-                move_list.emplace_back(Square::E8, Square::C8, MoveFlag::QueenCastle);
-            }
+        if constexpr (Type != Captures) {
+            serialize_pawns(single_push & ~S::promo_rank & quiet_mask, S::up, move_list, MoveFlag::Quiet);
+            Bitboard double_push = S::push(single_push) & S::double_rank & empty & quiet_mask;
+            serialize_pawns(double_push, 2 * S::up, move_list, MoveFlag::DoublePawnPush);
         }
-    }
-}
 
-void generate_captures(const BoardState& board, std::vector<Move>& move_list) {
-    Colour us = board.to_move;
-    Colour them = (us == Colour::White) ? Colour::Black : Colour::White;
-    Bitboard us_occ = board.occupancy[static_cast<int>(us)];
-    Bitboard them_occ = board.occupancy[static_cast<int>(them)];
-    Bitboard all_occ = board.occupancy[2];
-
-    // --- Pawns ---
-    Bitboard pawns = board.pieces[(us == Colour::White) ? 0 : 6];
-    Bitboard promo_rank = (us == Colour::White) ? 0xFF00000000000000ULL : 0x00000000000000FFULL;
-
-    Bitboard single_push = (us == Colour::White) ? (pawns << 8) : (pawns >> 8);
-    single_push &= ~all_occ; 
-    Bitboard promo_pushes = single_push & promo_rank;
-
-    while (promo_pushes) {
-        Square to = BitUtil::pop_lsb(promo_pushes);
-        Square from = static_cast<Square>(static_cast<int>(to) + ((us == Colour::White) ? -8 : 8));
-        add_promotions(from, to, move_list, false);
-    }
+        // --- Pieces ---
+        auto piece_moves = [&](Square from, Bitboard attacks) {
+            serialize_moves(from, attacks & capture_mask, move_list, MoveFlag::Capture);
+            if constexpr (Type != Captures) serialize_moves(from, attacks & quiet_mask, move_list, MoveFlag::Quiet);
+        };
 
-    Bitboard pawns_copy = pawns;
-    while(pawns_copy) {
-        Square from = BitUtil::pop_lsb(pawns_copy);
-        Bitboard attacks = (us == Colour::White) ? Attacks::PawnAttacks[0][static_cast<int>(from)] 
-                                                 : Attacks::PawnAttacks[1][static_cast<int>(from)];
-        
-        Bitboard valid_captures = attacks & them_occ;
+        Bitboard knights = board.pieces[S::base + 1];
+        while (knights) {
+            Square from = BitUtil::pop_lsb(knights);
+            piece_moves(from, Attacks::KnightAttacks[static_cast<int>(from)]);
+        }
+
+        Bitboard bishops = board.pieces[S::base + 2];
+        while (bishops) {
+            Square from = BitUtil::pop_lsb(bishops);
+            piece_moves(from, Attacks::get_bishop_attacks(static_cast<int>(from), all_occ));
+        }
 
-        Bitboard normal_captures = valid_captures & ~promo_rank;
-        Bitboard promo_captures  = valid_captures & promo_rank;
+        Bitboard rooks = board.pieces[S::base + 3];
+        while (rooks) {
+            Square from = BitUtil::pop_lsb(rooks);
+            piece_moves(from, Attacks::get_rook_attacks(static_cast<int>(from), all_occ));
+        }
 
-        serialize_moves(from, normal_captures, move_list, MoveFlag::Capture);
+        Bitboard queens = board.pieces[S::base + 4];
+        while (queens) {
+            Square from = BitUtil::pop_lsb(queens);
+            piece_moves(from, Attacks::get_queen_attacks(static_cast<int>(from), all_occ));
+        }
 
-        while (promo_captures) {
-            Square to = BitUtil::pop_lsb(promo_captures);
-            add_promotions(from, to, move_list, true);
+        // --- King ---
+        if (king) {
+            Bitboard moves = Attacks::KingAttacks[static_cast<int>(king_sq)] & ~us_occ;
+            if constexpr (Type != Quiets) serialize_moves(king_sq, moves & them_occ, move_list, MoveFlag::Capture);
+            if constexpr (Type != Captures) serialize_moves(king_sq, moves & empty, move_list, MoveFlag::Quiet);
         }
 
-        // En Passant
-        if (board.en_passant_sq != Square::None) {
-            if (attacks & (1ULL << static_cast<int>(board.en_passant_sq))) {
-                move_list.emplace_back(from, board.en_passant_sq, MoveFlag::EnPassant);
+        // --- Castling ---
+        if constexpr (Type == All || Type == Quiets) {
+            constexpr Colour enemy = S::them;
+            constexpr Square e = S::king_from;
+            const Bitboard* pieces = board.pieces.data();
+            if ((board.castle_rights & S::king_side_right)
+                && !BitUtil::get_bit(all_occ, offset(e, 1)) && !BitUtil::get_bit(all_occ, offset(e, 2))) {
+                if (!Attacks::is_square_attacked(e, enemy, pieces, all_occ) &&
+                    !Attacks::is_square_attacked(offset(e, 1), enemy, pieces, all_occ) &&
+                    !Attacks::is_square_attacked(offset(e, 2), enemy, pieces, all_occ)) {
+                    move_list.emplace_back(e, offset(e, 2), MoveFlag::KingCastle);
+                }
+            }
+            if ((board.castle_rights & S::queen_side_right) && !BitUtil::get_bit(all_occ, offset(e, -1))
+                && !BitUtil::get_bit(all_occ, offset(e, -2)) && !BitUtil::get_bit(all_occ, offset(e, -3))) {
+                if (!Attacks::is_square_attacked(e, enemy, pieces, all_occ) &&
+                    !Attacks::is_square_attacked(offset(e, -1), enemy, pieces, all_occ) &&
+                    !Attacks::is_square_attacked(offset(e, -2), enemy, pieces, all_occ)) {
+                    move_list.emplace_back(e, offset(e, -2), MoveFlag::QueenCastle);
+                }
             }
         }
     }
 
-    // --- Knights ---
-    Bitboard knights = board.pieces[(us == Colour::White) ? 1 : 7];
-    while (knights) {
-        Square from = BitUtil::pop_lsb(knights);
-        Bitboard moves = Attacks::KnightAttacks[static_cast<int>(from)] & ~us_occ;
-        serialize_moves(from, moves & them_occ, move_list, MoveFlag::Capture);
+    // The one branch on the side to move
+    template <GenType Type>
+    void dispatch(const Position& board, std::vector<Move>& move_list) {
+        if (board.to_move == Colour::White) generate<Colour::White, Type>(board, move_list);
+        else generate<Colour::Black, Type>(board, move_list);
     }
+}
 
-    // --- King ---
-    Bitboard king = board.pieces[(us == Colour::White) ? 5 : 11];
-    if (king) {
-        Square from = static_cast<Square>(BitUtil::lsb(king));
-        Bitboard moves = Attacks::KingAttacks[static_cast<int>(from)] & ~us_occ;
-        serialize_moves(from, moves & them_occ, move_list, MoveFlag::Capture);
-    }
+// Sampled spans when tracing; otherwise one untaken branch
+void generate_moves(const Position& board, std::vector<Move>& move_list) {
+    Trace::sampled(Trace::MoveGen, "generate_moves", "movegen", [&] { dispatch<All>(board, move_list); });
+}
 
-    // --- Sliders (Bishops, Rooks, Queens) ---
-    Bitboard bishops = board.pieces[(us == Colour::White) ? 2 : 8];
-    while (bishops) {
-        Square from = BitUtil::pop_lsb(bishops);
-        Bitboard moves = Attacks::get_bishop_attacks(static_cast<int>(from), all_occ);
-        serialize_moves(from, moves & them_occ, move_list, MoveFlag::Capture);
-    }
+void generate_captures(const Position& board, std::vector<Move>& move_list) {
+    Trace::sampled(Trace::MoveGen, "generate_captures", "movegen", [&] { dispatch<Captures>(board, move_list); });
+}
 
-    Bitboard rooks = board.pieces[(us == Colour::White) ? 3 : 9];
-    while (rooks) {
-        Square from = BitUtil::pop_lsb(rooks);
-        Bitboard moves = Attacks::get_rook_attacks(static_cast<int>(from), all_occ);
-        serialize_moves(from, moves & them_occ, move_list, MoveFlag::Capture);
-    }
+void generate_quiets(const Position& board, std::vector<Move>& move_list) {
+    Trace::sampled(Trace::MoveGen, "generate_quiets", "movegen", [&] { dispatch<Quiets>(board, move_list); });
+}
 
-    Bitboard queens = board.pieces[(us == Colour::White) ? 4 : 10];
-    while (queens) {
-        Square from = BitUtil::pop_lsb(queens);
-        Bitboard moves = Attacks::get_queen_attacks(static_cast<int>(from), all_occ);
-        serialize_moves(from, moves & them_occ, move_list, MoveFlag::Capture);
-    }
+void generate_evasions(const Position& board, std::vector<Move>& move_list) {
+    Trace::sampled(Trace::MoveGen, "generate_evasions", "movegen", [&] { dispatch<Evasions>(board, move_list); });
 }
 
 }
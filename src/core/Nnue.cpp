@@ -0,0 +1,276 @@
+#include "Nnue.hpp"
+#include "BoardState.hpp"
+#include "MappedFile.hpp"
+#include "Memory.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace Nnue {
+
+    static constexpr int32_t MAX_SCORE = 40000;     // Well inside the search's mate/TB bounds
+
+    // --- LOADING ---
+
+    template <typename T>
+    static bool read(const char*& p, const char* end, T* out, size_t count) {
+        size_t bytes = sizeof(T) * count;
+        if (static_cast<size_t>(end - p) < bytes) return false;
+        std::memcpy(out, p, bytes);
+        p += bytes;
+        return true;
+    }
+
+    bool load(const std::string& path, Network& net) {
+        MappedFile file;
+        if (!file.open(path)) return false;
+        const char* p = file.data();
+        const char* end = p + file.size();
+
+        char magic[4];
+        uint32_t version = 0, hidden = 0;
+        Network out;
+        if (!read(p, end, magic, 4) || std::memcmp(magic, "CENN", 4) != 0) return false;
+        if (!read(p, end, &version, 1) || version != 1) return false;
+        if (!read(p, end, &hidden, 1) || hidden == 0 || hidden % 16 != 0 || hidden > MAX_HIDDEN) return false;
+        if (!read(p, end, &out.scale, 1) || !read(p, end, &out.qa, 1) || !read(p, end, &out.qb, 1)) return false;
+        if (out.qa <= 0 || out.qa > 32767 || out.qb <= 0) return false;
+
+        out.hidden = static_cast<int>(hidden);
+        out.feature_weights.resize(static_cast<size_t>(INPUTS) * hidden);
+        out.feature_bias.resize(hidden);
+        out.output_weights.resize(2 * static_cast<size_t>(hidden));
+        if (!read(p, end, out.feature_weights.data(), out.feature_weights.size())) return false;
+        if (!read(p, end, out.feature_bias.data(), out.feature_bias.size())) return false;
+        if (!read(p, end, out.output_weights.data(), out.output_weights.size())) return false;
+        if (!read(p, end, &out.output_bias, 1) || p != end) return false;
+
+        net = std::move(out);
+        return true;
+    }
+
+    // --- KERNELS ---
+    // hidden is a multiple of 16, so every loop runs whole vectors
+
+    // dst = src + sum(add rows) - sum(sub rows)
+    static void update(int hidden, const int16_t* src, int16_t* dst,
+                       const int16_t* const* add, int num_add, const int16_t* const* sub, int num_sub) {
+#if defined(__AVX2__)
+        for (int i = 0; i < hidden; i += 16) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            for (int a = 0; a < num_add; ++a) v = _mm256_add_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(add[a] + i)));
+            for (int s = 0; s < num_sub; ++s) v = _mm256_sub_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sub[s] + i)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (int i = 0; i < hidden; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            for (int a = 0; a < num_add; ++a) v = _mm_add_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(add[a] + i)));
+            for (int s = 0; s < num_sub; ++s) v = _mm_sub_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sub[s] + i)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+        }
+#elif defined(__ARM_NEON)
+        for (int i = 0; i < hidden; i += 8) {
+            int16x8_t v = vld1q_s16(src + i);
+            for (int a = 0; a < num_add; ++a) v = vaddq_s16(v, vld1q_s16(add[a] + i));
+            for (int s = 0; s < num_sub; ++s) v = vsubq_s16(v, vld1q_s16(sub[s] + i));
+            vst1q_s16(dst + i, v);
+        }
+#else
+        for (int i = 0; i < hidden; ++i) {
+            int16_t v = src[i];
+            for (int a = 0; a < num_add; ++a) v = static_cast<int16_t>(v + add[a][i]);
+            for (int s = 0; s < num_sub; ++s) v = static_cast<int16_t>(v - sub[s][i]);
+            dst[i] = v;
+        }
+#endif
+    }
+
+    // sum(clamp(acc, 0, qa) * weights)
+    static int32_t crelu_dot(int hidden, const int16_t* acc, const int16_t* weights, int16_t qa) {
+#if defined(__AVX2__)
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i ceil = _mm256_set1_epi16(qa);
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < hidden; i += 16) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+            v = _mm256_min_epi16(_mm256_max_epi16(v, zero), ceil);
+            __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, w));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+        return _mm_cvtsi128_si32(s);
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ceil = _mm_set1_epi16(qa);
+        __m128i sum = _mm_setzero_si128();
+        for (int i = 0; i < hidden; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+            v = _mm_min_epi16(_mm_max_epi16(v, zero), ceil);
+            __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(v, w));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        return _mm_cvtsi128_si32(sum);
+#elif defined(__ARM_NEON)
+        const int16x8_t zero = vdupq_n_s16(0);
+        const int16x8_t ceil = vdupq_n_s16(qa);
+        int32x4_t sum = vdupq_n_s32(0);
+        for (int i = 0; i < hidden; i += 8) {
+            int16x8_t v = vminq_s16(vmaxq_s16(vld1q_s16(acc + i), zero), ceil);
+            int16x8_t w = vld1q_s16(weights + i);
+            sum = vmlal_s16(sum, vget_low_s16(v), vget_low_s16(w));
+            sum = vmlal_s16(sum, vget_high_s16(v), vget_high_s16(w));
+        }
+        return vaddvq_s32(sum);
+#else
+        int32_t sum = 0;
+        for (int i = 0; i < hidden; ++i) {
+            int32_t v = std::clamp<int32_t>(acc[i], 0, qa);
+            sum += v * weights[i];
+        }
+        return sum;
+#endif
+    }
+
+    // --- ACCUMULATORS ---
+
+    static const int16_t* weight_row(const Network& net, int perspective, int piece, int sq) {
+        return net.feature_weights.data() + static_cast<size_t>(feature_index(perspective, piece, sq)) * net.hidden;
+    }
+
+    static void refresh(const Network& net, const uint64_t* pieces, int perspective, int16_t* acc) {
+        std::memcpy(acc, net.feature_bias.data(), sizeof(int16_t) * net.hidden);
+        for (int piece = 0; piece < 12; ++piece) {
+            uint64_t bb = pieces[piece];
+            while (bb) {
+                int sq = static_cast<int>(BitUtil::pop_lsb(bb));
+                const int16_t* row = weight_row(net, perspective, piece, sq);
+                update(net.hidden, acc, acc, &row, 1, nullptr, 0);
+            }
+        }
+    }
+
+    static int32_t output(const Network& net, const int16_t* us, const int16_t* them) {
+        int16_t qa = static_cast<int16_t>(net.qa);
+        int64_t sum = static_cast<int64_t>(crelu_dot(net.hidden, us, net.output_weights.data(), qa))
+                    + crelu_dot(net.hidden, them, net.output_weights.data() + net.hidden, qa)
+                    + net.output_bias;
+        int64_t score = sum * net.scale / (static_cast<int64_t>(net.qa) * net.qb);
+        return static_cast<int32_t>(std::clamp<int64_t>(score, -MAX_SCORE, MAX_SCORE));
+    }
+
+    void AccumulatorStack::reset(const Network& network, const BoardState& board) {
+        net = &network;
+        top = 0;
+        values.resize(static_cast<size_t>(STACK_SIZE) * 2 * network.hidden);
+        for (int p = 0; p < 2; ++p) refresh(network, board.pieces.data(), p, accumulator(0, p));
+        computed[0] = true;
+    }
+
+    void push(AccumulatorStack& stack, const DirtyPieces& dirty) {
+        ++stack.top;
+        stack.dirty[stack.top] = dirty;
+        stack.computed[stack.top] = false;
+    }
+
+    void pop(AccumulatorStack& stack) {
+        --stack.top;
+    }
+
+    int32_t evaluate(AccumulatorStack& stack, int side) {
+        const Network& net = *stack.net;
+        int base = stack.top;
+        while (!stack.computed[base]) --base;
+
+        for (int ply = base + 1; ply <= stack.top; ++ply) {
+            const DirtyPieces& d = stack.dirty[ply];
+            for (int p = 0; p < 2; ++p) {
+                const int16_t* add[2];
+                const int16_t* sub[2];
+                for (int i = 0; i < d.num_added; ++i) add[i] = weight_row(net, p, d.added[i][0], d.added[i][1]);
+                for (int i = 0; i < d.num_removed; ++i) sub[i] = weight_row(net, p, d.removed[i][0], d.removed[i][1]);
+                update(net.hidden, stack.accumulator(ply - 1, p), stack.accumulator(ply, p),
+                       add, d.num_added, sub, d.num_removed);
+            }
+            stack.computed[ply] = true;
+        }
+        return output(net, stack.accumulator(stack.top, side), stack.accumulator(stack.top, side ^ 1));
+    }
+
+    int32_t evaluate(const Network& net, const uint64_t* pieces, int side) {
+        alignas(64) int16_t acc[2][MAX_HIDDEN];
+        refresh(net, pieces, 0, acc[0]);
+        refresh(net, pieces, 1, acc[1]);
+        return output(net, acc[side], acc[side ^ 1]);
+    }
+
+    // --- REGISTERED NETWORKS ---
+    // Each slot has its own trampoline, so a network is reachable through a plain eval pointer
+
+    static Network networks[MAX_NETWORKS];
+    static std::atomic<int> num_networks{0};
+    static std::mutex networks_mutex;
+
+    template <int Slot>
+    static int32_t evaluate_slot(const uint64_t* pieces, const uint64_t*, uint32_t side) {
+        return evaluate(networks[Slot], pieces, static_cast<int>(side & 1));
+    }
+
+    template <size_t... Slots>
+    static constexpr std::array<EvalHandle, sizeof...(Slots)> make_handles(std::index_sequence<Slots...>) {
+        return {evaluate_slot<Slots>...};
+    }
+    static constexpr auto slot_handles = make_handles(std::make_index_sequence<MAX_NETWORKS>());
+
+    EvalHandle register_network(Network&& net) {
+        std::lock_guard<std::mutex> lock(networks_mutex);
+        int n = num_networks.load(std::memory_order_relaxed);
+        if (n >= MAX_NETWORKS) return nullptr;
+        networks[n] = std::move(net);
+        num_networks.store(n + 1, std::memory_order_release);
+        return slot_handles[n];
+    }
+
+    // Per-node copies, each made by the first thread to ask from that node so its pages
+    // are local there. Like the networks themselves they live until exit.
+    static std::atomic<const Network*> replicas[MAX_NETWORKS][Memory::MAX_NODES];
+
+    static const Network* replica(int slot) {
+        int node = std::min(Memory::current_node(), Memory::MAX_NODES - 1);
+        const Network* copy = replicas[slot][node].load(std::memory_order_acquire);
+        if (copy) return copy;
+        std::lock_guard<std::mutex> lock(networks_mutex);
+        copy = replicas[slot][node].load(std::memory_order_relaxed);
+        if (!copy) {
+            copy = new Network(networks[slot]);
+            replicas[slot][node].store(copy, std::memory_order_release);
+        }
+        return copy;
+    }
+
+    const Network* network_for(EvalHandle fn) {
+        if (!fn) return nullptr;
+        int n = num_networks.load(std::memory_order_acquire);
+        for (int i = 0; i < n; ++i) {
+            if (slot_handles[i] != fn) continue;
+            if (Memory::options().replicate && Memory::num_nodes() > 1) return replica(i);
+            return &networks[i];
+        }
+        return nullptr;
+    }
+}
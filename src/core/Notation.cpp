@@ -0,0 +1,137 @@
+#include "Notation.hpp"
+#include "MoveGen.hpp"
+#include "Attacks.hpp"
+#include "Search.hpp"
+
+namespace Notation {
+
+    void legal_moves(BoardState& board, std::vector<Move>& out) {
+        out.clear();
+        std::vector<Move> pseudo;
+        MoveGen::generate_moves(board, pseudo);
+
+        for (const auto& m : pseudo) {
+            board.make_move(m);
+            Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+            Square k = Search::find_king(board, us);
+            bool illegal = Attacks::is_square_attacked(
+                k, board.to_move, board.pieces.data(), board.occupancy[2]);
+            board.undo_move(m);
+            if (!illegal) out.push_back(m);
+        }
+    }
+
+    // --- HELPERS ---
+
+    static int piece_type_at(const BoardState& board, int sq) {
+        uint64_t bit = 1ULL << sq;
+        for (int p = 0; p < 12; ++p) {
+            if (board.pieces[p] & bit) return p % 6;
+        }
+        return -1;
+    }
+
+    // 'n','b','r','q' (either case) -> promotion test on a Move; 0 = not a promotion
+    static bool promo_matches(const Move& m, char promo) {
+        if (promo == 0) return !m.is_promotion();
+        if (!m.is_promotion()) return false;
+        switch (promo | 0x20) {
+            case 'n': return m.is_promo_knight();
+            case 'b': return m.is_promo_bishop();
+            case 'r': return m.is_promo_rook();
+            case 'q': return m.is_promo_queen();
+        }
+        return false;
+    }
+
+    static bool is_file(char c) { return c >= 'a' && c <= 'h'; }
+    static bool is_rank(char c) { return c >= '1' && c <= '8'; }
+
+    Move parse_uci(BoardState& board, std::string_view uci) {
+        if (uci.size() < 4 || !is_file(uci[0]) || !is_rank(uci[1])
+            || !is_file(uci[2]) || !is_rank(uci[3])) return Move();
+
+        int from = (uci[1] - '1') * 8 + (uci[0] - 'a');
+        int to   = (uci[3] - '1') * 8 + (uci[2] - 'a');
+        char promo = (uci.size() >= 5) ? uci[4] : 0;
+
+        std::vector<Move> moves;
+        legal_moves(board, moves);
+        for (const auto& m : moves) {
+            if (static_cast<int>(m.from()) == from && static_cast<int>(m.to()) == to
+                && promo_matches(m, promo)) return m;
+        }
+        return Move();
+    }
+
+    Move parse_san(BoardState& board, std::string_view san) {
+        // Strip check, mate and annotation suffixes
+        while (!san.empty()) {
+            char c = san.back();
+            if (c == '+' || c == '#' || c == '!' || c == '?') san.remove_suffix(1);
+            else break;
+        }
+        if (san.empty()) return Move();
+
+        std::vector<Move> moves;
+        legal_moves(board, moves);
+
+        // --- CASTLING ---
+        if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+            MoveFlag want = (san.size() == 3) ? MoveFlag::KingCastle : MoveFlag::QueenCastle;
+            for (const auto& m : moves) {
+                if (m.flag() == want) return m;
+            }
+            return Move();
+        }
+
+        int piece = 0;  // Pawn
+        switch (san.front()) {
+            case 'N': piece = 1; break;
+            case 'B': piece = 2; break;
+            case 'R': piece = 3; break;
+            case 'Q': piece = 4; break;
+            case 'K': piece = 5; break;
+        }
+        if (piece != 0) san.remove_prefix(1);
+
+        // Promotion: "e8=Q" or "e8Q"
+        char promo = 0;
+        if (piece == 0 && san.size() >= 3) {
+            char c = san.back();
+            if (c == 'N' || c == 'B' || c == 'R' || c == 'Q') {
+                promo = c;
+                san.remove_suffix(1);
+                if (!san.empty() && san.back() == '=') san.remove_suffix(1);
+            }
+        }
+
+        if (san.size() < 2 || !is_file(san[san.size() - 2]) || !is_rank(san.back())) return Move();
+        int to = (san.back() - '1') * 8 + (san[san.size() - 2] - 'a');
+        san.remove_suffix(2);
+
+        // Whatever is left is disambiguation plus an optional 'x'
+        int from_file = -1;
+        int from_rank = -1;
+        for (char c : san) {
+            if (is_file(c)) from_file = c - 'a';
+            else if (is_rank(c)) from_rank = c - '1';
+            else if (c != 'x' && c != ':') return Move();
+        }
+
+        Move found;
+        int matches = 0;
+        for (const auto& m : moves) {
+            int from = static_cast<int>(m.from());
+            if (static_cast<int>(m.to()) != to) continue;
+            if (m.flag() == MoveFlag::KingCastle || m.flag() == MoveFlag::QueenCastle) continue;
+            if (piece_type_at(board, from) != piece) continue;
+            if (from_file >= 0 && from % 8 != from_file) continue;
+            if (from_rank >= 0 && from / 8 != from_rank) continue;
+            if (!promo_matches(m, promo)) continue;
+            found = m;
+            ++matches;
+        }
+        return (matches == 1) ? found : Move();
+    }
+}
@@ -0,0 +1,163 @@
+#include "PerfCounters.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace PerfCounters {
+
+    static const char* EVENT_NAMES[NUM_EVENTS] = {
+        "cycles", "instructions", "l1d-misses", "llc-misses", "branch-misses"
+    };
+
+    const char* event_name(int event) {
+        return (event >= 0 && event < NUM_EVENTS) ? EVENT_NAMES[event] : "?";
+    }
+
+    Values difference(const Values& end, const Values& start) {
+        Values d;
+        for (int e = 0; e < NUM_EVENTS; ++e) {
+            if (end.counts[e] >= 0 && start.counts[e] >= 0) d.counts[e] = end.counts[e] - start.counts[e];
+        }
+        return d;
+    }
+
+    void accumulate(Values& total, const Values& delta) {
+        for (int e = 0; e < NUM_EVENTS; ++e) {
+            if (delta.counts[e] < 0) continue;
+            total.counts[e] = std::max<int64_t>(total.counts[e], 0) + delta.counts[e];
+        }
+    }
+
+#ifdef __linux__
+    static void describe(int event, perf_event_attr& attr) {
+        attr.type = PERF_TYPE_HARDWARE;
+        switch (event) {
+            case Cycles:       attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+            case Instructions: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+            case LLCMisses:    attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+            case BranchMisses: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+            case L1DMisses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D
+                            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+        }
+    }
+
+    // Members of a group are scheduled together and read with one syscall. The leader
+    // starts disabled so every counter starts at the same instant.
+    static int open_event(int event, int group_fd) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        describe(event, attr);
+        attr.disabled = (group_fd == -1) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+
+    static std::string refusal(int err) {
+        std::string text = std::strerror(err);
+        if (err == EACCES || err == EPERM) {
+            std::ifstream f("/proc/sys/kernel/perf_event_paranoid");
+            int level;
+            if (f >> level) text += " (perf_event_paranoid = " + std::to_string(level) + ")";
+        } else if (err == ENOENT || err == EOPNOTSUPP || err == ENODEV) {
+            text += " (no hardware PMU, e.g. inside a VM)";
+        }
+        return text;
+    }
+#endif
+
+    Group::Group() {
+        for (int e = 0; e < NUM_EVENTS; ++e) {
+            fds[e] = -1;
+            slots[e] = -1;
+        }
+#ifdef __linux__
+        std::string refused;
+        int err = 0;
+        for (int e = 0; e < NUM_EVENTS; ++e) {
+            int fd = open_event(e, leader);
+            if (fd < 0) {
+                if (refused.empty()) err = errno;
+                refused += refused.empty() ? EVENT_NAMES[e] : std::string(", ") + EVENT_NAMES[e];
+                continue;
+            }
+            if (leader < 0) leader = fd;
+            fds[e] = fd;
+            slots[e] = num_open++;
+        }
+        if (leader >= 0) {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+        if (num_open == 0) why = refusal(err);
+        else if (!refused.empty()) why = refused + " refused: " + refusal(err);
+#else
+        why = "hardware counters need Linux perf_event_open";
+#endif
+    }
+
+    Group::~Group() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    Values Group::read() const {
+        Values v;
+#ifdef __linux__
+        if (leader < 0) return v;
+        // nr, time enabled, time running, then one value per member
+        uint64_t buf[3 + NUM_EVENTS];
+        ssize_t n = ::read(leader, buf, sizeof(buf));
+        if (n < static_cast<ssize_t>(3 * sizeof(uint64_t))) return v;
+        uint64_t enabled = buf[1], running = buf[2];
+        if (running == 0) return v;     // Never got onto the PMU
+        double scale = (running < enabled) ? static_cast<double>(enabled) / static_cast<double>(running) : 1.0;
+        for (int e = 0; e < NUM_EVENTS; ++e) {
+            if (slots[e] < 0 || static_cast<uint64_t>(slots[e]) >= buf[0]) continue;
+            v.counts[e] = static_cast<int64_t>(static_cast<double>(buf[3 + slots[e]]) * scale);
+        }
+#endif
+        return v;
+    }
+
+    std::string summary(const Values& v, uint64_t count, const std::string& status, const char* unit) {
+        const int64_t* c = v.counts;
+        bool any = false;
+        for (int e = 0; e < NUM_EVENTS; ++e) any = any || c[e] >= 0;
+        if (!any) return "counters unavailable" + (status.empty() ? std::string() : " (" + status + ")");
+
+        std::string out;
+        char buf[64];
+        if (c[Cycles] > 0 && c[Instructions] >= 0) {
+            std::snprintf(buf, sizeof(buf), "ipc %.2f", static_cast<double>(c[Instructions]) / static_cast<double>(c[Cycles]));
+            out += buf;
+        }
+        double per = 1.0 / static_cast<double>(std::max<uint64_t>(count, 1));
+        for (int e = 0; e < NUM_EVENTS; ++e) {
+            if (c[e] < 0) continue;
+            const char* format = (e == Cycles || e == Instructions) ? "%s%s/%s %.1f" : "%s%s/%s %.3f";
+            std::snprintf(buf, sizeof(buf), format, out.empty() ? "" : " ", EVENT_NAMES[e], unit,
+                          static_cast<double>(c[e]) * per);
+            out += buf;
+        }
+        return out;
+    }
+}
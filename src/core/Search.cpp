@@ -1,12 +1,20 @@
 #include "Search.hpp"
+#include "SearchCoroutine.hpp"
+#include "Mcts.hpp"
 #include "MoveGen.hpp"
 #include "BoardState.hpp"
 #include "Attacks.hpp"
 #include "BitUtil.hpp" 
+#include "Tablebase.hpp"
+#include "Evaluation.hpp"
+#include "Trace.hpp"
 #include <vector>
 #include <algorithm>
 #include <iostream>
 #include <cstring>
+#include <chrono>
+#include <memory>
+#include <mutex>
 
 namespace Search {
 
@@ -20,26 +28,160 @@ namespace Search {
         {100, 200, 300, 400, 500, 600}  // Victim K
     };
 
-    // --- KILLER MOVES ---
-    // Two killer slots per ply. Killers are quiet moves that caused beta cutoffs.
-    static constexpr int MAX_PLY = 128;
-    static Move killers[MAX_PLY][2];
+    // --- SEARCH STATE ---
+    // Killers, history and TT for the search running on this thread. Without a persistent
+    // state the search uses a thread-local scratch state (no TT) that is wiped every move,
+    // so concurrent games (tournament workers) never share tables.
+    static thread_local SearchState scratch_state(0);
+    static thread_local SearchState* st = nullptr;
 
-    // --- HISTORY HEURISTIC ---
-    // history[side][from_sq][to_sq] — incremented when a quiet move causes a cutoff
-    static int history[2][64][64];
+    static constexpr int32_t MATE_BOUND = 90000;
+    static constexpr int32_t TB_WIN = 80000;    // Known tablebase win, below any mate score
 
-    static void clear_heuristics() {
+    SearchState::SearchState(size_t hash_mb) {
+        resize(hash_mb);
+    }
+
+    SearchState::~SearchState() = default;
+    SearchState::SearchState(SearchState&&) noexcept = default;
+    SearchState& SearchState::operator=(SearchState&&) noexcept = default;
+
+    void SearchState::resize(size_t hash_mb) {
+        size_t entries = 0;
+        if (hash_mb > 0) {
+            size_t target = hash_mb * 1024 * 1024 / sizeof(TTEntry);
+            entries = 1;
+            while (entries * 2 <= target) entries *= 2;
+        }
+        tt.reset(entries);
+        clear();
+    }
+
+    void SearchState::clear() {
         std::memset(killers, 0, sizeof(killers));
         std::memset(history, 0, sizeof(history));
+        tt.reset(tt.size());    // Zero pages are empty entries; cheaper than a fill for big tables
+        generation = 0;
+        last_root_key = 0;
+        expected_key = 0;
+        ponder_hit = false;
+        tree.reset();
+    }
+
+    void SearchState::prepare(const BoardState& board) {
+        size_t n = board.history.size();
+        bool same_root = (last_root_key != 0 && board.key == last_root_key);
+        bool two_plies_on = (last_root_key != 0 && board.history.held() >= 2 && board.history[n - 2].key == last_root_key);
+
+        ponder_hit = two_plies_on && (board.key == expected_key);
+
+        if (!same_root && !two_plies_on) {
+            clear();    // New game, undo, or a position we never searched towards
+        } else if (two_plies_on) {
+            // Age rather than wipe: the old ply p + 2 is the new ply p
+            for (int p = 0; p + 2 < MAX_PLY; ++p) {
+                killers[p][0] = killers[p + 2][0];
+                killers[p][1] = killers[p + 2][1];
+            }
+            for (int p = MAX_PLY - 2; p < MAX_PLY; ++p) killers[p][0] = killers[p][1] = Move();
+            for (auto& side : history)
+                for (auto& row : side)
+                    for (auto& v : row)
+                        v >>= 1;
+            generation = (generation + 1) & 63;
+        }
+        last_root_key = board.key;
+    }
+
+    TTEntry* SearchState::probe(uint64_t key) {
+        if (tt.empty()) return nullptr;
+        TTEntry& e = tt[key & (tt.size() - 1)];
+        return (e.key == key) ? &e : nullptr;
+    }
+
+    void SearchState::store(uint64_t key, int depth, int32_t score, Bound bound, uint16_t move, int ply) {
+        if (tt.empty()) return;
+        TTEntry& e = tt[key & (tt.size() - 1)];
+
+        // Replace stale generations, shallower entries, or anything for the same position
+        bool stale = ((e.bound_gen >> 2) != generation);
+        if (e.key != key && !stale && depth < e.depth) return;
+        if (e.key == key && move == 0) move = e.move;
+
+        // Mate scores are stored relative to this node, not the root
+        if (score > MATE_BOUND) score += ply;
+        else if (score < -MATE_BOUND) score -= ply;
+
+        e.key = key;
+        e.score = score;
+        e.move = move;
+        e.depth = static_cast<int8_t>(depth);
+        e.bound_gen = static_cast<uint8_t>((generation << 2) | static_cast<uint8_t>(bound));
+    }
+
+    // Nodes visited by the current search on this thread
+    static thread_local uint64_t nodes_searched = 0;
+    static thread_local uint64_t tt_cutoffs = 0;
+    static thread_local uint64_t tb_probes = 0;
+    static thread_local uint64_t eval_calls = 0;
+    static thread_local uint64_t lazy_skips = 0;
+
+    // --- TIME CONTROL ---
+    // The hard limit, node limit and stop flag are only armed once depth 1 has completed,
+    // so a move always exists.
+    static constexpr int MAX_SEARCH_DEPTH = 64;
+    static constexpr uint64_t TIME_CHECK_MASK = 127;
+    static thread_local std::chrono::steady_clock::time_point search_start;
+    static thread_local int64_t hard_limit_ms = 0;
+    static thread_local uint64_t node_limit = 0;
+    static thread_local const std::atomic<bool>* stop_flag = nullptr;
+    static thread_local bool limits_armed = false;
+    static thread_local bool search_aborted = false;
+    static thread_local ContextEvalCallback context_eval = nullptr;
+    static thread_local int32_t lazy_margin = 0;
+    static thread_local bool copy_make = false;
+    static thread_local BatchEvalCallback batch_eval = nullptr;
+    static thread_local std::vector<PendingEval*>* eval_queue = nullptr;
+    static thread_local std::coroutine_handle<> resume_point;
+
+    static int64_t elapsed_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - search_start).count();
+    }
+
+    static bool stop_requested() {
+        return stop_flag && stop_flag->load(std::memory_order_relaxed);
+    }
+
+    static bool should_stop() {
+        if (search_aborted) return true;
+        if (!limits_armed) return false;
+        if (node_limit > 0 && nodes_searched >= node_limit) {
+            search_aborted = true;
+        } else if ((nodes_searched & TIME_CHECK_MASK) == 0) {
+            if (stop_requested() || (hard_limit_ms > 0 && elapsed_ms() >= hard_limit_ms))
+                search_aborted = true;
+        }
+        return search_aborted;
+    }
+
+    void allocate_time(int64_t remaining_ms, int64_t increment_ms, int moves_to_go, SearchParams& params) {
+        static constexpr int64_t MOVE_OVERHEAD_MS = 20;
+        int mtg = (moves_to_go > 0) ? std::min(moves_to_go, 40) : 30;
+
+        int64_t usable = std::max<int64_t>(1, remaining_ms - MOVE_OVERHEAD_MS);
+        int64_t target = usable / mtg + increment_ms * 3 / 4;
+
+        params.soft_time_ms = std::max<int64_t>(1, std::min(target, usable / 2));
+        params.hard_time_ms = std::max<int64_t>(1, std::min(target * 4, usable * 3 / 4));
     }
 
     static void store_killer(const Move& m, int ply) {
         if (ply >= MAX_PLY) return;
         // Don't store duplicates
-        if (killers[ply][0].raw() == m.raw()) return;
-        killers[ply][1] = killers[ply][0];
-        killers[ply][0] = m;
+        if (st->killers[ply][0].raw() == m.raw()) return;
+        st->killers[ply][1] = st->killers[ply][0];
+        st->killers[ply][0] = m;
     }
 
     static void update_history(const Move& m, Colour side, int depth) {
@@ -47,10 +189,10 @@ namespace Search {
         int from = static_cast<int>(m.from());
         int to   = static_cast<int>(m.to());
         // Bonus proportional to depth^2 (deeper cutoffs are more valuable)
-        history[s][from][to] += depth * depth;
+        st->history[s][from][to] += depth * depth;
         // Prevent overflow — cap and age
-        if (history[s][from][to] > 400000) {
-            for (auto& row : history[s])
+        if (st->history[s][from][to] > 400000) {
+            for (auto& row : st->history[s])
                 for (auto& v : row)
                     v >>= 1;
         }
@@ -83,205 +225,378 @@ namespace Search {
 
         // 3. Killer moves (quiet moves that caused cutoffs at this ply)
         if (ply < MAX_PLY) {
-            if (m.raw() == killers[ply][0].raw()) return 8000;
-            if (m.raw() == killers[ply][1].raw()) return 7000;
+            if (m.raw() == st->killers[ply][0].raw()) return 8000;
+            if (m.raw() == st->killers[ply][1].raw()) return 7000;
         }
 
         // 4. History heuristic (quiet move ordering)
         int side = (board.to_move == Colour::White) ? 0 : 1;
-        return history[side][static_cast<int>(m.from())][static_cast<int>(m.to())];
+        return st->history[side][static_cast<int>(m.from())][static_cast<int>(m.to())];
     }
 
-    // --- Quiescence Search ---
-    static constexpr int QS_MAX_DEPTH = 8;
-    static constexpr int DELTA_MARGIN  = 900;
-
-    int32_t quiescence(BoardState& board, int32_t alpha, int32_t beta, EvalCallback eval, uint32_t moves_played, int qs_depth) {
-        int32_t stand_pat = eval(board.pieces.data(), board.occupancy.data(), (board.to_move == Colour::White ? 0 : 1));
-        if (stand_pat >= beta) return beta;
-        if (stand_pat > alpha) alpha = stand_pat;
+    // --- CONTEXT EVALS ---
+    // Handles are the registered pointers themselves; lookups only read, so they stay lock-free
+    static constexpr int MAX_CONTEXT_EVALS = 256;
+    static std::atomic<ContextEvalCallback> context_evals[MAX_CONTEXT_EVALS];
+    static std::atomic<int> num_context_evals{0};
+    static std::mutex context_evals_mutex;
+
+    // Through void(*)() so the compiler knows the type change is intended; only ever called
+    // after context_eval_for() casts back
+    static EvalCallback as_handle(ContextEvalCallback fn) {
+        return reinterpret_cast<EvalCallback>(reinterpret_cast<void (*)()>(fn));
+    }
 
-        if (qs_depth >= QS_MAX_DEPTH) return alpha;
+    EvalCallback register_context_eval(ContextEvalCallback fn) {
+        std::lock_guard<std::mutex> lock(context_evals_mutex);
+        EvalCallback handle = as_handle(fn);
+        if (context_eval_for(handle)) return handle;
 
-        std::vector<Move> moves;
-        moves.reserve(32); 
-        MoveGen::generate_captures(board, moves);
+        int n = num_context_evals.load(std::memory_order_relaxed);
+        if (n >= MAX_CONTEXT_EVALS) return nullptr;
+        context_evals[n].store(fn, std::memory_order_relaxed);
+        num_context_evals.store(n + 1, std::memory_order_release);
+        return handle;
+    }
 
-        // Sort captures by MVV-LVA (ply doesn't matter for captures, pass 0)
-        std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
-            return score_move(a, board, 0) > score_move(b, board, 0);
-        });
+    ContextEvalCallback context_eval_for(EvalCallback fn) {
+        if (!fn) return nullptr;
+        int n = num_context_evals.load(std::memory_order_acquire);
+        for (int i = 0; i < n; ++i) {
+            ContextEvalCallback c = context_evals[i].load(std::memory_order_relaxed);
+            if (as_handle(c) == fn) return c;
+        }
+        return nullptr;
+    }
 
-        for (const auto& move : moves) {
-            if (!move.is_promotion() && stand_pat + DELTA_MARGIN < alpha) {
-                break;
+    // --- LAZY EVAL ---
+    // Margins are looked up once per search, so a mutex is fine here
+    static std::vector<std::pair<EvalCallback, int32_t>> lazy_margins;
+    static std::mutex lazy_margins_mutex;
+    static std::atomic<uint64_t> total_eval_calls{0};
+    static std::atomic<uint64_t> total_lazy_skips{0};
+
+    void set_lazy_margin(EvalCallback fn, int32_t margin) {
+        std::lock_guard<std::mutex> lock(lazy_margins_mutex);
+        margin = std::max(margin, 0);
+        for (auto& entry : lazy_margins) {
+            if (entry.first == fn) {
+                entry.second = margin;
+                return;
             }
+        }
+        if (margin > 0) lazy_margins.emplace_back(fn, margin);
+    }
 
-            board.make_move(move);
-            
-            Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
-            Square king_sq = find_king(board, us);
-            if (Attacks::is_square_attacked(king_sq, board.to_move, board.pieces.data(), board.occupancy[2])) {
-                board.undo_move(move);
-                continue;
-            }
+    int32_t lazy_margin_for(EvalCallback fn) {
+        std::lock_guard<std::mutex> lock(lazy_margins_mutex);
+        for (const auto& entry : lazy_margins) {
+            if (entry.first == fn) return entry.second;
+        }
+        return 0;
+    }
+
+    void lazy_eval_totals(uint64_t& calls, uint64_t& skipped, bool reset) {
+        calls = reset ? total_eval_calls.exchange(0) : total_eval_calls.load();
+        skipped = reset ? total_lazy_skips.exchange(0) : total_lazy_skips.load();
+    }
 
-            int32_t score = -quiescence(board, -beta, -alpha, eval, moves_played + 1, qs_depth + 1);
-            board.undo_move(move);
+    // --- BATCH EVALS ---
+    static std::vector<std::pair<EvalCallback, BatchEvalCallback>> batch_evals;
+    static std::mutex batch_evals_mutex;
 
-            if (score >= beta) return beta;
-            if (score > alpha) alpha = score;
+    void register_batch_eval(EvalCallback fn, BatchEvalCallback batch) {
+        std::lock_guard<std::mutex> lock(batch_evals_mutex);
+        for (auto& entry : batch_evals) {
+            if (entry.first == fn) {
+                entry.second = batch;
+                return;
+            }
         }
-        return alpha;
+        if (batch) batch_evals.emplace_back(fn, batch);
     }
 
-    // --- Main Alpha-Beta with PVS ---
-    int32_t alpha_beta(BoardState& board, int depth, int32_t alpha, int32_t beta, EvalCallback eval, int ply) {
-        if (ply > 0 && board.is_draw()) {
-            return 0;
+    BatchEvalCallback batch_eval_for(EvalCallback fn) {
+        std::lock_guard<std::mutex> lock(batch_evals_mutex);
+        for (const auto& entry : batch_evals) {
+            if (entry.first == fn) return entry.second;
         }
+        return nullptr;
+    }
 
-        if (depth == 0) {
-            return quiescence(board, alpha, beta, eval, ply, 0);
+    // --- SEARCH BACKENDS ---
+    static std::vector<std::pair<EvalCallback, MctsOptions>> mcts_backends;
+    static std::mutex mcts_backends_mutex;
+
+    void set_mcts_backend(EvalCallback fn, const MctsOptions* options) {
+        std::lock_guard<std::mutex> lock(mcts_backends_mutex);
+        for (auto it = mcts_backends.begin(); it != mcts_backends.end(); ++it) {
+            if (it->first == fn) {
+                if (options) it->second = *options;
+                else mcts_backends.erase(it);
+                return;
+            }
         }
+        if (options) mcts_backends.emplace_back(fn, *options);
+    }
+
+    bool mcts_options_for(EvalCallback fn, MctsOptions& out) {
+        std::lock_guard<std::mutex> lock(mcts_backends_mutex);
+        for (const auto& entry : mcts_backends) {
+            if (entry.first == fn) {
+                out = entry.second;
+                return true;
+            }
+        }
+        return false;
+    }
 
-        std::vector<Move> moves;
-        MoveGen::generate_moves(board, moves);
+    // --- NATIVE NETWORKS ---
+    // A search with a registered network attaches this thread's accumulator stack to the
+    // board, so make_move/undo_move keep the first layer current
+    static thread_local Nnue::AccumulatorStack nnue_stack;
+
+    struct NnueScope {
+        BoardState& board;
+        NnueScope(BoardState& b, const Nnue::Network* net) : board(b) {
+            if (!net) return;
+            nnue_stack.reset(*net, board);
+            board.nnue = &nnue_stack;
+        }
+        ~NnueScope() { board.nnue = nullptr; }
+    };
 
-        // Sort moves: captures (MVV-LVA) > promotions > killers > history
-        std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
-            return score_move(a, board, ply) > score_move(b, board, ply);
+    static int32_t evaluate(const BoardState& board, EvalCallback eval) {
+        return Trace::sampled(Trace::Eval, "eval", "eval", [&]() -> int32_t {
+            uint32_t side = (board.to_move == Colour::White ? 0 : 1);
+            if (board.nnue) return Nnue::evaluate(*board.nnue, static_cast<int>(side));
+            if (context_eval) {
+                EvalContext ctx;
+                Context::build(board, ctx);
+                return context_eval(board.pieces.data(), board.occupancy.data(), side, &ctx);
+            }
+            return eval(board.pieces.data(), board.occupancy.data(), side);
         });
+    }
 
-        int legal_moves = 0;
-        Colour us_before_move = board.to_move;
+    // --- HARDWARE COUNTERS ---
+    // Opened by the thread's first profiled search and kept until the thread exits
+    static thread_local std::unique_ptr<PerfCounters::Group> counter_group;
+    static thread_local const PerfCounters::Group* profile_group = nullptr;    // Profiled search running
+    static thread_local PerfCounters::Values profile_start;
 
-        for (const auto& move : moves) {
-            board.make_move(move);
+    static PerfCounters::Group& thread_counters() {
+        if (!counter_group) counter_group = std::make_unique<PerfCounters::Group>();
+        return *counter_group;
+    }
 
-            Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White; 
-            Square king_sq = find_king(board, us);
-            if (Attacks::is_square_attacked(king_sq, board.to_move, board.pieces.data(), board.occupancy[2])) {
-                board.undo_move(move);
-                continue;
-            }
+    const std::string& counters_status() {
+        return thread_counters().status();
+    }
 
-            int32_t score;
-            if (legal_moves == 0) {
-                // First legal move (expected best) — search with full window
-                score = -alpha_beta(board, depth - 1, -beta, -alpha, eval, ply + 1);
-            } else {
-                // PVS: search with null window first
-                score = -alpha_beta(board, depth - 1, -alpha - 1, -alpha, eval, ply + 1);
-                // If it beats alpha but not beta, re-search with full window
-                if (score > alpha && score < beta) {
-                    score = -alpha_beta(board, depth - 1, -beta, -alpha, eval, ply + 1);
-                }
-            }
+    static void read_counters(SearchStats& stats) {
+        if (profile_group) stats.counters = PerfCounters::difference(profile_group->read(), profile_start);
+    }
 
-            board.undo_move(move);
-            legal_moves++;
+    // --- MAKE / UNMAKE ---
+    // In copy-make mode (SearchParams::copy_make) the tree keeps the Position from before
+    // each move and copies it back, instead of undoing the move incrementally
+    static inline void play_move(BoardState& board, Move move, Position& saved) {
+        if (copy_make) saved = board;
+        board.make_move(move);
+    }
 
-            if (score >= beta) {
-                // Beta cutoff — update killer and history for quiet moves
-                if (!move.is_capture() && !move.is_promotion()) {
-                    store_killer(move, ply);
-                    update_history(move, us_before_move, depth);
-                }
-                return beta;
-            }
-            if (score > alpha) {
-                alpha = score;
+    static inline void take_back(BoardState& board, Move move, const Position& saved) {
+        if (copy_make) board.restore(saved);
+        else board.undo_move(move);
+    }
+
+    // Quiescence limits
+    static constexpr int QS_MAX_DEPTH = 8;
+    static constexpr int DELTA_MARGIN  = 900;
+    // --- BATCHED EVALS ---
+    // Evals of a coroutine search whose callback has a batch version are queued instead:
+    // the search suspends until whoever drives it has filled in the score
+    struct EvalRequest {
+        const BoardState& board;
+        EvalCallback eval;
+        PendingEval pending{};
+
+        bool await_ready() {
+            if (board.nnue || context_eval || !batch_eval) {
+                pending.score = evaluate(board, eval);
+                return true;
             }
+            return false;
         }
-
-        if (legal_moves == 0) {
-            Colour us = board.to_move;
-            Square king_sq = find_king(board, us);
-            bool in_check = Attacks::is_square_attacked(king_sq, (us == Colour::White ? Colour::Black : Colour::White), board.pieces.data(), board.occupancy[2]);
-            if (in_check) return -100000 + ply; 
-            return 0;
+        void await_suspend(std::coroutine_handle<> waiter) {
+            pending.board = &board;
+            pending.batch = batch_eval;
+            eval_queue->push_back(&pending);
+            resume_point = waiter;
         }
+        int32_t await_resume() const { return pending.score; }
+    };
 
-        return alpha;
+    // --- SEARCH TREE ---
+    namespace Direct {
+        #define SEARCH_TASK(T) T
+        #define SEARCH_AWAIT(call) (call)
+        #define SEARCH_RETURN return
+        #define SEARCH_EVAL(b, e) evaluate(b, e)
+        #include "SearchTree.inl"
+        #undef SEARCH_TASK
+        #undef SEARCH_AWAIT
+        #undef SEARCH_RETURN
+        #undef SEARCH_EVAL
+    }
+
+    namespace Suspending {
+        #define SEARCH_TASK(T) Task<T>
+        #define SEARCH_AWAIT(call) (co_await (call))
+        #define SEARCH_RETURN co_return
+        #define SEARCH_EVAL(b, e) co_await EvalRequest{b, e}
+        #include "SearchTree.inl"
+        #undef SEARCH_TASK
+        #undef SEARCH_AWAIT
+        #undef SEARCH_RETURN
+        #undef SEARCH_EVAL
     }
 
-    // --- Iterative Deepening with PVS at root ---
     Move iterative_deepening(BoardState& board, const SearchParams& params, SearchStats& stats) {
-        Move best_move;
-        
-        stats.depth_reached = 0;
-        stats.score = 0;
-
-        // Clear killer and history tables at the start of each search
-        clear_heuristics();
-
-        for (int d = 1; d <= params.depth; ++d) {
-            int32_t alpha = -200000;
-            int32_t beta = 200000;
-            
-            std::vector<Move> moves;
-            MoveGen::generate_moves(board, moves);
-            
-            // Sort moves — at root, also boost the previous iteration's best move
-            uint16_t prev_best_raw = best_move.raw();
-            std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
-                // Previous best move gets highest priority
-                int sa = (a.raw() == prev_best_raw) ? 100000 : score_move(a, board, 0);
-                int sb = (b.raw() == prev_best_raw) ? 100000 : score_move(b, board, 0);
-                return sa > sb;
-            });
-
-            Move current_best_move;
-            int32_t best_score = -200000;
-            int legal_moves = 0;
-            Colour us_before_move = board.to_move;
-
-            for (const auto& move : moves) {
-                board.make_move(move);
-                
-                Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
-                Square king_sq = find_king(board, us);
-                if (Attacks::is_square_attacked(king_sq, board.to_move, board.pieces.data(), board.occupancy[2])) {
-                    board.undo_move(move);
-                    continue;
-                }
+        Trace::Span span("search", "search");
+        if (params.profile) {
+            profile_group = &thread_counters();
+            profile_start = profile_group->read();
+        }
+        Move best;
+        MctsOptions options;
+        if (params.backend == Backend::Mcts) {
+            best = Mcts::search(board, params, stats);
+        } else if (mcts_options_for(params.evalFunc, options)) {
+            SearchParams mcts_params = params;
+            mcts_params.backend = Backend::Mcts;
+            mcts_params.mcts = options;
+            best = Mcts::search(board, mcts_params, stats);
+        } else {
+            best = Direct::iterative_deepening(board, params, stats, scratch_state);
+        }
+        read_counters(stats);
+        profile_group = nullptr;
+        span.arg("nodes", static_cast<int64_t>(stats.nodes));
+        span.arg("depth", stats.depth_reached);
+        span.move(best.raw());
+        return best;
+    }
 
-                int32_t score;
-                if (legal_moves == 0) {
-                    score = -alpha_beta(board, d - 1, -beta, -alpha, params.evalFunc, 1);
-                } else {
-                    // PVS at root
-                    score = -alpha_beta(board, d - 1, -alpha - 1, -alpha, params.evalFunc, 1);
-                    if (score > alpha && score < beta) {
-                        score = -alpha_beta(board, d - 1, -beta, -alpha, params.evalFunc, 1);
-                    }
-                }
+    // --- COROUTINE SEARCH ---
+    static constexpr size_t FRAME_GRANULE = 64;
+    static constexpr size_t FRAME_CLASSES = 64;     // Frames up to 4 KB are recycled
 
-                board.undo_move(move);
-                legal_moves++;
+    struct FreeFrame { FreeFrame* next; };
 
-                if (score > best_score) {
-                    best_score = score;
-                    current_best_move = move;
-                }
-                if (score > alpha) {
-                    alpha = score;
+    struct FrameLists {
+        FreeFrame* free[FRAME_CLASSES] = {};
+        ~FrameLists() {
+            for (FreeFrame* head : free) {
+                while (head) {
+                    FreeFrame* next = head->next;
+                    ::operator delete(head);
+                    head = next;
                 }
             }
+        }
+    };
+    static thread_local FrameLists frame_lists;
+
+    void* allocate_frame(size_t size) {
+        size_t cls = (size + FRAME_GRANULE - 1) / FRAME_GRANULE;
+        if (cls >= FRAME_CLASSES) return ::operator new(size);
+        if (FreeFrame* f = frame_lists.free[cls]) {
+            frame_lists.free[cls] = f->next;
+            return f;
+        }
+        return ::operator new(cls * FRAME_GRANULE);
+    }
 
-            if (current_best_move.raw() != 0) {
-                best_move = current_best_move;
-                
-                stats.depth_reached = d;
-                stats.score = best_score;
-                stats.best_move_raw = best_move.raw();
-            }
+    void release_frame(void* p, size_t size) {
+        size_t cls = (size + FRAME_GRANULE - 1) / FRAME_GRANULE;
+        if (cls >= FRAME_CLASSES) {
+            ::operator delete(p);
+            return;
         }
-        return best_move;
+        FreeFrame* f = static_cast<FreeFrame*>(p);
+        f->next = frame_lists.free[cls];
+        frame_lists.free[cls] = f;
+    }
+
+    // The thread_locals a running search lives on (see SEARCH STATE / TIME CONTROL).
+    // Keep in sync with swap_vars().
+    struct SearchCoroutine::Vars {
+        SearchState* st = nullptr;
+        uint64_t nodes_searched = 0;
+        uint64_t tt_cutoffs = 0;
+        uint64_t tb_probes = 0;
+        uint64_t eval_calls = 0;
+        uint64_t lazy_skips = 0;
+        std::chrono::steady_clock::time_point search_start;
+        int64_t hard_limit_ms = 0;
+        uint64_t node_limit = 0;
+        const std::atomic<bool>* stop_flag = nullptr;
+        bool limits_armed = false;
+        bool search_aborted = false;
+        ContextEvalCallback context_eval = nullptr;
+        int32_t lazy_margin = 0;
+        bool copy_make = false;
+        BatchEvalCallback batch_eval = nullptr;
+        std::vector<PendingEval*>* eval_queue = nullptr;
+        std::coroutine_handle<> resume_point;
+    };
+
+    static void swap_vars(SearchCoroutine::Vars& v) {
+        std::swap(st, v.st);
+        std::swap(nodes_searched, v.nodes_searched);
+        std::swap(tt_cutoffs, v.tt_cutoffs);
+        std::swap(tb_probes, v.tb_probes);
+        std::swap(eval_calls, v.eval_calls);
+        std::swap(lazy_skips, v.lazy_skips);
+        std::swap(search_start, v.search_start);
+        std::swap(hard_limit_ms, v.hard_limit_ms);
+        std::swap(node_limit, v.node_limit);
+        std::swap(stop_flag, v.stop_flag);
+        std::swap(limits_armed, v.limits_armed);
+        std::swap(search_aborted, v.search_aborted);
+        std::swap(context_eval, v.context_eval);
+        std::swap(lazy_margin, v.lazy_margin);
+        std::swap(copy_make, v.copy_make);
+        std::swap(batch_eval, v.batch_eval);
+        std::swap(eval_queue, v.eval_queue);
+        std::swap(resume_point, v.resume_point);
     }
 
-    Square find_king(const BoardState& board, Colour side) {
+    SearchCoroutine::SearchCoroutine(BoardState& board, const SearchParams& search_params,
+                                     std::vector<PendingEval*>& queue)
+        : params(search_params), vars(std::make_unique<Vars>()) {
+        if (!params.state) scratch = std::make_unique<SearchState>(0);
+        vars->batch_eval = batch_eval_for(params.evalFunc);
+        vars->eval_queue = &queue;
+        task = Suspending::iterative_deepening(board, params, search_stats, scratch ? *scratch : scratch_state);
+    }
+
+    SearchCoroutine::~SearchCoroutine() = default;
+
+    bool SearchCoroutine::resume() {
+        if (task.handle.done()) return true;
+        std::coroutine_handle<> next = started ? vars->resume_point : std::coroutine_handle<>(task.handle);
+        started = true;
+        swap_vars(*vars);
+        next.resume();
+        swap_vars(*vars);
+        return task.handle.done();
+    }
+
+
+    Square find_king(const Position& board, Colour side) {
         int idx = (side == Colour::White) ? 5 : 11;
         if (board.pieces[idx] == 0) return Square::None; 
         return static_cast<Square>(BitUtil::lsb(board.pieces[idx]));
@@ -0,0 +1,409 @@
+// Search tree shared by the direct and the coroutine search. Search.cpp includes it twice,
+// inside namespace Direct and namespace Suspending, with these macros set:
+//   SEARCH_TASK(T)      return type of a search function (T, or Task<T>)
+//   SEARCH_AWAIT(call)  result of a nested search call
+//   SEARCH_RETURN       return / co_return
+//   SEARCH_EVAL(b, e)   static eval of board b with callback e
+// so both walk exactly the same tree and only differ in how an eval is obtained.
+// No include guard on purpose.
+
+    // --- Quiescence Search ---
+    static SEARCH_TASK(int32_t) quiescence(BoardState& board, int32_t alpha, int32_t beta, EvalCallback eval, uint32_t moves_played, int qs_depth) {
+        nodes_searched++;
+        if (should_stop()) SEARCH_RETURN 0;
+
+        // A repetition the side to move can force is a floor on its score
+        if (alpha < 0 && board.upcoming_repetition(static_cast<int>(moves_played))) {
+            alpha = 0;
+            if (alpha >= beta) SEARCH_RETURN beta;
+        }
+
+        // With a lazy margin, a PeSTO estimate far enough outside the window stands in for
+        // the callback: above beta it fails high outright, below alpha its upper bound is
+        // all delta pruning needs, since a fail-hard search returns alpha either way
+        int32_t stand_pat;
+        bool exact = true;
+        if (lazy_margin > 0) {
+            uint32_t side = (board.to_move == Colour::White ? 0 : 1);
+            int32_t estimate = Evaluation::evaluate(board.pieces.data(), board.occupancy.data(), side);
+            if (estimate - lazy_margin >= beta) {
+                lazy_skips++;
+                SEARCH_RETURN beta;
+            }
+            if (estimate + lazy_margin < alpha) {
+                lazy_skips++;
+                stand_pat = estimate + lazy_margin;
+                exact = false;
+            }
+        }
+        if (exact) {
+            stand_pat = SEARCH_EVAL(board, eval);
+            eval_calls++;
+            if (stand_pat >= beta) SEARCH_RETURN beta;
+            if (stand_pat > alpha) alpha = stand_pat;
+        }
+
+        if (qs_depth >= QS_MAX_DEPTH) SEARCH_RETURN alpha;
+
+        std::vector<Move> moves;
+        moves.reserve(32); 
+        MoveGen::generate_captures(board, moves);
+
+        // Sort captures by MVV-LVA (ply doesn't matter for captures, pass 0)
+        std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
+            return score_move(a, board, 0) > score_move(b, board, 0);
+        });
+
+        Position saved;
+        for (const auto& move : moves) {
+            if (!move.is_promotion() && stand_pat + DELTA_MARGIN < alpha) {
+                break;
+            }
+
+            play_move(board, move, saved);
+            
+            Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+            Square king_sq = find_king(board, us);
+            if (Attacks::is_square_attacked(king_sq, board.to_move, board.pieces.data(), board.occupancy[2])) {
+                take_back(board, move, saved);
+                continue;
+            }
+
+            int32_t score = -SEARCH_AWAIT(quiescence(board, -beta, -alpha, eval, moves_played + 1, qs_depth + 1));
+            take_back(board, move, saved);
+            if (search_aborted) SEARCH_RETURN 0;
+
+            if (score >= beta) SEARCH_RETURN beta;
+            if (score > alpha) alpha = score;
+        }
+        SEARCH_RETURN alpha;
+    }
+
+    // --- Main Alpha-Beta with PVS ---
+    static SEARCH_TASK(int32_t) alpha_beta(BoardState& board, int depth, int32_t alpha, int32_t beta, EvalCallback eval, int ply) {
+        if (depth > 0) {
+            nodes_searched++;  // Leaves are counted by quiescence
+            if (should_stop()) SEARCH_RETURN 0;
+        }
+
+        if (ply > 0 && board.is_draw(ply)) {
+            SEARCH_RETURN 0;
+        }
+        if (ply > 0 && alpha < 0 && board.upcoming_repetition(ply)) {
+            alpha = 0;
+            if (alpha >= beta) SEARCH_RETURN beta;
+        }
+
+        // --- TABLEBASE PROBE ---
+        // Only right after a capture or pawn move, where WDL is exact under the 50-move rule
+        int tb_limit = Tablebase::probe_limit();
+        if (Tablebase::PROBES_VERIFIED && tb_limit > 0 && ply > 0 && depth >= Tablebase::probe_depth()
+            && board.half_move_clock == 0 && board.castle_rights == 0
+            && BitUtil::count_bits(board.occupancy[2]) <= tb_limit) {
+            Tablebase::ProbeState state;
+            Tablebase::WDL wdl = Tablebase::probe_wdl(board, state);
+            if (state != Tablebase::Fail) {
+                tb_probes++;
+                // Cursed wins / blessed losses are draws, nudged towards the better side
+                if (wdl == Tablebase::Win) {
+                    if (TB_WIN - ply >= beta) SEARCH_RETURN beta;
+                } else if (wdl == Tablebase::Loss) {
+                    if (-TB_WIN + ply <= alpha) SEARCH_RETURN alpha;
+                } else {
+                    SEARCH_RETURN std::clamp(2 * static_cast<int32_t>(wdl), alpha, beta);
+                }
+            }
+        }
+
+        if (depth == 0) {
+            SEARCH_RETURN SEARCH_AWAIT(quiescence(board, alpha, beta, eval, ply, 0));
+        }
+
+        // --- TT PROBE ---
+        // Fail-hard like the rest of the search: bounds collapse onto alpha/beta
+        uint16_t tt_move = 0;
+        if (TTEntry* e = st->probe(board.key)) {
+            tt_move = e->move;
+            if (e->depth >= depth) {
+                int32_t tt_score = e->score;
+                if (tt_score > MATE_BOUND) tt_score -= ply;
+                else if (tt_score < -MATE_BOUND) tt_score += ply;
+
+                Bound bound = static_cast<Bound>(e->bound_gen & 3);
+                if (bound == Bound::Exact) {
+                    tt_cutoffs++;
+                    SEARCH_RETURN std::clamp(tt_score, alpha, beta);
+                }
+                if (bound == Bound::Lower && tt_score >= beta) { tt_cutoffs++; SEARCH_RETURN beta; }
+                if (bound == Bound::Upper && tt_score <= alpha) { tt_cutoffs++; SEARCH_RETURN alpha; }
+            }
+        }
+
+        // In check only king moves, captures of the checker and blocks can be legal
+        Colour them = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+        bool in_check = Attacks::is_square_attacked(find_king(board, board.to_move), them,
+                                                    board.pieces.data(), board.occupancy[2]);
+        std::vector<Move> moves;
+        if (in_check) MoveGen::generate_evasions(board, moves);
+        else MoveGen::generate_moves(board, moves);
+
+        // Sort moves: hash move > captures (MVV-LVA) > promotions > killers > history
+        std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
+            int sa = (a.raw() == tt_move) ? 30000 : score_move(a, board, ply);
+            int sb = (b.raw() == tt_move) ? 30000 : score_move(b, board, ply);
+            return sa > sb;
+        });
+
+        int legal_moves = 0;
+        Colour us_before_move = board.to_move;
+        int32_t alpha_orig = alpha;
+        uint16_t best_raw = 0;
+
+        Position saved;
+        for (const auto& move : moves) {
+            play_move(board, move, saved);
+
+            Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White; 
+            Square king_sq = find_king(board, us);
+            if (Attacks::is_square_attacked(king_sq, board.to_move, board.pieces.data(), board.occupancy[2])) {
+                take_back(board, move, saved);
+                continue;
+            }
+
+            int32_t score;
+            if (legal_moves == 0) {
+                // First legal move (expected best) — search with full window
+                score = -SEARCH_AWAIT(alpha_beta(board, depth - 1, -beta, -alpha, eval, ply + 1));
+            } else {
+                // PVS: search with null window first
+                score = -SEARCH_AWAIT(alpha_beta(board, depth - 1, -alpha - 1, -alpha, eval, ply + 1));
+                // If it beats alpha but not beta, re-search with full window
+                if (score > alpha && score < beta) {
+                    score = -SEARCH_AWAIT(alpha_beta(board, depth - 1, -beta, -alpha, eval, ply + 1));
+                }
+            }
+
+            take_back(board, move, saved);
+            if (search_aborted) SEARCH_RETURN 0;
+            legal_moves++;
+
+            if (score >= beta) {
+                // Beta cutoff — update killer and history for quiet moves
+                if (!move.is_capture() && !move.is_promotion()) {
+                    store_killer(move, ply);
+                    update_history(move, us_before_move, depth);
+                }
+                st->store(board.key, depth, beta, Bound::Lower, move.raw(), ply);
+                SEARCH_RETURN beta;
+            }
+            if (score > alpha) {
+                alpha = score;
+                best_raw = move.raw();
+            }
+        }
+
+        if (legal_moves == 0) {
+            if (in_check) SEARCH_RETURN -100000 + ply; 
+            SEARCH_RETURN 0;
+        }
+
+        st->store(board.key, depth, alpha, (alpha > alpha_orig) ? Bound::Exact : Bound::Upper, best_raw, ply);
+        SEARCH_RETURN alpha;
+    }
+
+    // --- Iterative Deepening with PVS at root ---
+    static SEARCH_TASK(Move) iterative_deepening(BoardState& board, const SearchParams& params, SearchStats& stats,
+                                                 SearchState& scratch) {
+        Move best_move;
+        
+        stats.depth_reached = 0;
+        stats.score = 0;
+        nodes_searched = 0;
+
+        search_start = std::chrono::steady_clock::now();
+        hard_limit_ms = params.hard_time_ms;
+        node_limit = params.max_nodes;
+        stop_flag = params.stop;
+        context_eval = context_eval_for(params.evalFunc);
+        lazy_margin = lazy_margin_for(params.evalFunc);
+        copy_make = params.copy_make;
+        limits_armed = false;
+        search_aborted = false;
+        tt_cutoffs = 0;
+        tb_probes = 0;
+        eval_calls = 0;
+        lazy_skips = 0;
+
+        // Persistent state is aged or wiped by prepare(); the scratch state is always wiped
+        if (params.state) {
+            st = params.state;
+            st->prepare(board);
+        } else {
+            st = &scratch;
+            st->clear();
+        }
+        stats.ponder_hit = st->ponder_hit;
+        stats.ponder_move_raw = 0;
+        stats.tb_hits = 0;
+
+        // --- TABLEBASE ROOT ---
+        // Play the DTZ-optimal move outright: it converts wins within the 50-move rule,
+        // which a depth-limited search over WDL scores alone can't guarantee
+        if (Tablebase::PROBES_VERIFIED && Tablebase::probe_limit() > 0 && board.castle_rights == 0
+            && BitUtil::count_bits(board.occupancy[2]) <= Tablebase::probe_limit()) {
+            Move tb_move;
+            Tablebase::WDL wdl;
+            int dtz;
+            if (Tablebase::root_probe(board, tb_move, wdl, dtz)) {
+                int32_t score = (wdl == Tablebase::Win)  ?  TB_WIN - std::abs(dtz)
+                              : (wdl == Tablebase::Loss) ? -TB_WIN + std::abs(dtz)
+                              : 2 * static_cast<int32_t>(wdl);
+                stats.score = score;
+                stats.best_move_raw = tb_move.raw();
+                stats.nodes = 0;
+                stats.time_ms = elapsed_ms();
+                stats.tt_hits = 0;
+                stats.tb_hits = 1;
+                stats.eval_calls = 0;
+                stats.lazy_skips = 0;
+                st->expected_key = 0;
+                if (params.on_iteration) params.on_iteration(stats, params.info_user);
+                SEARCH_RETURN tb_move;
+            }
+        }
+
+        NnueScope nnue_scope(board, Nnue::network_for(params.evalFunc));
+
+        int max_depth = (params.depth > 0) ? std::min(params.depth, MAX_SEARCH_DEPTH) : MAX_SEARCH_DEPTH;
+        for (int d = 1; d <= max_depth; ++d) {
+            Trace::Span iteration("iteration", "search");
+            iteration.arg("depth", d);
+            int32_t alpha = -200000;
+            int32_t beta = 200000;
+            
+            std::vector<Move> moves;
+            MoveGen::generate_moves(board, moves);
+            
+            // Sort moves — at root, also boost the previous iteration's best move
+            // (or, on the first iteration, the move remembered from earlier searches)
+            uint16_t prev_best_raw = best_move.raw();
+            if (prev_best_raw == 0) {
+                if (TTEntry* e = st->probe(board.key)) prev_best_raw = e->move;
+            }
+            std::sort(moves.begin(), moves.end(), [&](const Move& a, const Move& b) {
+                // Previous best move gets highest priority
+                int sa = (a.raw() == prev_best_raw) ? 100000 : score_move(a, board, 0);
+                int sb = (b.raw() == prev_best_raw) ? 100000 : score_move(b, board, 0);
+                return sa > sb;
+            });
+
+            Move current_best_move;
+            int32_t best_score = -200000;
+            int legal_moves = 0;
+            Colour us_before_move = board.to_move;
+
+            Position saved;
+            for (const auto& move : moves) {
+                play_move(board, move, saved);
+                
+                Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+                Square king_sq = find_king(board, us);
+                if (Attacks::is_square_attacked(king_sq, board.to_move, board.pieces.data(), board.occupancy[2])) {
+                    take_back(board, move, saved);
+                    continue;
+                }
+
+                Trace::Span root_move("root move", "search");
+                root_move.move(move.raw());
+                int32_t score;
+                if (legal_moves == 0) {
+                    score = -SEARCH_AWAIT(alpha_beta(board, d - 1, -beta, -alpha, params.evalFunc, 1));
+                } else {
+                    // PVS at root
+                    score = -SEARCH_AWAIT(alpha_beta(board, d - 1, -alpha - 1, -alpha, params.evalFunc, 1));
+                    if (score > alpha && score < beta) {
+                        score = -SEARCH_AWAIT(alpha_beta(board, d - 1, -beta, -alpha, params.evalFunc, 1));
+                    }
+                }
+
+                take_back(board, move, saved);
+                if (search_aborted) break;
+                legal_moves++;
+
+                root_move.arg("score", score);
+
+                if (score > best_score) {
+                    best_score = score;
+                    current_best_move = move;
+                }
+                if (score > alpha) {
+                    alpha = score;
+                }
+            }
+
+            // A partial iteration is discarded; the previous depth's move stands
+            if (search_aborted) break;
+
+            iteration.arg("score", best_score);
+            iteration.arg("nodes", static_cast<int64_t>(nodes_searched));
+            iteration.move(current_best_move.raw());
+            if (current_best_move.raw() != 0) {
+                best_move = current_best_move;
+                
+                stats.depth_reached = d;
+                stats.score = best_score;
+                stats.best_move_raw = best_move.raw();
+                st->store(board.key, d, best_score, Bound::Exact, best_move.raw(), 0);
+
+                if (params.on_iteration) {
+                    stats.nodes = nodes_searched;
+                    stats.time_ms = elapsed_ms();
+                    stats.tt_hits = tt_cutoffs;
+                    stats.tb_hits = tb_probes;
+                    stats.eval_calls = eval_calls;
+                    stats.lazy_skips = lazy_skips;
+                    read_counters(stats);
+                    params.on_iteration(stats, params.info_user);
+                }
+            }
+
+            if (params.soft_time_ms > 0 && elapsed_ms() >= params.soft_time_ms) break;
+            if (node_limit > 0 && nodes_searched >= node_limit) break;
+            if (stop_requested()) break;
+            limits_armed = true;
+        }
+        stats.nodes = nodes_searched;
+        stats.time_ms = elapsed_ms();
+        stats.tt_hits = tt_cutoffs;
+        stats.tb_hits = tb_probes;
+        stats.eval_calls = eval_calls;
+        stats.lazy_skips = lazy_skips;
+        total_eval_calls += eval_calls;
+        total_lazy_skips += lazy_skips;
+
+        // Remember the predicted reply so the next search can tell a ponder hit
+        st->expected_key = 0;
+        if (best_move.raw() != 0) {
+            board.make_move(best_move);
+            TTEntry* e = st->probe(board.key);
+            if (e && e->move != 0) {
+                std::vector<Move> replies;
+                MoveGen::generate_moves(board, replies);
+                for (const auto& reply : replies) {
+                    if (reply.raw() != e->move) continue;
+                    board.make_move(reply);
+                    Colour us = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+                    bool legal = !Attacks::is_square_attacked(find_king(board, us), board.to_move,
+                                                             board.pieces.data(), board.occupancy[2]);
+                    if (legal) {
+                        stats.ponder_move_raw = reply.raw();
+                        st->expected_key = board.key;
+                    }
+                    board.undo_move(reply);
+                    break;
+                }
+            }
+            board.undo_move(best_move);
+        }
+        SEARCH_RETURN best_move;
+    }
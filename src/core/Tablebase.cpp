@@ -0,0 +1,979 @@
+#include "Tablebase.hpp"
+#include "MappedFile.hpp"
+#include "Notation.hpp"
+#include "Attacks.hpp"
+#include "Search.hpp"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Decoder for the Syzygy format (Ronald de Man). Index encoding, the
+// "recursive pairing" Huffman decompression and the DTZ value maps follow the
+// reference layout; only the plumbing is adapted to this engine's board.
+
+namespace Tablebase {
+
+    static constexpr int TB_PIECES = 7;
+
+    enum TableType { WDLTable, DTZTable };
+
+    // Per-table flags; all but SingleValue only appear in DTZ tables
+    enum Flag { STM = 1, Mapped = 2, WinPlies = 4, LossPlies = 8, Wide = 16, SingleValue = 128 };
+
+    // --- FILE READING ---
+
+    static uint16_t read_le16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+    static uint32_t read_le32(const uint8_t* p) {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+    static uint32_t read_be32(const uint8_t* p) {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+    static uint64_t read_be64(const uint8_t* p) {
+        return (uint64_t(read_be32(p)) << 32) | read_be32(p + 4);
+    }
+
+    // Piece codes as stored in the files: 1..6 white P..K, 9..14 black P..K
+    static int tb_piece(int engine_piece) {
+        return (engine_piece < 6) ? engine_piece + 1 : engine_piece - 6 + 9;
+    }
+
+    // --- TABLE LAYOUT ---
+
+    using Sym = uint16_t;
+
+    // Decoding data for one (side to move, lead pawn file) slice of a table
+    struct PairsData {
+        uint8_t flags = 0;
+        uint8_t max_sym_len = 0;
+        uint8_t min_sym_len = 0;        // Holds the value itself for SingleValue tables
+        uint32_t num_blocks = 0;
+        size_t block_size = 0;
+        size_t span = 0;                // A sparse index entry every span values
+        const uint8_t* lowest_sym = nullptr;    // Sym[], lowest symbol of each code length
+        const uint8_t* btree = nullptr;         // 3-byte (left, right) pairs per symbol
+        const uint8_t* block_length = nullptr;  // uint16[], values per block minus one
+        uint32_t block_length_size = 0;
+        const uint8_t* sparse_index = nullptr;  // 6-byte (block, offset) entries
+        size_t sparse_index_size = 0;
+        const uint8_t* data = nullptr;          // Compressed blocks
+        std::vector<uint64_t> base64;   // Lowest code of each length, left-aligned to 64 bits
+        std::vector<uint8_t> symlen;    // Values (minus one) each symbol expands to
+        int pieces[TB_PIECES] = {};     // Piece order; defines the encoding groups
+        uint64_t group_idx[TB_PIECES + 1] = {};
+        int group_len[TB_PIECES + 1] = {};
+        uint16_t map_idx[4] = {};       // DTZ: Win, Loss, CursedWin, BlessedLoss map offsets
+    };
+
+    static Sym btree_left(const PairsData* d, Sym s) {
+        const uint8_t* lr = d->btree + 3 * s;
+        return static_cast<Sym>(((lr[1] & 0xF) << 8) | lr[0]);
+    }
+
+    static Sym btree_right(const PairsData* d, Sym s) {
+        const uint8_t* lr = d->btree + 3 * s;
+        return static_cast<Sym>((lr[2] << 4) | (lr[1] >> 4));
+    }
+
+    struct Table {
+        TableType type = WDLTable;
+        std::string name;               // e.g. "KRvK"; white holds the first side
+        uint64_t key = 0;               // Material signature with the first side white
+        uint64_t key2 = 0;              // ...and with it black
+        int piece_count = 0;
+        bool has_pawns = false;
+        bool has_unique_pieces = false;
+        bool pawns_both_sides = false;
+
+        std::atomic<bool> ready{false};
+        std::mutex mutex;
+        MappedFile file;
+        bool usable = false;
+        const uint8_t* map = nullptr;   // DTZ value maps
+        PairsData items[2][4];          // [stm][lead pawn file a..d, or 0]
+
+        int sides() const { return (type == WDLTable) ? 2 : 1; }
+        PairsData* get(int stm, int f) { return &items[stm % sides()][has_pawns ? f : 0]; }
+    };
+
+    struct TablePair {
+        Table wdl;
+        Table dtz;
+    };
+
+    // --- GLOBAL STATE ---
+
+    static std::vector<std::string> search_paths;
+    static std::vector<std::unique_ptr<TablePair>> tables;
+    static std::unordered_map<uint64_t, TablePair*> table_index;
+    static int max_cardinality = 0;
+    static int search_probe_depth = 1;
+    static int search_probe_limit = TB_PIECES;
+
+    // --- INDEXING TABLES ---
+
+    static int MapPawns[64];
+    static int MapB1H1H7[64];
+    static int MapA1D1D4[64];
+    static int MapKK[10][64];
+    static int Binomial[6][64];
+    static int LeadPawnIdx[6][64];
+    static int LeadPawnsSize[6][4];
+
+    static int rank_of(int sq) { return sq >> 3; }
+    static int file_of(int sq) { return sq & 7; }
+    static int off_a1h8(int sq) { return rank_of(sq) - file_of(sq); }
+    static int flip_file(int sq) { return sq ^ 7; }
+    static int flip_rank(int sq) { return sq ^ 56; }
+    static bool pawns_comp(int a, int b) { return MapPawns[a] < MapPawns[b]; }
+
+    static void init_indices() {
+        static bool initialized = false;
+        if (initialized) return;
+
+        int code = 0;
+        for (int s = 0; s < 64; ++s) {
+            if (off_a1h8(s) < 0) MapB1H1H7[s] = code++;
+        }
+
+        // a1-d1-d4 triangle: below-diagonal squares first, diagonal squares last
+        std::vector<int> diagonal;
+        code = 0;
+        for (int s = 0; s <= 27; ++s) {
+            if (off_a1h8(s) < 0 && file_of(s) <= 3) MapA1D1D4[s] = code++;
+            else if (!off_a1h8(s) && file_of(s) <= 3) diagonal.push_back(s);
+        }
+        for (int s : diagonal) MapA1D1D4[s] = code++;
+
+        // The 462 legal king pairs with the first king in the triangle. With the first
+        // king on the diagonal the second may not be above it; pairs with both on the
+        // diagonal are numbered last.
+        std::vector<std::pair<int, int>> both_on_diagonal;
+        code = 0;
+        for (int idx = 0; idx < 10; ++idx) {
+            for (int s1 = 0; s1 <= 27; ++s1) {
+                if (MapA1D1D4[s1] != idx || (idx == 0 && s1 != 1)) continue;     // b1 is 0
+                for (int s2 = 0; s2 < 64; ++s2) {
+                    if (((Attacks::KingAttacks[s1] | (1ULL << s1)) >> s2) & 1) continue;
+                    if (!off_a1h8(s1) && off_a1h8(s2) > 0) continue;
+                    if (!off_a1h8(s1) && !off_a1h8(s2)) both_on_diagonal.emplace_back(idx, s2);
+                    else MapKK[idx][s2] = code++;
+                }
+            }
+        }
+        for (const auto& p : both_on_diagonal) MapKK[p.first][p.second] = code++;
+
+        Binomial[0][0] = 1;
+        for (int n = 1; n < 64; ++n) {
+            for (int k = 0; k < 6 && k <= n; ++k) {
+                Binomial[k][n] = (k > 0 ? Binomial[k - 1][n - 1] : 0)
+                               + (k < n ? Binomial[k][n - 1] : 0);
+            }
+        }
+
+        // MapPawns orders a2-h7 so the highest value is the leading pawn: nearest the
+        // edge, then lowest rank. LeadPawnIdx/LeadPawnsSize index the leading group per file.
+        int available = 47;
+        for (int lead = 1; lead <= 5; ++lead) {
+            for (int f = 0; f <= 3; ++f) {
+                int idx = 0;
+                for (int r = 1; r <= 6; ++r) {
+                    int sq = r * 8 + f;
+                    if (lead == 1) {
+                        MapPawns[sq] = available--;
+                        MapPawns[flip_file(sq)] = available--;
+                    }
+                    LeadPawnIdx[lead][sq] = idx;
+                    idx += Binomial[lead - 1][MapPawns[sq]];
+                }
+                LeadPawnsSize[lead][f] = idx;
+            }
+        }
+
+        initialized = true;
+    }
+
+    // --- MATERIAL SIGNATURES ---
+    // 4 bits per (colour, non-king piece type)
+
+    static uint64_t signature(const int counts[2][5]) {
+        uint64_t sig = 0;
+        for (int c = 0; c < 2; ++c)
+            for (int t = 0; t < 5; ++t)
+                sig |= static_cast<uint64_t>(counts[c][t]) << (4 * (5 * c + t));
+        return sig;
+    }
+
+    static uint64_t material_key(const BoardState& board) {
+        int counts[2][5];
+        for (int t = 0; t < 5; ++t) {
+            counts[0][t] = BitUtil::count_bits(board.pieces[t]);
+            counts[1][t] = BitUtil::count_bits(board.pieces[t + 6]);
+        }
+        return signature(counts);
+    }
+
+    static int piece_type_from_char(char c) {
+        switch (c) {
+            case 'P': return 0;
+            case 'N': return 1;
+            case 'B': return 2;
+            case 'R': return 3;
+            case 'Q': return 4;
+        }
+        return -1;
+    }
+
+    // --- FILES ---
+
+    static bool open_in_paths(MappedFile& file, const std::string& fname) {
+        for (const auto& dir : search_paths) {
+            if (file.open(dir + "/" + fname)) return true;
+        }
+        return false;
+    }
+
+    static bool exists_in_paths(const std::string& fname) {
+        for (const auto& dir : search_paths) {
+            std::ifstream f(dir + "/" + fname, std::ios::binary);
+            if (f.good()) return true;
+        }
+        return false;
+    }
+
+    // --- TABLE INITIALISATION ---
+
+    static void set_groups(Table& e, PairsData* d, const int order[2], int f) {
+        int n = 0;
+        int first_len = e.has_pawns ? 0 : e.has_unique_pieces ? 3 : 2;
+        d->group_len[n] = 1;
+
+        // Pieces of the same kind form a group; without pawns the leading group holds
+        // the first three unique pieces (or just the kings)
+        for (int i = 1; i < e.piece_count; ++i) {
+            if (--first_len > 0 || d->pieces[i] == d->pieces[i - 1]) d->group_len[n]++;
+            else d->group_len[++n] = 1;
+        }
+        d->group_len[++n] = 0;
+
+        // Groups are stored in a per-table order: order[0] is the leading group,
+        // order[1] the remaining pawns when both sides have pawns
+        bool pp = e.has_pawns && e.pawns_both_sides;
+        int next = pp ? 2 : 1;
+        int free_squares = 64 - d->group_len[0] - (pp ? d->group_len[1] : 0);
+        uint64_t idx = 1;
+
+        for (int k = 0; next < n || k == order[0] || k == order[1]; ++k) {
+            if (k == order[0]) {
+                d->group_idx[0] = idx;
+                idx *= e.has_pawns ? LeadPawnsSize[d->group_len[0]][f]
+                                   : e.has_unique_pieces ? 31332 : 462;
+            } else if (k == order[1]) {
+                d->group_idx[1] = idx;
+                idx *= Binomial[d->group_len[1]][48 - d->group_len[0]];
+            } else {
+                d->group_idx[next] = idx;
+                idx *= Binomial[d->group_len[next]][free_squares];
+                free_squares -= d->group_len[next++];
+            }
+        }
+        d->group_idx[n] = idx;
+    }
+
+    static uint8_t set_symlen(PairsData* d, Sym s, std::vector<bool>& visited) {
+        visited[s] = true;
+        Sym sr = btree_right(d, s);
+        if (sr == 0xFFF) return 0;
+
+        Sym sl = btree_left(d, s);
+        if (!visited[sl]) d->symlen[sl] = set_symlen(d, sl, visited);
+        if (!visited[sr]) d->symlen[sr] = set_symlen(d, sr, visited);
+        return static_cast<uint8_t>(d->symlen[sl] + d->symlen[sr] + 1);
+    }
+
+    static const uint8_t* set_sizes(PairsData* d, const uint8_t* data) {
+        d->flags = *data++;
+
+        if (d->flags & SingleValue) {
+            d->num_blocks = 0;
+            d->span = 0;
+            d->block_length_size = 0;
+            d->sparse_index_size = 0;
+            d->min_sym_len = *data++;
+            return data;
+        }
+
+        // The last group index is the table size
+        int last = 0;
+        while (d->group_len[last]) ++last;
+        uint64_t tb_size = d->group_idx[last];
+
+        d->block_size = size_t(1) << *data++;
+        d->span = size_t(1) << *data++;
+        d->sparse_index_size = static_cast<size_t>((tb_size + d->span - 1) / d->span);
+        uint8_t padding = *data++;
+        d->num_blocks = read_le32(data);
+        data += 4;
+        d->block_length_size = d->num_blocks + padding;
+        d->max_sym_len = *data++;
+        d->min_sym_len = *data++;
+        d->lowest_sym = data;
+        d->base64.assign(d->max_sym_len - d->min_sym_len + 1, 0);
+
+        // Canonical Huffman: longer codes have lower values
+        for (int i = static_cast<int>(d->base64.size()) - 2; i >= 0; --i) {
+            d->base64[i] = (d->base64[i + 1] + read_le16(d->lowest_sym + 2 * i)
+                            - read_le16(d->lowest_sym + 2 * (i + 1))) / 2;
+        }
+        for (size_t i = 0; i < d->base64.size(); ++i) {
+            d->base64[i] <<= 64 - i - d->min_sym_len;
+        }
+
+        data += d->base64.size() * sizeof(Sym);
+        d->symlen.assign(read_le16(data), 0);
+        data += 2;
+        d->btree = data;
+
+        std::vector<bool> visited(d->symlen.size());
+        for (size_t s = 0; s < d->symlen.size(); ++s) {
+            if (!visited[s]) d->symlen[s] = set_symlen(d, static_cast<Sym>(s), visited);
+        }
+        return data + d->symlen.size() * 3 + (d->symlen.size() & 1);
+    }
+
+    static const uint8_t* set_dtz_map(Table& e, const uint8_t* data, int max_file) {
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(e.file.data());
+        e.map = data;
+
+        for (int f = 0; f <= max_file; ++f) {
+            PairsData* d = e.get(0, f);
+            if (!(d->flags & Mapped)) continue;
+            if (d->flags & Wide) {
+                data += (data - base) & 1;      // Word alignment
+                for (int i = 0; i < 4; ++i) {
+                    d->map_idx[i] = static_cast<uint16_t>((data - e.map) / 2 + 1);
+                    data += 2 * read_le16(data) + 2;
+                }
+            } else {
+                for (int i = 0; i < 4; ++i) {
+                    d->map_idx[i] = static_cast<uint16_t>(data - e.map + 1);
+                    data += *data + 1;
+                }
+            }
+        }
+        return data + ((data - base) & 1);
+    }
+
+    static bool set_table(Table& e, const uint8_t* data) {
+        enum { Split = 1, HasPawns = 2 };
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(e.file.data());
+
+        if (e.has_pawns != bool(*data & HasPawns)) return false;
+        if ((e.key != e.key2) != bool(*data & Split)) return false;
+        data++;
+
+        int sides = (e.sides() == 2 && e.key != e.key2) ? 2 : 1;
+        int max_file = e.has_pawns ? 3 : 0;
+        bool pp = e.has_pawns && e.pawns_both_sides;
+
+        for (int f = 0; f <= max_file; ++f) {
+            for (int i = 0; i < sides; ++i) *e.get(i, f) = PairsData();
+
+            int order[2][2] = {{*data & 0xF, pp ? (*(data + 1) & 0xF) : 0xF},
+                               {*data >> 4,  pp ? (*(data + 1) >> 4)  : 0xF}};
+            data += 1 + pp;
+
+            for (int k = 0; k < e.piece_count; ++k, ++data) {
+                for (int i = 0; i < sides; ++i) {
+                    e.get(i, f)->pieces[k] = i ? (*data >> 4) : (*data & 0xF);
+                }
+            }
+            for (int i = 0; i < sides; ++i) set_groups(e, e.get(i, f), order[i], f);
+        }
+
+        data += (data - base) & 1;
+
+        for (int f = 0; f <= max_file; ++f)
+            for (int i = 0; i < sides; ++i)
+                data = set_sizes(e.get(i, f), data);
+
+        if (e.type == DTZTable) data = set_dtz_map(e, data, max_file);
+
+        for (int f = 0; f <= max_file; ++f) {
+            for (int i = 0; i < sides; ++i) {
+                PairsData* d = e.get(i, f);
+                d->sparse_index = data;
+                data += d->sparse_index_size * 6;
+            }
+        }
+        for (int f = 0; f <= max_file; ++f) {
+            for (int i = 0; i < sides; ++i) {
+                PairsData* d = e.get(i, f);
+                d->block_length = data;
+                data += d->block_length_size * sizeof(uint16_t);
+            }
+        }
+        for (int f = 0; f <= max_file; ++f) {
+            for (int i = 0; i < sides; ++i) {
+                PairsData* d = e.get(i, f);
+                data = base + (((data - base) + 0x3F) & ~0x3F);    // 64-byte alignment
+                d->data = data;
+                data += static_cast<size_t>(d->num_blocks) * d->block_size;
+            }
+        }
+
+        return data <= base + e.file.size();
+    }
+
+    // Maps the file on first use; later calls are lock-free
+    static bool ensure_mapped(Table& e) {
+        if (e.ready.load(std::memory_order_acquire)) return e.usable;
+
+        std::lock_guard<std::mutex> lock(e.mutex);
+        if (e.ready.load(std::memory_order_relaxed)) return e.usable;
+
+        static const uint8_t Magics[2][4] = {{0xD7, 0x66, 0x0C, 0xA5},     // DTZ
+                                             {0x71, 0xE8, 0x23, 0x5D}};    // WDL
+        std::string fname = e.name + ((e.type == WDLTable) ? ".rtbw" : ".rtbz");
+        if (open_in_paths(e.file, fname) && e.file.size() > 4) {
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(e.file.data());
+            if (std::memcmp(data, Magics[e.type == WDLTable], 4) == 0) {
+                e.usable = set_table(e, data + 4);
+            }
+        }
+        if (!e.usable) e.file.close();
+
+        e.ready.store(true, std::memory_order_release);
+        return e.usable;
+    }
+
+    // --- DECOMPRESSION ---
+
+    // Values are Huffman-coded symbols that expand ("recursive pairing") into runs of
+    // values. Find the block holding idx via the sparse index, walk its symbols to the
+    // one covering idx, then descend the pair tree to the leaf value.
+    static int decompress_pairs(PairsData* d, uint64_t idx) {
+        if (d->flags & SingleValue) return d->min_sym_len;
+
+        uint32_t k = static_cast<uint32_t>(idx / d->span);
+        const uint8_t* entry = d->sparse_index + 6 * static_cast<size_t>(k);
+        uint32_t block = read_le32(entry);
+        int offset = read_le16(entry + 4);
+
+        // The sparse entry points at value k * span + span / 2
+        offset += static_cast<int>(idx % d->span) - static_cast<int>(d->span / 2);
+
+        while (offset < 0) offset += read_le16(d->block_length + 2 * (--block)) + 1;
+        while (offset > read_le16(d->block_length + 2 * block)) {
+            offset -= read_le16(d->block_length + 2 * block) + 1;
+            ++block;
+        }
+
+        const uint8_t* ptr = d->data + static_cast<uint64_t>(block) * d->block_size;
+        uint64_t buf64 = read_be64(ptr);
+        ptr += 8;
+        int buf64_size = 64;
+        Sym sym;
+
+        while (true) {
+            int len = 0;    // Code length minus min_sym_len
+            while (buf64 < d->base64[len]) ++len;
+
+            sym = static_cast<Sym>((buf64 - d->base64[len]) >> (64 - len - d->min_sym_len));
+            sym = static_cast<Sym>(sym + read_le16(d->lowest_sym + 2 * len));
+
+            if (offset < d->symlen[sym] + 1) break;
+
+            offset -= d->symlen[sym] + 1;
+            len += d->min_sym_len;
+            buf64 <<= len;
+            buf64_size -= len;
+
+            if (buf64_size <= 32) {
+                buf64_size += 32;
+                buf64 |= static_cast<uint64_t>(read_be32(ptr)) << (64 - buf64_size);
+                ptr += 4;
+            }
+        }
+
+        // Children of a pair are adjacent runs, so offset picks a side at each level
+        while (d->symlen[sym]) {
+            Sym left = btree_left(d, sym);
+            if (offset < d->symlen[left] + 1) {
+                sym = left;
+            } else {
+                offset -= d->symlen[left] + 1;
+                sym = btree_right(d, sym);
+            }
+        }
+        return btree_left(d, sym);
+    }
+
+    // DTZ values are stored by frequency rank per outcome; map back and convert to plies
+    static int map_dtz(Table& e, int f, int value, WDL wdl) {
+        static constexpr int WDLMap[] = {1, 3, 0, 2, 0};
+        PairsData* d = e.get(0, f);
+        uint8_t flags = d->flags;
+
+        if (flags & Mapped) {
+            int idx = d->map_idx[WDLMap[wdl + 2]] + value;
+            value = (flags & Wide) ? read_le16(e.map + 2 * idx) : e.map[idx];
+        }
+
+        if ((wdl == Win && !(flags & WinPlies)) || (wdl == Loss && !(flags & LossPlies))
+            || wdl == CursedWin || wdl == BlessedLoss) {
+            value *= 2;
+        }
+        return value + 1;
+    }
+
+    // --- INDEXING ---
+
+    // Encodes the position into its index within slice d of the table. Returns false
+    // (state = ChangeSTM) when a DTZ table only stores the other side to move.
+    static bool encode_index(const BoardState& board, Table& e, PairsData*& d, int& tb_file,
+                             uint64_t& idx, ProbeState& state) {
+        int squares[TB_PIECES];
+        int pieces[TB_PIECES];
+        int next = 0, size = 0, lead_pawns_cnt = 0;
+        uint64_t b, lead_pawns = 0;
+        tb_file = 0;
+
+        // Tables are built with the first-named side as white; symmetric tables store
+        // white to move only. Otherwise swap colours and mirror ranks.
+        int side_to_move = (board.to_move == Colour::White) ? 0 : 1;
+        bool symmetric_btm = (e.key == e.key2 && side_to_move == 1);
+        bool black_stronger = (material_key(board) != e.key);
+        int flip = (symmetric_btm || black_stronger) ? 1 : 0;
+        int flip_color = flip * 8;
+        int flip_squares = flip * 56;
+        int stm = flip ^ side_to_move;
+
+        // With pawns the table is split by the leading pawn's file (a-d after mirroring)
+        if (e.has_pawns) {
+            int pc = e.get(0, 0)->pieces[0] ^ flip_color;
+            lead_pawns = b = board.pieces[(pc == 1) ? 0 : 6];
+            while (b) {
+                squares[size++] = BitUtil::lsb(b) ^ flip_squares;
+                b &= b - 1;
+            }
+            lead_pawns_cnt = size;
+
+            std::swap(squares[0], *std::max_element(squares, squares + lead_pawns_cnt, pawns_comp));
+            tb_file = std::min(file_of(squares[0]), 7 - file_of(squares[0]));
+        }
+
+        // DTZ tables are one-sided
+        if (e.type == DTZTable) {
+            uint8_t flags = e.get(stm, tb_file)->flags;
+            if ((flags & STM) != stm && !(e.key == e.key2 && !e.has_pawns)) {
+                state = ChangeSTM;
+                return false;
+            }
+        }
+
+        b = board.occupancy[2] ^ lead_pawns;
+        while (b) {
+            int s = BitUtil::lsb(b);
+            b &= b - 1;
+            int p = 0;
+            while (!((board.pieces[p] >> s) & 1)) ++p;
+            squares[size] = s ^ flip_squares;
+            pieces[size++] = tb_piece(p) ^ flip_color;
+        }
+
+        d = e.get(stm, tb_file);
+
+        // Reorder into the table's piece sequence
+        for (int i = lead_pawns_cnt; i < size - 1; ++i) {
+            for (int j = i + 1; j < size; ++j) {
+                if (d->pieces[i] == pieces[j]) {
+                    std::swap(pieces[i], pieces[j]);
+                    std::swap(squares[i], squares[j]);
+                    break;
+                }
+            }
+        }
+
+        // Leading piece onto files a-d
+        if (file_of(squares[0]) > 3) {
+            for (int i = 0; i < size; ++i) squares[i] = flip_file(squares[i]);
+        }
+
+        if (e.has_pawns) {
+            idx = LeadPawnIdx[lead_pawns_cnt][squares[0]];
+            std::stable_sort(squares + 1, squares + lead_pawns_cnt, pawns_comp);
+            for (int i = 1; i < lead_pawns_cnt; ++i) idx += Binomial[i][MapPawns[squares[i]]];
+        } else {
+            // Leading piece onto ranks 1-4, then below the a1-h8 diagonal
+            if (rank_of(squares[0]) > 3) {
+                for (int i = 0; i < size; ++i) squares[i] = flip_rank(squares[i]);
+            }
+            for (int i = 0; i < d->group_len[0]; ++i) {
+                if (!off_a1h8(squares[i])) continue;
+                if (off_a1h8(squares[i]) > 0) {
+                    for (int j = i; j < size; ++j) squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+                }
+                break;
+            }
+
+            if (e.has_unique_pieces) {
+                int adjust1 = (squares[1] > squares[0]);
+                int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+
+                if (off_a1h8(squares[0])) {
+                    idx = (static_cast<uint64_t>(MapA1D1D4[squares[0]]) * 63
+                           + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+                } else if (off_a1h8(squares[1])) {
+                    idx = (6 * 63 + rank_of(squares[0]) * 28
+                           + static_cast<uint64_t>(MapB1H1H7[squares[1]])) * 62 + squares[2] - adjust2;
+                } else if (off_a1h8(squares[2])) {
+                    idx = 6 * 63 * 62 + 4 * 28 * 62
+                        + rank_of(squares[0]) * 7 * 28
+                        + (rank_of(squares[1]) - adjust1) * 28
+                        + MapB1H1H7[squares[2]];
+                } else {
+                    idx = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28
+                        + rank_of(squares[0]) * 7 * 6
+                        + (rank_of(squares[1]) - adjust1) * 6
+                        + (rank_of(squares[2]) - adjust2);
+                }
+            } else {
+                idx = MapKK[MapA1D1D4[squares[0]]][squares[1]];
+            }
+        }
+
+        // Remaining groups, each as a combination of squares not used by earlier groups
+        idx *= d->group_idx[0];
+        int* group_sq = squares + d->group_len[0];
+        bool remaining_pawns = e.has_pawns && e.pawns_both_sides;
+
+        while (d->group_len[++next]) {
+            std::stable_sort(group_sq, group_sq + d->group_len[next]);
+            uint64_t n = 0;
+            for (int i = 0; i < d->group_len[next]; ++i) {
+                int adjust = 0;
+                for (int* s = squares; s < group_sq; ++s) adjust += (group_sq[i] > *s);
+                n += Binomial[i + 1][group_sq[i] - adjust - 8 * remaining_pawns];
+            }
+            remaining_pawns = false;
+            idx += n * d->group_idx[next];
+            group_sq += d->group_len[next];
+        }
+        return true;
+    }
+
+    // Decodes the stored value: the WDL score, or the DTZ in plies
+    static int probe_table_entry(const BoardState& board, Table& e, WDL wdl, ProbeState& state) {
+        PairsData* d;
+        int tb_file;
+        uint64_t idx;
+        if (!encode_index(board, e, d, tb_file, idx, state)) return 0;
+
+        int value = decompress_pairs(d, idx);
+        if (e.type == WDLTable) return value - 2;
+        return map_dtz(e, tb_file, value, wdl);
+    }
+
+    static int probe_table(const BoardState& board, TableType type, ProbeState& state, WDL wdl = Draw) {
+        if (BitUtil::count_bits(board.occupancy[2]) == 2) return Draw;     // KvK
+
+        auto it = table_index.find(material_key(board));
+        if (it == table_index.end()) {
+            state = Fail;
+            return 0;
+        }
+        Table& e = (type == WDLTable) ? it->second->wdl : it->second->dtz;
+        if (!ensure_mapped(e)) {
+            state = Fail;
+            return 0;
+        }
+        return probe_table_entry(board, e, wdl, state);
+    }
+
+    // --- PROBING ---
+
+    static WDL negate(WDL w) { return static_cast<WDL>(-static_cast<int>(w)); }
+
+    // DTZ just before a zeroing move, given the position's outcome
+    static int dtz_before_zeroing(WDL wdl) {
+        return wdl == Win ? 1 : wdl == CursedWin ? 101 : wdl == BlessedLoss ? -101 : wdl == Loss ? -1 : 0;
+    }
+
+    static int sign_of(int v) { return (0 < v) - (v < 0); }
+
+    static bool is_pawn_move(const BoardState& board, const Move& m) {
+        int from = static_cast<int>(m.from());
+        return ((board.pieces[0] | board.pieces[6]) >> from) & 1;
+    }
+
+    static bool in_check(const BoardState& board) {
+        Colour them = (board.to_move == Colour::White) ? Colour::Black : Colour::White;
+        return Attacks::is_square_attacked(Search::find_king(board, board.to_move), them,
+                                           board.pieces.data(), board.occupancy[2]);
+    }
+
+    // Tables store "don't care" values where a capture (or, for DTZ, a pawn move) is
+    // best, so those moves are resolved by searching them and the table result is only
+    // trusted when nothing better was found
+    static WDL search(BoardState& board, ProbeState& result, bool check_zeroing) {
+        WDL value;
+        WDL best = Loss;
+
+        std::vector<Move> moves;
+        Notation::legal_moves(board, moves);
+        size_t total = moves.size();
+        size_t count = 0;
+
+        for (const auto& m : moves) {
+            if (!m.is_capture() && (!check_zeroing || !is_pawn_move(board, m))) continue;
+            ++count;
+
+            board.make_move(m);
+            value = negate(search(board, result, false));
+            board.undo_move(m);
+
+            if (result == Fail) return Draw;
+
+            if (value > best) {
+                best = value;
+                if (value >= Win) {
+                    result = ZeroingBestMove;
+                    return value;
+                }
+            }
+        }
+
+        bool no_more_moves = (count && count == total);
+        if (no_more_moves) {
+            value = best;
+        } else {
+            value = static_cast<WDL>(probe_table(board, WDLTable, result));
+            if (result == Fail) return Draw;
+        }
+
+        if (best >= value) {
+            result = (best > Draw || no_more_moves) ? ZeroingBestMove : Ok;
+            return best;
+        }
+        result = Ok;
+        return value;
+    }
+
+    WDL probe_wdl(BoardState& board, ProbeState& state) {
+        state = Ok;
+        return search(board, state, false);
+    }
+
+    int probe_dtz(BoardState& board, ProbeState& state) {
+        state = Ok;
+        WDL wdl = search(board, state, true);
+
+        if (state == Fail || wdl == Draw) return 0;
+        if (state == ZeroingBestMove) return dtz_before_zeroing(wdl);
+
+        int dtz = probe_table(board, DTZTable, state, wdl);
+        if (state == Fail) return 0;
+        if (state != ChangeSTM) {
+            return (dtz + 100 * (wdl == BlessedLoss || wdl == CursedWin)) * sign_of(wdl);
+        }
+
+        // Only the other side to move is stored: take the best reply's DTZ
+        std::vector<Move> moves;
+        Notation::legal_moves(board, moves);
+        int min_dtz = 0xFFFF;
+
+        for (const auto& m : moves) {
+            bool zeroing = m.is_capture() || is_pawn_move(board, m);
+
+            board.make_move(m);
+            dtz = zeroing ? -dtz_before_zeroing(search(board, state, false))
+                          : -probe_dtz(board, state);
+
+            if (dtz == 1 && in_check(board)) {
+                std::vector<Move> replies;
+                Notation::legal_moves(board, replies);
+                if (replies.empty()) min_dtz = 1;   // Mate
+            }
+            if (!zeroing) dtz += sign_of(dtz);
+            if (dtz < min_dtz && sign_of(dtz) == sign_of(wdl)) min_dtz = dtz;
+            board.undo_move(m);
+
+            if (state == Fail) return 0;
+        }
+        return (min_dtz == 0xFFFF) ? -1 : min_dtz;
+    }
+
+    // Any position repeated since the last capture or pawn move
+    static bool has_repeated(const BoardState& board) {
+        int n = static_cast<int>(board.history.size());
+        int limit = std::min(static_cast<int>(board.history.held()), static_cast<int>(board.half_move_clock));
+        std::vector<uint64_t> keys;
+        keys.push_back(board.key);
+        for (int i = 1; i <= limit; ++i) keys.push_back(board.history[n - i].key);
+        std::sort(keys.begin(), keys.end());
+        return std::adjacent_find(keys.begin(), keys.end()) != keys.end();
+    }
+
+    // Rank scale for root moves: above any DTZ plus fifty-move count a 7-piece table holds
+    static constexpr int MAX_DTZ = 1 << 18;
+
+    bool root_probe(BoardState& board, Move& best, WDL& wdl, int& dtz) {
+        int cnt50 = board.half_move_clock;
+        bool rep = has_repeated(board);
+
+        std::vector<Move> moves;
+        Notation::legal_moves(board, moves);
+        if (moves.empty()) return false;
+
+        int best_rank = INT_MIN;
+        int best_dtz = 0;
+
+        for (const auto& m : moves) {
+            ProbeState result = Ok;
+            int d;
+
+            board.make_move(m);
+            if (board.half_move_clock == 0) {
+                d = dtz_before_zeroing(negate(probe_wdl(board, result)));
+            } else if (board.is_draw(1)) {
+                d = 0;      // One ply from the root, so a repetition (or the fifty-move rule)
+            } else {
+                d = -probe_dtz(board, result);
+                d = (d > 0) ? d + 1 : (d < 0) ? d - 1 : 0;
+            }
+            if (d == 2 && in_check(board)) {
+                std::vector<Move> replies;
+                Notation::legal_moves(board, replies);
+                if (replies.empty()) d = 1;
+            }
+            board.undo_move(m);
+
+            if (result == Fail) return false;
+
+            // Certain wins rank equally; wins and losses drift towards 0 as the
+            // fifty-move rule comes into play
+            int rank = (d > 0) ? ((d + cnt50 <= 99 && !rep) ? MAX_DTZ : MAX_DTZ - (d + cnt50))
+                     : (d < 0) ? ((-d * 2 + cnt50 < 100) ? -MAX_DTZ : -MAX_DTZ + (-d + cnt50))
+                     : 0;
+
+            // Ties: win in the fewest plies, lose in the most
+            if (rank > best_rank || (rank == best_rank && d != 0 && d < best_dtz)) {
+                best_rank = rank;
+                best_dtz = d;
+                best = m;
+            }
+        }
+
+        // Only a zeroing move within the fifty-move count keeps the result
+        dtz = best_dtz;
+        wdl = (best_dtz > 0)  ? ((best_dtz + cnt50 <= 99) ? Win : CursedWin)
+            : (best_dtz < 0)  ? ((-best_dtz + cnt50 <= 99) ? Loss : BlessedLoss)
+            : Draw;
+        return true;
+    }
+
+    // --- SETUP ---
+
+    static void add_table(const std::string& white, const std::string& black) {
+        std::string name = "K" + white + "vK" + black;
+        if (!exists_in_paths(name + ".rtbw")) return;
+
+        int counts[2][5] = {};
+        for (char c : white) counts[0][piece_type_from_char(c)]++;
+        for (char c : black) counts[1][piece_type_from_char(c)]++;
+        uint64_t key = signature(counts);
+        if (table_index.count(key)) return;
+
+        int swapped[2][5];
+        for (int t = 0; t < 5; ++t) {
+            swapped[0][t] = counts[1][t];
+            swapped[1][t] = counts[0][t];
+        }
+
+        auto pair = std::make_unique<TablePair>();
+        for (Table* t : {&pair->wdl, &pair->dtz}) {
+            t->type = (t == &pair->wdl) ? WDLTable : DTZTable;
+            t->name = name;
+            t->key = key;
+            t->key2 = signature(swapped);
+            t->piece_count = 2 + static_cast<int>(white.size() + black.size());
+            t->has_pawns = counts[0][0] + counts[1][0] > 0;
+            t->pawns_both_sides = counts[0][0] > 0 && counts[1][0] > 0;
+            t->has_unique_pieces = false;
+            for (int c = 0; c < 2; ++c)
+                for (int p = 0; p < 5; ++p)
+                    if (counts[c][p] == 1) t->has_unique_pieces = true;
+        }
+
+        max_cardinality = std::max(max_cardinality, pair->wdl.piece_count);
+        table_index[pair->wdl.key] = pair.get();
+        table_index[pair->wdl.key2] = pair.get();
+        tables.push_back(std::move(pair));
+    }
+
+    // Every multiset of non-king pieces up to max_len, strongest first ("QRB", "NP", ...)
+    static void piece_sets(std::vector<std::string>& out, std::string prefix, int first, int max_len) {
+        static const char order[] = "QRBNP";
+        out.push_back(prefix);
+        if (static_cast<int>(prefix.size()) == max_len) return;
+        for (int i = first; i < 5; ++i) piece_sets(out, prefix + order[i], i, max_len);
+    }
+
+    int init(const std::string& paths) {
+        Attacks::init();
+        init_indices();
+
+        table_index.clear();
+        tables.clear();
+        search_paths.clear();
+        max_cardinality = 0;
+
+#ifdef _WIN32
+        const char sep = ';';
+#else
+        const char sep = ':';
+#endif
+        size_t start = 0;
+        while (start <= paths.size()) {
+            size_t end = paths.find(sep, start);
+            if (end == std::string::npos) end = paths.size();
+            if (end > start) search_paths.push_back(paths.substr(start, end - start));
+            start = end + 1;
+        }
+        if (search_paths.empty()) return 0;
+
+        std::vector<std::string> sets;
+        piece_sets(sets, "", 0, TB_PIECES - 2);
+        for (const auto& w : sets) {
+            for (const auto& b : sets) {
+                if (w.size() + b.size() == 0 || w.size() + b.size() > TB_PIECES - 2) continue;
+                add_table(w, b);
+            }
+        }
+        return max_cardinality;
+    }
+
+    int max_pieces() {
+        return max_cardinality;
+    }
+
+    void set_probe_limits(int depth, int limit) {
+        search_probe_depth = std::max(depth, 0);
+        search_probe_limit = std::clamp(limit, 0, TB_PIECES);
+    }
+
+    int probe_depth() {
+        return search_probe_depth;
+    }
+
+    int probe_limit() {
+        return std::min(search_probe_limit, max_cardinality);
+    }
+}
@@ -0,0 +1,101 @@
+#include "ThreadPool.hpp"
+#include "Memory.hpp"
+
+namespace {
+    // Index of the pool worker running on this thread (-1 for outside threads)
+    thread_local int tls_worker_index = -1;
+    thread_local const ThreadPool* tls_worker_pool = nullptr;
+}
+
+ThreadPool::ThreadPool(int num_threads) {
+    int n = resolve_thread_count(num_threads);
+    queues.reserve(n);
+    for (int i = 0; i < n; ++i) queues.push_back(std::make_unique<WorkerQueue>());
+    workers.reserve(n);
+    for (int i = 0; i < n; ++i) workers.emplace_back([this, i]() { worker_loop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stopping = true;
+    }
+    work_cv.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+int ThreadPool::resolve_thread_count(int requested) {
+    if (requested > 0) return requested;
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    return hw > 0 ? hw : 1;
+}
+
+void ThreadPool::submit(Task task) {
+    // Tasks spawned from inside a worker stay local; outside submissions are spread round-robin
+    int idx = (tls_worker_pool == this)
+        ? tls_worker_index
+        : next_queue.fetch_add(1, std::memory_order_relaxed) % static_cast<int>(queues.size());
+
+    {
+        std::lock_guard<std::mutex> lock(queues[idx]->mutex);
+        queues[idx]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        queued++;
+        pending++;
+    }
+    work_cv.notify_one();
+}
+
+void ThreadPool::wait_idle() {
+    std::unique_lock<std::mutex> lock(state_mutex);
+    idle_cv.wait(lock, [this]() { return pending == 0; });
+}
+
+bool ThreadPool::try_pop(int idx, Task& out) {
+    // Own queue first (LIFO keeps caches warm)...
+    {
+        auto& q = *queues[idx];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            out = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            return true;
+        }
+    }
+    // ...then steal the oldest task from a neighbour
+    int n = static_cast<int>(queues.size());
+    for (int k = 1; k < n; ++k) {
+        auto& q = *queues[(idx + k) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.tasks.empty()) {
+            out = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::worker_loop(int idx) {
+    tls_worker_index = idx;
+    tls_worker_pool = this;
+    Memory::pin_thread(idx);
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            work_cv.wait(lock, [this]() { return queued > 0 || stopping; });
+            if (queued == 0) return;  // Stopping and drained
+            queued--;                 // Claim one task; it is guaranteed to be in some queue
+        }
+
+        Task task;
+        while (!try_pop(idx, task)) std::this_thread::yield();
+        task();
+
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (--pending == 0) idle_cv.notify_all();
+    }
+}
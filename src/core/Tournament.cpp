@@ -0,0 +1,74 @@
+#include "Tournament.hpp"
+#include "Game.hpp"
+#include "ThreadPool.hpp"
+#include "Attacks.hpp"
+#include "Zobrist.hpp"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+namespace Tournament {
+
+    struct Pairing {
+        int game_id;
+        int white;
+        int black;
+        int opening;
+    };
+
+    int run(const TournamentConfig& config, ResultCallback on_result) {
+        // Shared tables must be built before any worker touches them
+        Attacks::init();
+        Zobrist::init();
+
+        std::vector<Pairing> games;
+        int num_bots = static_cast<int>(config.bots.size());
+        int num_openings = static_cast<int>(config.openings.size());
+        for (int a = 0; a < num_bots; ++a) {
+            for (int b = a + 1; b < num_bots; ++b) {
+                for (int o = 0; o < num_openings; ++o) {
+                    for (int g = 0; g < config.games_per_pairing; ++g) {
+                        int id = static_cast<int>(games.size());
+                        if (g % 2 == 0) games.push_back({id, a, b, o});
+                        else            games.push_back({id, b, a, o});
+                    }
+                }
+            }
+        }
+        if (games.empty()) return 0;
+
+        std::mutex report_mutex;
+        int threads = std::min(ThreadPool::resolve_thread_count(config.num_threads),
+                               static_cast<int>(games.size()));
+        ThreadPool pool(threads);
+
+        for (const auto& p : games) {
+            pool.submit([&config, &report_mutex, on_result, p]() {
+                Game::GameConfig gc;
+                gc.white_eval = config.bots[p.white];
+                gc.black_eval = config.bots[p.black];
+                gc.depth      = config.depth;
+                gc.max_moves  = config.max_moves;
+                gc.fen        = config.openings[p.opening];
+                gc.time_control[0] = {config.base_ms, config.increment_ms};
+                gc.time_control[1] = {config.base_ms, config.increment_ms};
+                gc.adjudication    = config.adjudication;
+                gc.book            = config.book;
+                gc.book_plies      = config.book_plies;
+                gc.seed            = static_cast<uint64_t>(p.game_id);
+
+                auto t0 = std::chrono::steady_clock::now();
+                int result = Game::play(gc).result;
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+                if (on_result) {
+                    std::lock_guard<std::mutex> lock(report_mutex);
+                    on_result(p.game_id, p.white, p.black, p.opening, result, elapsed);
+                }
+            });
+        }
+
+        pool.wait_idle();
+        return static_cast<int>(games.size());
+    }
+}
@@ -0,0 +1,208 @@
+#include "Trace.hpp"
+#include "Game.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+
+    std::atomic<bool> recording{false};
+
+    struct Event {
+        const char* name;
+        const char* category;
+        int64_t start_ns;
+        int64_t dur_ns;             // -1 = instant event
+        Arg args[3];
+        uint32_t track;
+        uint16_t move;
+    };
+
+    // Written only by its thread; count is published after each event so stop() can read
+    // the buffer while that thread is still running
+    struct Buffer {
+        std::unique_ptr<Event[]> events;
+        size_t capacity = 0;
+        std::atomic<size_t> count{0};
+        std::atomic<uint64_t> dropped{0};
+        uint32_t tid = 0;
+    };
+
+    struct Track {
+        uint32_t id;
+        const char* name;
+        int64_t index;
+    };
+
+    // --- SESSION ---
+    static std::mutex session_mutex;
+    static std::vector<std::unique_ptr<Buffer>> buffers;
+    static std::vector<Track> tracks;
+    static std::atomic<uint32_t> session{0};
+    static std::atomic<int64_t> epoch_ns{0};
+    static std::atomic<uint32_t> sample_every{256};
+    static size_t events_per_thread = 0;
+
+    // Track ids above every thread id
+    static constexpr uint32_t FIRST_TRACK = 1u << 16;
+
+    static thread_local Buffer* local_buffer = nullptr;
+    static thread_local uint32_t local_session = 0;
+    static thread_local uint32_t current_track = 0;
+    static thread_local uint32_t sample_counters[2] = {0, 0};
+
+    static int64_t clock_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int64_t now_ns() {
+        return clock_ns() - epoch_ns.load(std::memory_order_relaxed);
+    }
+
+    void start(const Options& options) {
+        std::lock_guard<std::mutex> lock(session_mutex);
+        recording.store(false);
+        buffers.clear();
+        tracks.clear();
+        events_per_thread = std::max<size_t>(options.events_per_thread, 1);
+        sample_every.store(std::max<uint32_t>(options.sample_every, 1), std::memory_order_relaxed);
+        epoch_ns.store(clock_ns(), std::memory_order_relaxed);
+        session.fetch_add(1);
+        recording.store(true);
+    }
+
+    // This thread's buffer for the current session, made on its first event
+    static Buffer* buffer() {
+        uint32_t s = session.load(std::memory_order_acquire);
+        if (local_session == s) return local_buffer;
+
+        std::lock_guard<std::mutex> lock(session_mutex);
+        auto b = std::make_unique<Buffer>();
+        b->events = std::make_unique<Event[]>(events_per_thread);
+        b->capacity = events_per_thread;
+        b->tid = static_cast<uint32_t>(buffers.size()) + 1;
+        local_buffer = b.get();
+        local_session = s;
+        current_track = 0;
+        buffers.push_back(std::move(b));
+        return local_buffer;
+    }
+
+    static void record(const Event& e) {
+        if (!enabled()) return;
+        Buffer* b = buffer();
+        size_t n = b->count.load(std::memory_order_relaxed);
+        if (n >= b->capacity) {
+            b->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        b->events[n] = e;
+        b->events[n].track = (current_track != 0) ? current_track : b->tid;
+        b->count.store(n + 1, std::memory_order_release);
+    }
+
+    void complete(const char* name, const char* category, int64_t start_ns,
+                  Arg a, Arg b, Arg c, uint16_t move) {
+        record(Event{name, category, start_ns, now_ns() - start_ns, {a, b, c}, 0, move});
+    }
+
+    void instant(const char* name, const char* category, Arg a, Arg b, uint16_t move) {
+        record(Event{name, category, now_ns(), -1, {a, b, {}}, 0, move});
+    }
+
+    bool sample(Sampler which, uint32_t count) {
+        uint32_t every = sample_every.load(std::memory_order_relaxed);
+        uint32_t& counter = sample_counters[which];
+        counter += count;
+        if (counter < every) return false;
+        counter %= every;
+        return true;
+    }
+
+    // --- TRACKS ---
+    uint32_t new_track(const char* name, int64_t index) {
+        if (!enabled()) return 0;
+        std::lock_guard<std::mutex> lock(session_mutex);
+        uint32_t id = FIRST_TRACK + static_cast<uint32_t>(tracks.size());
+        tracks.push_back({id, name, index});
+        return id;
+    }
+
+    TrackScope::TrackScope(uint32_t track) {
+        if (track == 0 || !enabled()) return;
+        buffer();   // Starting a buffer resets the track, so do it first
+        previous = current_track;
+        current_track = track;
+        active = true;
+    }
+
+    TrackScope::~TrackScope() {
+        if (active) current_track = previous;
+    }
+
+    // --- OUTPUT ---
+    static void write_args(std::FILE* f, const Event& e) {
+        bool first = true;
+        std::fputs(",\"args\":{", f);
+        for (const Arg& a : e.args) {
+            if (a.name == nullptr) continue;
+            std::fprintf(f, "%s\"%s\":%lld", first ? "" : ",", a.name, static_cast<long long>(a.value));
+            first = false;
+        }
+        if (e.move != 0) {
+            Move m(static_cast<Square>(e.move & 0x3F), static_cast<Square>((e.move >> 6) & 0x3F),
+                   static_cast<MoveFlag>(e.move >> 12));
+            std::fprintf(f, "%s\"move\":\"%s\"", first ? "" : ",", Game::move_to_uci(m).c_str());
+        }
+        std::fputc('}', f);
+    }
+
+    int64_t stop(const std::string& path, uint64_t* dropped) {
+        std::lock_guard<std::mutex> lock(session_mutex);
+        recording.store(false);
+
+        uint64_t lost = 0;
+        for (const auto& b : buffers) lost += b->dropped.load(std::memory_order_relaxed);
+        if (dropped != nullptr) *dropped = lost;
+
+        std::FILE* f = std::fopen(path.c_str(), "w");
+        if (f == nullptr) return -1;
+
+        // Timestamps are in microseconds
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+        std::fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ChessLib\"}}", f);
+        for (const auto& b : buffers) {
+            std::fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                            "\"args\":{\"name\":\"thread %u\"}}", b->tid, b->tid);
+        }
+        for (const Track& t : tracks) {
+            std::fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                            "\"args\":{\"name\":\"%s %lld\"}}", t.id, t.name, static_cast<long long>(t.index));
+        }
+
+        int64_t written = 0;
+        for (const auto& b : buffers) {
+            size_t n = b->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < n; ++i) {
+                const Event& e = b->events[i];
+                std::fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f",
+                             e.name, e.category, e.track, static_cast<double>(e.start_ns) / 1000.0);
+                if (e.dur_ns >= 0) std::fprintf(f, ",\"ph\":\"X\",\"dur\":%.3f", static_cast<double>(e.dur_ns) / 1000.0);
+                else std::fputs(",\"ph\":\"i\",\"s\":\"t\"", f);
+                write_args(f, e);
+                std::fputc('}', f);
+                ++written;
+            }
+        }
+        std::fprintf(f, "\n],\"otherData\":{\"sample_every\":%u,\"dropped_events\":%llu}}\n",
+                     sample_every.load(std::memory_order_relaxed), static_cast<unsigned long long>(lost));
+
+        bool ok = !std::ferror(f);
+        ok = (std::fclose(f) == 0) && ok;
+        return ok ? written : -1;
+    }
+}
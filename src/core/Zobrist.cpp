@@ -1,13 +1,68 @@
 #include "Zobrist.hpp"
+#include <cstdlib>
 #include <random>
+#include <utility>
 
 namespace Zobrist {
     std::array<std::array<uint64_t, 64>, 12> piece_keys;
     std::array<uint64_t, 65> en_passant_keys;
     std::array<uint64_t, 16> castle_keys;
     uint64_t side_key;
+    std::array<uint64_t, CUCKOO_SIZE> cuckoo_keys;
+    std::array<uint64_t, CUCKOO_SIZE> cuckoo_paths;
+
+    // Whether piece type pt (1 = knight .. 5 = king) goes from a to b on an empty board
+    static bool reaches(int pt, int a, int b) {
+        int df = std::abs((a & 7) - (b & 7));
+        int dr = std::abs((a >> 3) - (b >> 3));
+        switch (pt) {
+            case 1: return (df == 1 && dr == 2) || (df == 2 && dr == 1);
+            case 2: return df == dr;
+            case 3: return df == 0 || dr == 0;
+            case 4: return df == dr || df == 0 || dr == 0;
+            case 5: return df <= 1 && dr <= 1;
+        }
+        return false;
+    }
+
+    // Squares strictly between a and b on a shared line (none for knight and king hops)
+    static uint64_t path(int a, int b) {
+        int df = (b & 7) - (a & 7);
+        int dr = (b >> 3) - (a >> 3);
+        if (df != 0 && dr != 0 && std::abs(df) != std::abs(dr)) return 0;
+        int step = ((dr > 0) - (dr < 0)) * 8 + ((df > 0) - (df < 0));
+        uint64_t squares = 0;
+        for (int sq = a + step; sq != b; sq += step) squares |= 1ULL << sq;
+        return squares;
+    }
+
+    static void init_cuckoo() {
+        cuckoo_keys.fill(0);
+        cuckoo_paths.fill(0);
+        for (int p = 0; p < 12; ++p) {
+            if (p % 6 == 0) continue;   // Pawn moves are irreversible
+            for (int a = 0; a < 64; ++a) {
+                for (int b = a + 1; b < 64; ++b) {
+                    if (!reaches(p % 6, a, b)) continue;
+                    uint64_t k = piece_keys[p][a] ^ piece_keys[p][b] ^ side_key;
+                    uint64_t squares = path(a, b);
+                    // Kick out whoever holds the slot and move it to its other one
+                    int slot = cuckoo_h1(k);
+                    while (true) {
+                        std::swap(cuckoo_keys[slot], k);
+                        std::swap(cuckoo_paths[slot], squares);
+                        if (k == 0) break;
+                        slot = (slot == cuckoo_h1(k)) ? cuckoo_h2(k) : cuckoo_h1(k);
+                    }
+                }
+            }
+        }
+    }
 
     void init() {
+        static bool initialized = false;
+        if (initialized) return;
+
         std::mt19937_64 rng(123456789ULL);
         std::uniform_int_distribution<uint64_t> dist;
 
@@ -26,5 +81,7 @@ namespace Zobrist {
         }
 
         side_key = dist(rng);
+        init_cuckoo();
+        initialized = true;
     }
 }
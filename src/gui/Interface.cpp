@@ -15,30 +15,11 @@
 #include "Attacks.hpp"
 #include "BitUtil.hpp"
 #include "Zobrist.hpp"
+#include "Game.hpp"
+#include "MateSolver.hpp"
 
 extern std::atomic<int> g_current_searcher;
 
-// Convert a Move to UCI string (e.g. "e2e4", "e7e8q")
-static std::string move_to_uci(const Move& m) {
-    int from = static_cast<int>(m.from());
-    int to   = static_cast<int>(m.to());
-    char buf[6];
-    buf[0] = 'a' + (from % 8);
-    buf[1] = '1' + (from / 8);
-    buf[2] = 'a' + (to % 8);
-    buf[3] = '1' + (to / 8);
-    int len = 4;
-    if (m.is_promotion()) {
-        if      (m.is_promo_queen())  buf[4] = 'q';
-        else if (m.is_promo_rook())   buf[4] = 'r';
-        else if (m.is_promo_bishop()) buf[4] = 'b';
-        else if (m.is_promo_knight()) buf[4] = 'n';
-        len = 5;
-    }
-    buf[len] = '\0';
-    return std::string(buf);
-}
-
 const int TILE_SIZE = 75;
 const int BOARD_PADDING = 30;
 const int PANEL_WIDTH = 300;
@@ -96,22 +77,7 @@ namespace GUI {
         BoardState board;
         
         // --- LOAD FEN OR DEFAULT ---
-        if (start_fen.empty() || start_fen == "startpos") {
-            board.pieces[0] = 0x000000000000FF00ULL; board.pieces[6] = 0x00FF000000000000ULL;
-            board.pieces[1] = 0x0000000000000042ULL; board.pieces[7] = 0x4200000000000000ULL;
-            board.pieces[2] = 0x0000000000000024ULL; board.pieces[8] = 0x2400000000000000ULL;
-            board.pieces[3] = 0x0000000000000081ULL; board.pieces[9] = 0x8100000000000000ULL;
-            board.pieces[4] = 0x0000000000000008ULL; board.pieces[10] = 0x0800000000000000ULL;
-            board.pieces[5] = 0x0000000000000010ULL; board.pieces[11] = 0x1000000000000000ULL;
-            board.occupancy[0] = 0ULL; board.occupancy[1] = 0ULL;
-            for (int i = 0; i < 6; ++i) board.occupancy[0] |= board.pieces[i];
-            for (int i = 6; i < 12; ++i) board.occupancy[1] |= board.pieces[i];
-            board.occupancy[2] = board.occupancy[0] | board.occupancy[1];
-            board.to_move = Colour::White; board.castle_rights = 0b1111; board.full_move_number = 1;
-            board.refresh_hash();
-        } else {
-            board.load_fen(start_fen);
-        }
+        Game::setup_board(board, start_fen);
 
         Assets assets; assets.load();
         Square selected_sq = Square::None;
@@ -137,6 +103,18 @@ namespace GUI {
         Move bot_move_result;                 // Where the thread stores the best move
         Search::SearchStats bot_stats_result; // Where the thread stores stats
 
+        // Per-side search memory kept across moves (only the bot thread touches it while thinking)
+        Search::SearchState search_states[2];
+
+        // --- MATE SOLVER STATE ---
+        std::thread solver_thread;
+        std::atomic<bool> is_solving(false);
+        std::atomic<bool> solver_stop(false);
+        MateSolver::Result solver_result;
+        uint64_t solved_key = 0;              // Position the result belongs to
+        int solver_max_moves = 5;
+        int solved_max_moves = 0;
+
         auto check_game_over = [&](BoardState& b) {
             if (b.is_draw()) {
                 game_over = true;
@@ -264,7 +242,7 @@ namespace GUI {
                                         if(idx==2 && m.is_promo_bishop()) match=true;
                                         if(idx==3 && m.is_promo_knight()) match=true;
                                         if(match) { 
-                                            move_history.push_back(move_to_uci(m));
+                                            move_history.push_back(Game::move_to_uci(m));
                                             move_stack.push_back(m);
                                             board.make_move(m); is_promoting=false; selected_sq=Square::None; valid_moves.clear(); 
                                             check_game_over(board); break; 
@@ -280,7 +258,7 @@ namespace GUI {
                                     for (const auto& m : valid_moves) {
                                         if (m.to() == clicked) {
                                             if (m.is_promotion()) { is_promoting=true; promo_from=m.from(); promo_to=m.to(); moved=true; break; }
-                                            move_history.push_back(move_to_uci(m));
+                                            move_history.push_back(Game::move_to_uci(m));
                                             move_stack.push_back(m);
                                             board.make_move(m); selected_sq = Square::None; valid_moves.clear(); moved = true;
                                             check_game_over(board); break;
@@ -354,28 +332,51 @@ namespace GUI {
                 else ImGui::Text("Score: %.2f", sc);
             }
 
+            ImGui::Spacing();
+            ImGui::TextColored(ImVec4(1,0.5f,0,1), "MATE SOLVER");
+            ImGui::Separator();
+            ImGui::SliderInt("Max moves", &solver_max_moves, 1, 20);
+            if (is_solving) {
+                if (ImGui::Button("Stop Solver", ImVec2(100, 30))) solver_stop = true;
+                ImGui::SameLine(); ImGui::Text("Solving...");
+            } else if (ImGui::Button("Solve Mate", ImVec2(100, 30)) && !solver_thread.joinable()) {
+                // Proof-number search on a copy of the current position; no eval involved
+                is_solving = true;
+                solver_stop = false;
+                solved_key = board.key;
+                solved_max_moves = solver_max_moves;
+                BoardState board_copy = board;
+                MateSolver::Options options;
+                options.max_moves = solver_max_moves;
+                options.stop = &solver_stop;
+                solver_thread = std::thread([board_copy, options, &solver_result, &is_solving]() mutable {
+                    solver_result = MateSolver::solve(board_copy, options);
+                    is_solving = false;
+                });
+            }
+            if (!is_solving && solver_thread.joinable()) solver_thread.join();
+            if (!is_solving && solved_key != 0 && solved_key == board.key) {
+                if (solver_result.status == MateSolver::Mate) {
+                    std::string line;
+                    for (const auto& m : solver_result.pv) line += Game::move_to_uci(m) + " ";
+                    ImGui::TextColored(ImVec4(0,1,0,1), "Mate in %d", solver_result.mate_in);
+                    ImGui::TextWrapped("%s", line.c_str());
+                } else if (solver_result.status == MateSolver::NoMate) {
+                    ImGui::Text("No mate in %d", solved_max_moves);
+                } else {
+                    ImGui::Text("Stopped before an answer");
+                }
+                ImGui::Text("Nodes: %llu (%lld ms)", static_cast<unsigned long long>(solver_result.nodes),
+                            static_cast<long long>(solver_result.time_ms));
+            }
+
             ImGui::Spacing(); ImGui::Separator();
             
             // Only allow Reset if bot isn't busy (to prevent threading crashes)
             if (!is_thinking) {
                 if (ImGui::Button("Reset Game", ImVec2(100, 30))) {
-                    board = BoardState(); 
-                    if (start_fen.empty() || start_fen == "startpos") {
-                        board.pieces[0] = 0x000000000000FF00ULL; board.pieces[6] = 0x00FF000000000000ULL;
-                        board.pieces[1] = 0x0000000000000042ULL; board.pieces[7] = 0x4200000000000000ULL;
-                        board.pieces[2] = 0x0000000000000024ULL; board.pieces[8] = 0x2400000000000000ULL;
-                        board.pieces[3] = 0x0000000000000081ULL; board.pieces[9] = 0x8100000000000000ULL;
-                        board.pieces[4] = 0x0000000000000008ULL; board.pieces[10] = 0x0800000000000000ULL;
-                        board.pieces[5] = 0x0000000000000010ULL; board.pieces[11] = 0x1000000000000000ULL;
-                        board.occupancy[0] = 0ULL; board.occupancy[1] = 0ULL;
-                        for (int i = 0; i < 6; ++i) board.occupancy[0] |= board.pieces[i];
-                        for (int i = 6; i < 12; ++i) board.occupancy[1] |= board.pieces[i];
-                        board.occupancy[2] = board.occupancy[0] | board.occupancy[1];
-                        board.to_move = Colour::White; board.castle_rights = 0b1111; board.full_move_number = 1;
-                        board.refresh_hash();
-                    } else {
-                        board.load_fen(start_fen);
-                    }
+                    Game::setup_board(board, start_fen);
+                    search_states[0].clear(); search_states[1].clear();
                     is_promoting = false; last_stats = Search::SearchStats();
                     game_over = false; winner_text = "";
                     move_history.clear();
@@ -398,7 +399,7 @@ namespace GUI {
                         // If it's the human's turn, undo 2 plies (bot + human)
                         // If game is over on bot's turn (e.g. human delivered checkmate), undo 1 ply
                         int plies_to_undo = (board.to_move == human_side && move_stack.size() >= 2) ? 2 : 1;
-                        for (int i = 0; i < plies_to_undo && !move_stack.empty(); ++i) {
+                        for (int i = 0; i < plies_to_undo && !move_stack.empty() && board.history.held() > 0; ++i) {
                             board.undo_move(move_stack.back());
                             move_stack.pop_back();
                             move_history.pop_back();
@@ -431,6 +432,7 @@ namespace GUI {
                 Search::SearchParams params;
                 params.depth = depth;
                 params.evalFunc = evalFunc;
+                params.state = &search_states[(board.to_move == Colour::White) ? 0 : 1];
                 
                 bot_thread = std::thread([board_copy, params, &bot_move_result, &bot_stats_result, &is_thinking]() mutable {
                     bot_move_result = Search::iterative_deepening(board_copy, params, bot_stats_result);
@@ -442,7 +444,7 @@ namespace GUI {
                 bot_thread.join();
                 
                 if (bot_move_result.raw() != 0) {
-                    move_history.push_back(move_to_uci(bot_move_result));
+                    move_history.push_back(Game::move_to_uci(bot_move_result));
                     move_stack.push_back(bot_move_result);
                     board.make_move(bot_move_result);
                     check_game_over(board);
@@ -460,6 +462,8 @@ namespace GUI {
         }
         
         if (bot_thread.joinable()) bot_thread.join();
+        solver_stop = true;
+        if (solver_thread.joinable()) solver_thread.join();
 
         // Build UCI move string for PGN export
         uci_moves_out.clear();
@@ -0,0 +1,576 @@
+#include "Search.hpp"
+#include "Bench.hpp"
+#include "Evaluation.hpp"
+#include "Game.hpp"
+#include "Notation.hpp"
+#include "Tablebase.hpp"
+#include "Nnue.hpp"
+#include "MateSolver.hpp"
+#include "Memory.hpp"
+#include "Attacks.hpp"
+#include "Zobrist.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+// Standalone UCI engine: the shared search behind stdin/stdout, so external match
+// runners (cutechess-cli, fastchess) can drive it. The eval is the built-in one or a
+// bot callback exported from a shared library (setoption EvalLibrary / EvalSymbol).
+namespace Uci {
+
+    static constexpr const char* ENGINE_NAME = "ChessEngineFramework";
+    static constexpr int DEFAULT_HASH_MB = 16;
+    static constexpr int MAX_HASH_MB = 4096;
+    static constexpr int MAX_THREADS = 256;
+    static constexpr int32_t MATE_SCORE = 100000;
+    static constexpr int32_t MATE_BOUND = 90000;
+
+    // --- OUTPUT ---
+    // Search thread and input thread both write; keep whole lines together
+    static std::mutex out_mutex;
+
+    static void send(const std::string& line) {
+        std::lock_guard<std::mutex> lock(out_mutex);
+        std::cout << line << std::endl;
+    }
+
+    // --- EVAL LIBRARY ---
+    class EvalLibrary {
+    public:
+        ~EvalLibrary() { unload(); }
+
+        // Returns nullptr (and keeps nothing loaded) if the library or symbol is missing
+        Search::EvalCallback load(const std::string& path, const std::string& symbol) {
+            unload();
+#ifdef _WIN32
+            HMODULE h = LoadLibraryA(path.c_str());
+            if (!h) return nullptr;
+            void* fn = reinterpret_cast<void*>(GetProcAddress(h, symbol.c_str()));
+#else
+            void* h = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+            if (!h) return nullptr;
+            void* fn = dlsym(h, symbol.c_str());
+#endif
+            handle = h;
+            if (!fn) {
+                unload();
+                return nullptr;
+            }
+            return reinterpret_cast<Search::EvalCallback>(fn);
+        }
+
+        void unload() {
+            if (!handle) return;
+#ifdef _WIN32
+            FreeLibrary(static_cast<HMODULE>(handle));
+#else
+            dlclose(handle);
+#endif
+            handle = nullptr;
+        }
+
+    private:
+        void* handle = nullptr;
+    };
+
+    // --- ENGINE ---
+    struct Engine {
+        BoardState board;
+        Search::SearchState state{DEFAULT_HASH_MB};
+        int hash_mb = DEFAULT_HASH_MB;
+        Search::EvalCallback eval = Evaluation::evaluate;
+        EvalLibrary library;
+        std::string eval_path;
+        std::string eval_symbol = "evaluation_function";
+        std::string syzygy_path;
+        int syzygy_probe_depth = 1;
+        int syzygy_probe_limit = 7;
+        Search::Backend backend = Search::Backend::AlphaBeta;
+        Search::MctsOptions mcts;
+        bool profile = false;           // Hardware counters after each search
+        bool copy_make = false;         // Search with copy-make instead of make/undo
+        bool memory_reported = false;   // Placement sent since the TT was last reallocated
+
+        std::thread worker;
+        std::atomic<bool> stop{false};
+
+        // "go ponder" / "go infinite" hold bestmove back until ponderhit or stop
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool holding = false;
+        bool ponder_timed = false;      // ponderhit switches the search onto this budget
+        int64_t ponder_budget_ms = 0;
+
+        std::thread watchdog;           // Enforces the budget after a ponderhit
+    };
+
+    // --- HELPERS ---
+
+    // Legal move in board whose encoding is raw; Move() if there is none
+    static Move find_move(BoardState& board, uint16_t raw) {
+        if (raw == 0) return Move();
+        std::vector<Move> moves;
+        Notation::legal_moves(board, moves);
+        for (const auto& m : moves) {
+            if (m.raw() == raw) return m;
+        }
+        return Move();
+    }
+
+    static std::string format_score(int32_t score) {
+        if (score > MATE_BOUND) return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+        if (score < -MATE_BOUND) return "mate -" + std::to_string((MATE_SCORE + score) / 2);
+        return "cp " + std::to_string(score);
+    }
+
+    // Follows TT moves from the root; stops at the first miss, illegal move or repetition
+    static std::string principal_variation(Engine& engine, uint16_t best_raw, int max_len) {
+        BoardState board = engine.board;
+        std::string pv;
+        uint16_t raw = best_raw;
+        for (int i = 0; i < std::max(max_len, 1) && raw != 0; ++i) {
+            Move m = find_move(board, raw);
+            if (m.raw() == 0) break;
+            if (!pv.empty()) pv += ' ';
+            pv += Game::move_to_uci(m);
+            board.make_move(m);
+            if (board.is_draw()) break;
+            Search::TTEntry* e = engine.state.probe(board.key);
+            raw = e ? e->move : 0;
+        }
+        return pv;
+    }
+
+    static void report_iteration(const Search::SearchStats& stats, void* user) {
+        Engine& engine = *static_cast<Engine*>(user);
+        uint64_t nps = (stats.time_ms > 0) ? stats.nodes * 1000 / static_cast<uint64_t>(stats.time_ms) : 0;
+
+        std::ostringstream line;
+        line << "info depth " << stats.depth_reached
+             << " score " << format_score(stats.score)
+             << " nodes " << stats.nodes
+             << " nps " << nps
+             << " time " << stats.time_ms
+             << " tbhits " << stats.tb_hits
+             << " pv " << principal_variation(engine, static_cast<uint16_t>(stats.best_move_raw),
+                                              stats.depth_reached);
+        send(line.str());
+    }
+
+    // --- SEARCH THREAD CONTROL ---
+
+    static void stop_watchdog(Engine& engine) {
+        if (engine.watchdog.joinable()) engine.watchdog.join();
+    }
+
+    // Aborts any running search and waits for its bestmove to be sent
+    static void finish_search(Engine& engine) {
+        {
+            std::lock_guard<std::mutex> lock(engine.mutex);
+            engine.stop = true;
+            engine.holding = false;
+        }
+        engine.cv.notify_all();
+        if (engine.worker.joinable()) engine.worker.join();
+        stop_watchdog(engine);
+    }
+
+    static void start_watchdog(Engine& engine, int64_t budget_ms) {
+        stop_watchdog(engine);
+        engine.watchdog = std::thread([&engine, budget_ms]() {
+            std::unique_lock<std::mutex> lock(engine.mutex);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(budget_ms);
+            if (!engine.cv.wait_until(lock, deadline, [&]() { return engine.stop.load(); })) {
+                engine.stop = true;
+            }
+        });
+    }
+
+    // "go mate N": proof-number search, no eval. Reports the mate and returns true if one is
+    // proven; best/reply get the first two moves of the line.
+    static bool solve_mate(BoardState& board, const Search::SearchParams& params, int mate_moves,
+                           Move& best, Move& reply) {
+        MateSolver::Options options;
+        options.max_moves = mate_moves;
+        options.node_budget = params.max_nodes;
+        options.stop = params.stop;
+        MateSolver::Result result = MateSolver::solve(board, options);
+        if (result.status != MateSolver::Mate || result.pv.empty()) {
+            send("info string no mate found in " + std::to_string(mate_moves));
+            return false;
+        }
+
+        uint64_t nps = (result.time_ms > 0) ? result.nodes * 1000 / static_cast<uint64_t>(result.time_ms) : 0;
+        std::ostringstream line;
+        line << "info depth " << result.pv.size()
+             << " score mate " << result.mate_in
+             << " nodes " << result.nodes
+             << " nps " << nps
+             << " time " << result.time_ms
+             << " pv";
+        for (const Move& m : result.pv) line << ' ' << Game::move_to_uci(m);
+        send(line.str());
+
+        best = result.pv[0];
+        reply = (result.pv.size() > 1) ? result.pv[1] : Move();
+        return true;
+    }
+
+    // Page size and node placement of the big tables, once the search has touched them
+    static void report_memory(Engine& engine) {
+        if (engine.memory_reported) return;
+        engine.memory_reported = true;
+        send("info string memory " + Memory::status());
+        send("info string memory hash " + Memory::describe(engine.state.tt.memory())
+             + "; attacks " + Memory::describe(Attacks::table_memory()));
+    }
+
+    static void search_worker(Engine& engine, Search::SearchParams params, int mate_moves) {
+        Memory::pin_thread(0);
+        Search::SearchStats stats;
+        BoardState board = engine.board;
+        Move best, reply;
+        if (mate_moves <= 0 || !solve_mate(board, params, mate_moves, best, reply)) {
+            // Unproven mates fall back to the normal search, as deep as the mate asked for
+            if (mate_moves > 0 && params.depth <= 0 && params.hard_time_ms == 0 && params.max_nodes == 0) {
+                params.depth = 2 * mate_moves;
+            }
+            best = Search::iterative_deepening(board, params, stats);
+            if (params.profile) {
+                send("info string perf " + PerfCounters::summary(stats.counters, stats.nodes, Search::counters_status()));
+            }
+            report_memory(engine);
+            if (best.raw() != 0) {
+                board.make_move(best);
+                reply = find_move(board, static_cast<uint16_t>(stats.ponder_move_raw));
+                board.undo_move(best);
+            }
+        }
+
+        // A search that ends by itself during ponder/infinite waits for the GUI
+        {
+            std::unique_lock<std::mutex> lock(engine.mutex);
+            engine.cv.wait(lock, [&]() { return !engine.holding || engine.stop.load(); });
+            engine.stop = true;
+        }
+        engine.cv.notify_all();
+
+        if (best.raw() == 0) {
+            send("bestmove 0000");  // Mated or stalemated at the root
+            return;
+        }
+
+        std::string line = "bestmove " + Game::move_to_uci(best);
+        if (reply.raw() != 0) line += " ponder " + Game::move_to_uci(reply);
+        send(line);
+    }
+
+    // --- COMMANDS ---
+
+    static void cmd_uci() {
+        send(std::string("id name ") + ENGINE_NAME);
+        send("id author Warwick Computing Society");
+        send("option name Hash type spin default " + std::to_string(DEFAULT_HASH_MB)
+             + " min 1 max " + std::to_string(MAX_HASH_MB));
+        // Alpha-beta is single-threaded; Threads sets the MCTS workers
+        send("option name Threads type spin default 1 min 1 max " + std::to_string(MAX_THREADS));
+        send("option name SearchBackend type combo default AlphaBeta var AlphaBeta var MCTS");
+        send("option name Ponder type check default false");
+        send("option name PerfCounters type check default false");
+        send("option name CopyMake type check default false");
+        send("option name LargePages type check default true");
+        send("option name PinThreads type check default false");
+        send("option name NumaReplicate type check default false");
+        send("option name EvalLibrary type string default <empty>");
+        send("option name EvalSymbol type string default evaluation_function");
+        send("option name EvalFile type string default <empty>");
+        send("option name SyzygyPath type string default <empty>");
+        send("option name SyzygyProbeDepth type spin default 1 min 1 max 100");
+        send("option name SyzygyProbeLimit type spin default 7 min 0 max 7");
+        send("uciok");
+    }
+
+    static void load_eval(Engine& engine) {
+        engine.eval = Evaluation::evaluate;
+        engine.library.unload();
+        if (engine.eval_path.empty()) return;
+
+        Search::EvalCallback fn = engine.library.load(engine.eval_path, engine.eval_symbol);
+        if (fn) {
+            engine.eval = fn;
+            engine.state.clear();   // TT scores came from the previous eval
+        } else {
+            send("info string cannot load " + engine.eval_symbol + " from " + engine.eval_path
+                 + ", using the built-in eval");
+        }
+    }
+
+    static void cmd_setoption(Engine& engine, std::istringstream& in) {
+        // setoption name <name...> [value <value...>]
+        std::string token, name, value;
+        bool in_value = false;
+        while (in >> token) {
+            if (token == "name") continue;
+            if (token == "value" && !in_value) { in_value = true; continue; }
+            std::string& dst = in_value ? value : name;
+            if (!dst.empty()) dst += ' ';
+            dst += token;
+        }
+        if (value == "<empty>") value.clear();
+
+        finish_search(engine);
+
+        try {
+            if (name == "Hash") {
+                engine.hash_mb = std::clamp(std::stoi(value), 1, MAX_HASH_MB);
+                engine.state.resize(static_cast<size_t>(engine.hash_mb));
+                engine.memory_reported = false;
+            } else if (name == "Threads") {
+                engine.mcts.threads = std::clamp(std::stoi(value), 1, MAX_THREADS);
+            } else if (name == "SearchBackend") {
+                engine.backend = (value == "MCTS") ? Search::Backend::Mcts : Search::Backend::AlphaBeta;
+            } else if (name == "Ponder") {
+                // Nothing to configure
+            } else if (name == "PerfCounters") {
+                engine.profile = (value == "true");
+            } else if (name == "CopyMake") {
+                engine.copy_make = (value == "true");
+            } else if (name == "LargePages" || name == "PinThreads" || name == "NumaReplicate") {
+                // The TT is reallocated to pick up LargePages; the attack tables keep the
+                // pages they got at startup
+                Memory::Options memory = Memory::options();
+                bool on = (value == "true");
+                if (name == "LargePages") memory.large_pages = on;
+                else if (name == "PinThreads") memory.pin_threads = on;
+                else memory.replicate = on;
+                Memory::configure(memory);
+                if (name == "LargePages") engine.state.resize(static_cast<size_t>(engine.hash_mb));
+                engine.memory_reported = false;
+            } else if (name == "EvalLibrary") {
+                engine.eval_path = value;
+                load_eval(engine);
+            } else if (name == "EvalSymbol") {
+                engine.eval_symbol = value.empty() ? "evaluation_function" : value;
+                if (!engine.eval_path.empty()) load_eval(engine);
+            } else if (name == "EvalFile") {
+                // A network replaces any EvalLibrary eval; clearing it goes back to the built-in
+                engine.eval_path.clear();
+                load_eval(engine);
+                Nnue::Network net;
+                Nnue::EvalHandle handle = nullptr;
+                if (!value.empty() && Nnue::load(value, net)) handle = Nnue::register_network(std::move(net));
+                if (handle) {
+                    engine.eval = handle;
+                    engine.state.clear();
+                } else if (!value.empty()) {
+                    send("info string cannot load network " + value + ", using the built-in eval");
+                }
+            } else if (name == "SyzygyPath") {
+                engine.syzygy_path = value;
+                int pieces = Tablebase::init(value);
+                Tablebase::set_probe_limits(engine.syzygy_probe_depth, engine.syzygy_probe_limit);
+                if (!value.empty()) send("info string found " + std::to_string(pieces) + "-piece tablebases");
+            } else if (name == "SyzygyProbeDepth") {
+                engine.syzygy_probe_depth = std::stoi(value);
+                Tablebase::set_probe_limits(engine.syzygy_probe_depth, engine.syzygy_probe_limit);
+            } else if (name == "SyzygyProbeLimit") {
+                engine.syzygy_probe_limit = std::stoi(value);
+                Tablebase::set_probe_limits(engine.syzygy_probe_depth, engine.syzygy_probe_limit);
+            } else {
+                send("info string unknown option " + name);
+            }
+        } catch (...) {
+            send("info string bad value for " + name);
+        }
+    }
+
+    static void cmd_position(Engine& engine, std::istringstream& in) {
+        finish_search(engine);
+
+        std::string token, fen;
+        in >> token;
+        if (token == "fen") {
+            while (in >> token && token != "moves") fen += (fen.empty() ? "" : " ") + token;
+        } else {
+            fen = "startpos";
+            in >> token;    // "moves", if present
+        }
+        Game::setup_board(engine.board, fen);
+
+        while (in >> token) {
+            Move m = Notation::parse_uci(engine.board, token);
+            if (m.raw() == 0) {
+                send("info string illegal move " + token);
+                break;
+            }
+            engine.board.make_move(m);
+        }
+    }
+
+    static void cmd_go(Engine& engine, std::istringstream& in) {
+        finish_search(engine);
+
+        Search::SearchParams params{};
+        params.depth = 0;
+        params.evalFunc = engine.eval;
+        params.state = &engine.state;
+        params.stop = &engine.stop;
+        params.on_iteration = report_iteration;
+        params.info_user = &engine;
+        params.backend = engine.backend;
+        params.mcts = engine.mcts;
+        params.profile = engine.profile;
+        params.copy_make = engine.copy_make;
+
+        int64_t time[2] = {0, 0};
+        int64_t inc[2] = {0, 0};
+        int64_t movetime = 0;
+        int movestogo = 0;
+        bool ponder = false;
+        bool infinite = false;
+        int mate_moves = 0;
+
+        std::string token;
+        while (in >> token) {
+            if      (token == "wtime")     in >> time[0];
+            else if (token == "btime")     in >> time[1];
+            else if (token == "winc")      in >> inc[0];
+            else if (token == "binc")      in >> inc[1];
+            else if (token == "movestogo") in >> movestogo;
+            else if (token == "movetime")  in >> movetime;
+            else if (token == "depth")     in >> params.depth;
+            else if (token == "nodes")     in >> params.max_nodes;
+            else if (token == "mate")      in >> mate_moves;
+            else if (token == "ponder")    ponder = true;
+            else if (token == "infinite")  infinite = true;
+        }
+
+        // Time budget from the clock or a fixed move time; none means search until told
+        Search::SearchParams timed = params;
+        int us = (engine.board.to_move == Colour::White) ? 0 : 1;
+        if (movetime > 0) {
+            timed.soft_time_ms = movetime;
+            timed.hard_time_ms = movetime;
+        } else if (time[us] > 0) {
+            Search::allocate_time(time[us], inc[us], movestogo, timed);
+        }
+        bool has_limit = timed.hard_time_ms > 0 || params.depth > 0 || params.max_nodes > 0 || mate_moves > 0;
+
+        {
+            std::lock_guard<std::mutex> lock(engine.mutex);
+            engine.stop = false;
+            engine.holding = ponder || infinite || !has_limit;
+            engine.ponder_timed = ponder && timed.hard_time_ms > 0;
+            engine.ponder_budget_ms = timed.soft_time_ms;
+        }
+
+        // While pondering only depth/nodes apply; the clock starts at ponderhit
+        engine.worker = std::thread(search_worker, std::ref(engine), ponder ? params : timed, mate_moves);
+    }
+
+    static void cmd_ponderhit(Engine& engine) {
+        bool timed;
+        {
+            std::lock_guard<std::mutex> lock(engine.mutex);
+            if (!engine.worker.joinable()) return;
+            engine.holding = false;
+            timed = engine.ponder_timed;
+        }
+        engine.cv.notify_all();
+        if (timed) start_watchdog(engine, engine.ponder_budget_ms);
+    }
+
+    static void cmd_stop(Engine& engine) {
+        finish_search(engine);
+    }
+
+    // "bench [depth]": the fixed workload in Bench.hpp with the current eval, one line per
+    // phase, then the node count that identifies the search
+    void bench(Search::EvalCallback eval, int depth, bool copy_make) {
+        Bench::Options options;
+        options.eval = eval;
+        options.copy_make = copy_make;
+        if (depth > 0) options.depth = depth;
+        Bench::PhaseResult results[Bench::NUM_PHASES];
+        uint64_t nodes = Bench::run(options, results);
+
+        const char* units[Bench::NUM_PHASES] = { "lookup", "move", "move", "call", "node" };
+        for (int p = 0; p < Bench::NUM_PHASES; ++p) {
+            const Bench::PhaseResult& r = results[p];
+            uint64_t ops = static_cast<uint64_t>(std::max<int64_t>(r.ops, 0));
+            char line[160];
+            std::snprintf(line, sizeof(line), "info string bench %-10s %10llu %ss %9.1f ms %8.1f ns/%s ",
+                          Bench::phase_name(p), static_cast<unsigned long long>(ops), units[p],
+                          static_cast<double>(r.time_ns) / 1e6,
+                          static_cast<double>(r.time_ns) / static_cast<double>(std::max<uint64_t>(ops, 1)), units[p]);
+            send(line + PerfCounters::summary(r.counters, ops, Bench::counters_status(), units[p]));
+        }
+
+        int64_t search_ns = results[Bench::Searches].time_ns;
+        uint64_t nps = (search_ns > 0) ? static_cast<uint64_t>(static_cast<double>(nodes) * 1e9 / static_cast<double>(search_ns)) : 0;
+        send("Nodes searched  : " + std::to_string(nodes));
+        send("Nodes/second    : " + std::to_string(nps));
+    }
+
+    static void cmd_bench(Engine& engine, std::istringstream& in) {
+        finish_search(engine);
+        int depth = 0;
+        in >> depth;
+        bench(engine.eval, depth, engine.copy_make);
+    }
+
+    void loop() {
+        Attacks::init();
+        Zobrist::init();
+
+        Engine engine;
+        Game::setup_board(engine.board, "startpos");
+
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            std::istringstream in(line);
+            std::string cmd;
+            in >> cmd;
+
+            if      (cmd == "uci")        cmd_uci();
+            else if (cmd == "isready")    send("readyok");
+            else if (cmd == "ucinewgame") { finish_search(engine); engine.state.clear(); engine.memory_reported = false; }
+            else if (cmd == "setoption")  cmd_setoption(engine, in);
+            else if (cmd == "position")   cmd_position(engine, in);
+            else if (cmd == "go")         cmd_go(engine, in);
+            else if (cmd == "stop")       cmd_stop(engine);
+            else if (cmd == "ponderhit")  cmd_ponderhit(engine);
+            else if (cmd == "bench")      cmd_bench(engine, in);
+            else if (cmd == "quit")       break;
+        }
+        finish_search(engine);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::ios::sync_with_stdio(false);
+    // "ChessUci bench [depth]" runs the bench and exits, for scripts and CI
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        Attacks::init();
+        Zobrist::init();
+        Uci::bench(Evaluation::evaluate, (argc > 2) ? std::atoi(argv[2]) : 0, false);
+        return 0;
+    }
+    Uci::loop();
+    return 0;
+}
@@ -0,0 +1,145 @@
+"""Checks the engine's Syzygy probing against real table files.
+
+    python tests/syzygy_check.py <ChessLib library or build directory> <syzygy directory>
+
+The directory needs the .rtbw and .rtbz files for KQvK, KRvK, KPvK and KBNvK. Probes go
+through ChessLib's probeTablebase and are compared with values known for a few positions,
+then with python-chess's own prober (in requirements.txt) on random legal positions from
+each table. Exits non-zero on the first table missing or any mismatch.
+"""
+import ctypes
+import os
+import random
+import sys
+
+import chess
+import chess.syzygy
+
+# -----------------------------------------------------------
+# CONFIGURATION
+# -----------------------------------------------------------
+TABLES = {
+    "KQvK": "KQk",
+    "KRvK": "KRk",
+    "KPvK": "KPk",
+    "KBNvK": "KBNk",
+}
+SAMPLES_PER_TABLE = 2000
+SEED = 20260118
+
+# (FEN, WDL for the side to move, DTZ or None when only the WDL is known)
+KNOWN = [
+    ("7k/8/6K1/8/8/8/8/1Q6 w - - 0 1", 2, 1),          # Qb8 mates
+    ("k7/1Q6/8/8/8/8/8/7K b - - 0 1", 0, 0),           # Kxb7
+    ("6k1/8/6K1/8/8/8/8/R7 w - - 0 1", 2, 1),          # Ra8 mates
+    ("8/8/8/8/8/3K4/1k6/R7 b - - 0 1", 0, 0),          # Kxa1
+    ("8/4P3/8/8/8/8/k7/4K3 w - - 0 1", 2, 1),          # e8=Q
+    ("4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", 0, 0),         # Stalemate
+    ("8/2K5/4B3/3N4/8/8/4k3/8 b - - 0 1", -2, -53),    # python-chess documentation example
+    ("8/8/8/8/3k4/3B4/8/K5N1 b - - 0 1", 0, 0),        # Kxd3
+]
+MISSING = -3    # probeTablebase: position not covered
+
+
+def find_library(path):
+    """Return the ChessLib shared library at path, or inside path if it is a build directory."""
+    if os.path.isfile(path):
+        return path
+    for name in ("libChessLib.so", "libChessLib.dylib", "ChessLib.dll",
+                 os.path.join("Release", "ChessLib.dll")):
+        candidate = os.path.join(path, name)
+        if os.path.isfile(candidate):
+            return candidate
+    sys.exit(f"FAIL: no ChessLib library at {path}")
+
+
+def fail(message):
+    print(f"FAIL: {message}")
+    sys.exit(1)
+
+
+# -----------------------------------------------------------
+# ENGINE PROBES
+# -----------------------------------------------------------
+class EngineTables:
+    def __init__(self, lib_path, syzygy_dir):
+        self.lib = ctypes.CDLL(lib_path)
+        self.lib.initTablebases.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_int]
+        self.lib.initTablebases.restype = ctypes.c_int
+        self.lib.probeTablebase.argtypes = [ctypes.c_char_p, ctypes.POINTER(ctypes.c_int)]
+        self.lib.probeTablebase.restype = ctypes.c_int
+        self.max_pieces = self.lib.initTablebases(syzygy_dir.encode("utf-8"), 1, 7)
+
+    def probe(self, board):
+        """(WDL, DTZ) for the side to move, or (MISSING, 0)."""
+        dtz = ctypes.c_int(0)
+        wdl = self.lib.probeTablebase(board.fen().encode("utf-8"), ctypes.byref(dtz))
+        return wdl, dtz.value
+
+
+def random_position(rng, pieces):
+    """A random legal position with the given pieces (upper case white) and no castling."""
+    while True:
+        board = chess.Board(None)
+        squares = rng.sample(range(64), len(pieces))
+        for symbol, square in zip(pieces, squares):
+            board.set_piece_at(square, chess.Piece.from_symbol(symbol))
+        board.turn = rng.choice([chess.WHITE, chess.BLACK])
+        if rng.random() < 0.5:
+            board = board.mirror()  # Also sample the weaker side as white
+        if board.is_valid():
+            return board
+
+
+# -----------------------------------------------------------
+# CHECKS
+# -----------------------------------------------------------
+def compare(engine, tablebase, board, what):
+    wdl, dtz = engine.probe(board)
+    if wdl == MISSING:
+        fail(f"{what}: engine has no value for {board.fen()}")
+    expected_wdl = tablebase.probe_wdl(board)
+    if wdl != expected_wdl:
+        fail(f"{what}: WDL {wdl}, python-chess {expected_wdl} for {board.fen()}")
+    if board.is_game_over():
+        return  # Mates and stalemates have no move to count DTZ to
+    expected_dtz = tablebase.probe_dtz(board)
+    if dtz != expected_dtz:
+        fail(f"{what}: DTZ {dtz}, python-chess {expected_dtz} for {board.fen()}")
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    lib_path, syzygy_dir = find_library(sys.argv[1]), sys.argv[2]
+
+    for table in TABLES:
+        for ext in (".rtbw", ".rtbz"):
+            if not os.path.isfile(os.path.join(syzygy_dir, table + ext)):
+                fail(f"{table}{ext} not in {syzygy_dir}")
+
+    engine = EngineTables(lib_path, syzygy_dir)
+    if engine.max_pieces < 4:
+        fail(f"engine loaded tables up to {engine.max_pieces} pieces, expected 4")
+
+    with chess.syzygy.open_tablebase(syzygy_dir) as tablebase:
+        for fen, known_wdl, known_dtz in KNOWN:
+            board = chess.Board(fen)
+            wdl, dtz = engine.probe(board)
+            if wdl != known_wdl or (known_dtz is not None and dtz != known_dtz):
+                fail(f"known position {fen}: engine WDL {wdl} DTZ {dtz}, "
+                     f"expected WDL {known_wdl} DTZ {known_dtz}")
+            compare(engine, tablebase, board, "known position")
+        print(f"{len(KNOWN)} known positions OK")
+
+        rng = random.Random(SEED)
+        for table, pieces in TABLES.items():
+            for _ in range(SAMPLES_PER_TABLE):
+                compare(engine, tablebase, random_position(rng, pieces), table)
+            print(f"{table}: {SAMPLES_PER_TABLE} random positions OK")
+
+    print("Syzygy check OK")
+
+
+if __name__ == "__main__":
+    main()
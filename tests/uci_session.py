@@ -0,0 +1,179 @@
+"""Scripted UCI session against the ChessUci binary.
+
+    python tests/uci_session.py <ChessUci binary or build directory>
+
+Drives uci / isready / position / go (depth, movetime, infinite + stop) / quit over
+stdin and checks the handshake replies and that every bestmove is legal in the position
+sent. Needs python-chess (in requirements.txt). Exits non-zero on the first failure.
+"""
+import os
+import queue
+import subprocess
+import sys
+import threading
+import time
+
+import chess
+
+# -----------------------------------------------------------
+# CONFIGURATION
+# -----------------------------------------------------------
+REPLY_TIMEOUT = 10.0        # Seconds to wait for any expected line
+SEARCH_TIMEOUT = 60.0       # Seconds a fixed-depth or movetime search may take in CI
+SEARCH_DEPTH = 6
+MOVETIME_MS = 300
+INFINITE_HOLD = 0.5         # Seconds "go infinite" must run without sending bestmove
+
+# (position command tail, the same moves for python-chess to replay)
+POSITIONS = [
+    ("startpos", []),
+    ("startpos moves e2e4 e7e5 g1f3 b8c6 f1b5", ["e2e4", "e7e5", "g1f3", "b8c6", "f1b5"]),
+    ("startpos moves e2e4 d7d5 e4d5 d8d5 b1c3 d5a5 d2d4 c7c6 g1f3 c8f5 f1c4 e7e6 e1g1",
+     ["e2e4", "d7d5", "e4d5", "d8d5", "b1c3", "d5a5", "d2d4", "c7c6", "g1f3", "c8f5",
+      "f1c4", "e7e6", "e1g1"]),
+]
+# Positions given by FEN: en passant, castling, promotion and check evasion
+FEN_POSITIONS = [
+    "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/P6k/8/8/8/8/6pK/8 w - - 0 1",
+    "4k3/8/8/8/8/8/3q4/4K3 w - - 0 1",
+]
+
+
+def find_engine(path):
+    """Return the ChessUci binary at path, or inside path if it is a build directory."""
+    if os.path.isfile(path):
+        return path
+    for name in ("ChessUci", "ChessUci.exe", os.path.join("Release", "ChessUci.exe"),
+                 os.path.join("Release", "ChessUci")):
+        candidate = os.path.join(path, name)
+        if os.path.isfile(candidate):
+            return candidate
+    sys.exit(f"FAIL: no ChessUci binary at {path}")
+
+
+# -----------------------------------------------------------
+# ENGINE PROCESS
+# -----------------------------------------------------------
+class Engine:
+    def __init__(self, path):
+        self.proc = subprocess.Popen([path], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                     text=True, bufsize=1)
+        self.lines = queue.Queue()
+        threading.Thread(target=self._read, daemon=True).start()
+
+    def _read(self):
+        for line in self.proc.stdout:
+            self.lines.put(line.strip())
+        self.lines.put(None)    # EOF
+
+    def send(self, command):
+        print(f">> {command}")
+        self.proc.stdin.write(command + "\n")
+        self.proc.stdin.flush()
+
+    def expect(self, prefix, timeout=REPLY_TIMEOUT):
+        """Read lines until one starts with prefix; fail on timeout or EOF."""
+        deadline = time.monotonic() + timeout
+        while True:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                fail(f"no '{prefix}' within {timeout:.0f}s")
+            try:
+                line = self.lines.get(timeout=remaining)
+            except queue.Empty:
+                continue
+            if line is None:
+                fail(f"engine exited before '{prefix}'")
+            if line.startswith(prefix):
+                print(f"<< {line}")
+                return line
+
+    def silent_for(self, prefix, seconds):
+        """True if no line starting with prefix arrives within seconds."""
+        deadline = time.monotonic() + seconds
+        while (remaining := deadline - time.monotonic()) > 0:
+            try:
+                line = self.lines.get(timeout=remaining)
+            except queue.Empty:
+                break
+            if line is None or line.startswith(prefix):
+                return False
+        return True
+
+
+def fail(message):
+    print(f"FAIL: {message}")
+    sys.exit(1)
+
+
+def check_bestmove(line, board, what):
+    parts = line.split()
+    if len(parts) < 2:
+        fail(f"{what}: malformed '{line}'")
+    try:
+        move = chess.Move.from_uci(parts[1])
+    except ValueError:
+        fail(f"{what}: unparsable move '{parts[1]}'")
+    if move not in board.legal_moves:
+        fail(f"{what}: illegal bestmove {parts[1]} in {board.fen()}")
+
+
+# -----------------------------------------------------------
+# SESSION
+# -----------------------------------------------------------
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    engine = Engine(find_engine(sys.argv[1]))
+
+    engine.send("uci")
+    engine.expect("id name")
+    engine.expect("uciok")
+    engine.send("isready")
+    engine.expect("readyok")
+    engine.send("ucinewgame")
+    engine.send("isready")
+    engine.expect("readyok")
+
+    boards = []
+    for tail, moves in POSITIONS:
+        board = chess.Board()
+        for move in moves:
+            board.push_uci(move)
+        boards.append((f"position {tail}", board))
+    for fen in FEN_POSITIONS:
+        boards.append((f"position fen {fen}", chess.Board(fen)))
+
+    for command, board in boards:
+        engine.send(command)
+        engine.send(f"go depth {SEARCH_DEPTH}")
+        check_bestmove(engine.expect("bestmove", SEARCH_TIMEOUT), board, f"go depth {SEARCH_DEPTH}")
+
+        engine.send(f"go movetime {MOVETIME_MS}")
+        check_bestmove(engine.expect("bestmove", SEARCH_TIMEOUT), board, f"go movetime {MOVETIME_MS}")
+
+    command, board = boards[1]
+    engine.send(command)
+    engine.send("go infinite")
+    if not engine.silent_for("bestmove", INFINITE_HOLD):
+        fail("go infinite sent bestmove before stop")
+    engine.send("stop")
+    check_bestmove(engine.expect("bestmove"), board, "go infinite + stop")
+
+    engine.send("isready")
+    engine.expect("readyok")
+    engine.send("quit")
+    try:
+        code = engine.proc.wait(timeout=REPLY_TIMEOUT)
+    except subprocess.TimeoutExpired:
+        engine.proc.kill()
+        fail("engine did not exit after quit")
+    if code != 0:
+        fail(f"engine exited with code {code}")
+    print("UCI session OK")
+
+
+if __name__ == "__main__":
+    main()